@@ -1,9 +1,37 @@
 #include <cassert>
 #include "bigint.h"
+#include "bigint_expr.h"
+#include "bigint_parallel.h"
+#include "bigint_stats.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <chrono>
+
+// Cutoffs measured on this host by bigint_tune, if it has been run
+#if __has_include("bigint_tuning.h")
+#include "bigint_tuning.h"
+#endif
+#ifndef BIGINT_MUL_KARATSUBA_CUTOFF
+#define BIGINT_MUL_KARATSUBA_CUTOFF 32
+#endif
+#ifndef BIGINT_SQR_KARATSUBA_CUTOFF
+#define BIGINT_SQR_KARATSUBA_CUTOFF 32
+#endif
+#ifndef BIGINT_DEC_BASECASE_CUTOFF
+#define BIGINT_DEC_BASECASE_CUTOFF 16
+#endif
+#ifndef BIGINT_HGCD_CUTOFF
+#define BIGINT_HGCD_CUTOFF 1024
+#endif
 
 using std::cout;
 using std::endl;
@@ -46,7 +74,7 @@ BigInt::~BigInt()
 }
 
 /* GET VECTOR */
-const std::vector<uint64_t> &BigInt::get_bit_vector() const
+const LimbVector &BigInt::get_bit_vector() const
 {
   return magnitude;
 }
@@ -63,6 +91,13 @@ uint64_t BigInt::get_bits(unsigned index) const
   return this->magnitude[index];
 }
 
+/* BIT LENGTH */
+size_t BigInt::bit_length() const
+{
+  size_t used = used_blocks(magnitude);
+  return used == 0 ? 0 : 64 * used - __builtin_clzll(magnitude[used - 1]);
+}
+
 /* GET NEGATIVITY */
 bool BigInt::is_negative() const
 {
@@ -73,7 +108,7 @@ bool BigInt::is_negative() const
 BigInt BigInt::operator-() const
 {
   // Edge Case: 0
-  if (magnitude.size() == 1 && magnitude[0] == 0)
+  if (is_zero_mag(magnitude))
   {
     return BigInt(*this);
   }
@@ -86,52 +121,10 @@ BigInt BigInt::operator-() const
 /* CONVERT VECTOR TO HEX */
 std::string BigInt::to_hex() const
 {
-  stringstream ss;
-
-  // ss in hex mode
-  ss << hex << std::setfill('0');
-
-  // Check negativity
-  if (isNeg)
-  {
-    ss << '-';
-  }
-
-  // First non-zero tracker
-  bool found = false;
-
-  // Edge Case: BigInt is 0
-  if (magnitude.empty() || (magnitude.size() == 1 && magnitude[0] == 0))
-  {
-    return "0";
-  }
-
-  // Iterate vector
-  for (auto i = magnitude.rbegin(); i != magnitude.rend(); ++i)
-  {
-    // Skip leading 0s
-    if (!found)
-    {
-      if (*i == 0)
-      {
-        continue;
-      }
-      found = true;
-    }
-
-    // First element doesn't need padding
-    if (i == magnitude.rbegin())
-    {
-      ss << *i;
-    }
-    else
-    {
-      ss << std::setw(16) << *i;
-    }
-  }
-
-  // Return stream as string
-  return ss.str();
+  std::string result;
+  write_hex([&](const char *chars, size_t length)
+            { result.append(chars, length); });
+  return result;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -141,8 +134,9 @@ std::string BigInt::to_hex() const
 /* ADDITION */
 BigInt BigInt::operator+(const BigInt &rhs) const
 {
+  BIGINT_STAT_OP(ADD, magnitude.size() + rhs.magnitude.size());
 
-  const vector<uint64_t> lmagnitude = this->magnitude; // storing lhs vector
+  const LimbVector lmagnitude = this->magnitude; // storing lhs vector
 
   bool lneg = this->isNeg;
   BigInt sum;
@@ -175,28 +169,21 @@ BigInt BigInt::operator+(const BigInt &rhs) const
 }
 
 /* ADDITION - HELPER */
-vector<uint64_t> BigInt::add(const vector<uint64_t> leftMag, const vector<uint64_t> rightMag) const
+LimbVector BigInt::add(const LimbVector leftMag, const LimbVector rightMag) const
 {
 
-  vector<uint64_t> sumMag;
-  const vector<uint64_t> &smallMag = rightMag.size() < leftMag.size() ? rightMag : leftMag; // determine smaller magnitude
-  const vector<uint64_t> &largeMag = rightMag.size() < leftMag.size() ? leftMag : rightMag; // determine larger magnitude
+  LimbVector sumMag;
+  const LimbVector &smallMag = rightMag.size() < leftMag.size() ? rightMag : leftMag; // determine smaller magnitude
+  const LimbVector &largeMag = rightMag.size() < leftMag.size() ? leftMag : rightMag; // determine larger magnitude
   uint64_t carry = 0UL;
 
   for (int i = 0; i < (int)largeMag.size(); ++i) // iterate fully through largeMag to ensure everything is added
   {
     uint64_t largeMagVal = largeMag[i];
     uint64_t smallMagVal = i < (int)smallMag.size() ? smallMag[i] : 0;
-    uint64_t totalSum = largeMagVal + smallMagVal + carry;
-    if (totalSum < largeMagVal) // overflow detected, need to carry to next operation
-    {
-      carry = 1UL;
-    }
-    else // no overflow, no need to carry
-    {
-      carry = 0UL;
-    }
-    sumMag.push_back(totalSum);
+    unsigned __int128 totalSum = (unsigned __int128)largeMagVal + smallMagVal + carry;
+    carry = (uint64_t)(totalSum >> 64); // overflow past 64 bits is carried to the next operation
+    sumMag.push_back((uint64_t)totalSum);
   }
   if (carry) // add the remaining carry
   {
@@ -209,7 +196,8 @@ vector<uint64_t> BigInt::add(const vector<uint64_t> leftMag, const vector<uint64
 /* SUBTRACTION */
 BigInt BigInt::operator-(const BigInt &rhs) const
 {
-  const vector<uint64_t> lmagnitude = this->magnitude; // storing lhs magnitude
+  BIGINT_STAT_OP(SUB, magnitude.size() + rhs.magnitude.size());
+  const LimbVector lmagnitude = this->magnitude; // storing lhs magnitude
 
   bool lneg = this->isNeg; // storing lhs leg
   BigInt difference;
@@ -239,9 +227,9 @@ BigInt BigInt::operator-(const BigInt &rhs) const
 }
 
 /* SUBTRACTION - HELPER */
-vector<uint64_t> BigInt::subtract(const vector<uint64_t> leftMag, const vector<uint64_t> rightMag, bool &isNeg) const
+LimbVector BigInt::subtract(const LimbVector leftMag, const LimbVector rightMag, bool &isNeg) const
 {
-  vector<uint64_t> diffMag;
+  LimbVector diffMag;
   if (compare_mag(leftMag, rightMag) == 1) // use compare mag to determine whether or not the operation will end up with a negative value
   {
     isNeg = false;
@@ -256,28 +244,19 @@ vector<uint64_t> BigInt::subtract(const vector<uint64_t> leftMag, const vector<u
   }
 
   // assigning vectors based on isNeg, as isNeg is true if the left magnitude is smaller
-  const vector<uint64_t> &smallMag = isNeg ? leftMag : rightMag;
-  const vector<uint64_t> &largeMag = isNeg ? rightMag : leftMag;
+  const LimbVector &smallMag = isNeg ? leftMag : rightMag;
+  const LimbVector &largeMag = isNeg ? rightMag : leftMag;
 
   uint64_t borrow = 0;
   for (size_t i = 0; i < largeMag.size(); ++i) // iterate fully through largeMag to ensure everything is subtracted
   {
     uint64_t smallMagVal = i < smallMag.size() ? smallMag[i] : 0; // if we have subtracted out all of the smaller magnitude, give default value of 0
-    uint64_t subtrahend = smallMagVal + borrow;
 
-    // If we need to borrow and the current digit of largeMag is 0 or subtrahend is larger than the current digit,
-    // perform the borrow operation.
-    if (largeMag[i] < subtrahend)
-    {
-      borrow = 1;
-      // Use uint64_t max value + 1 to simulate borrowing in unsigned arithmetic
-      diffMag.push_back(largeMag[i] + (UINT64_MAX - subtrahend) + 1);
-    }
-    else
-    {
-      borrow = 0;
-      diffMag.push_back(largeMag[i] - subtrahend);
-    }
+    // Subtract in 128 bits so that a pending borrow on an all-ones block
+    // is not lost; a negative difference means we borrow from the next block
+    unsigned __int128 diff = (unsigned __int128)largeMag[i] - smallMagVal - borrow;
+    borrow = (diff >> 64) != 0;
+    diffMag.push_back((uint64_t)diff);
   }
   return diffMag;
 }
@@ -306,6 +285,7 @@ bool BigInt::is_bit_set(unsigned n) const
 /* LEFT SHIFT */
 BigInt BigInt::operator<<(unsigned n) const
 {
+  BIGINT_STAT_OP(SHIFT, magnitude.size());
   if (this->isNeg)
   {
     throw std::invalid_argument("Left shifting a negative value is not allowed");
@@ -337,6 +317,37 @@ BigInt BigInt::operator<<(unsigned n) const
   return shiftedResult;
 }
 
+/* RIGHT SHIFT */
+BigInt BigInt::operator>>(unsigned n) const
+{
+  BIGINT_STAT_OP(SHIFT, magnitude.size());
+  if (this->isNeg)
+  {
+    throw std::invalid_argument("Right shifting a negative value is not allowed");
+  }
+  size_t shiftAmount = n / 64; // whole blocks dropped
+  unsigned leftOver = n % 64;
+  BigInt shiftedResult;
+  if (shiftAmount >= magnitude.size())
+  {
+    return shiftedResult;
+  }
+
+  shiftedResult.magnitude.resize(magnitude.size() - shiftAmount);
+  for (size_t i = 0; i < shiftedResult.magnitude.size(); i++)
+  {
+    uint64_t low = magnitude[i + shiftAmount] >> leftOver;
+    uint64_t high = 0; // bits brought down from the next block
+    if (leftOver && i + shiftAmount + 1 < magnitude.size())
+    {
+      high = magnitude[i + shiftAmount + 1] << (64 - leftOver);
+    }
+    shiftedResult.magnitude[i] = low | high;
+  }
+  remove_zeroes(shiftedResult.magnitude);
+  return shiftedResult;
+}
+
 /* ASSIGNMENT */
 BigInt &BigInt::operator=(const BigInt &rhs)
 {
@@ -352,10 +363,16 @@ BigInt &BigInt::operator=(const BigInt &rhs)
 /* COMPARISON */
 int BigInt::compare(const BigInt &rhs) const
 {
+  BIGINT_STAT_OP(COMPARE, magnitude.size() + rhs.magnitude.size());
   // Check negativity - 4 cases: sign/size comparison
 
   if (this->isNeg != rhs.isNeg)
   {
+    // Zero is equal to zero whatever its sign flag says
+    if (is_zero_mag(magnitude) && is_zero_mag(rhs.magnitude))
+    {
+      return 0;
+    }
     return this->isNeg ? -1 : 1;
   }
   int compared_val = compare_mag(this->magnitude, rhs.magnitude);
@@ -367,56 +384,69 @@ int BigInt::compare(const BigInt &rhs) const
 }
 
 /* COMPARISON - HELPER */
-int BigInt::compare_mag(const vector<uint64_t> lhs, const vector<uint64_t> rhs) const
+int BigInt::compare_mag(const LimbVector &lhs, const LimbVector &rhs)
 {
-  vector<uint64_t> leftVec;
-  vector<uint64_t> rightVec;
-  for (int i = 0; i <(int)  lhs.size(); i++)
+  // Ignore leading zero blocks (zero may be stored as {} or {0, 0, ...})
+  size_t leftSize = lhs.size();
+  size_t rightSize = rhs.size();
+  while (leftSize > 0 && lhs[leftSize - 1] == 0)
   {
-    leftVec.push_back(lhs[i]);
+    --leftSize;
   }
-  for (int i = 0; i < (int) rhs.size(); i++)
+  while (rightSize > 0 && rhs[rightSize - 1] == 0)
   {
-    rightVec.push_back(rhs[i]);
+    --rightSize;
   }
-  while (leftVec[leftVec.size() - 1] == 0)
+
+  if (leftSize != rightSize)
   {
-    leftVec.pop_back();
+    return leftSize > rightSize ? 1 : -1;
   }
-  while (rightVec[rightVec.size() - 1] == 0)
+
+  // Sizes are equal; compare each block from most to least significant
+  for (size_t i = leftSize; i-- > 0;)
   {
-    rightVec.pop_back();
+    if (lhs[i] != rhs[i])
+    {
+      return lhs[i] > rhs[i] ? 1 : -1;
+    }
   }
-  if (leftVec.size() > rightVec.size())
+  return 0; // Magnitudes are equal
+}
+
+/* REMOVE LEADING ZEROES - HELPER */
+void BigInt::remove_zeroes(LimbVector &mag)
+{
+  // Keep one block so that zero is stored as {0}
+  while (mag.size() > 1 && mag.back() == 0)
   {
-    return 1;
+    mag.pop_back();
   }
-  else if (leftVec.size() < rightVec.size())
+  if (mag.empty())
   {
-    return -1;
+    mag.push_back(0);
   }
-  else
-  { // Sizes are equal; compare each block from most to least significant
-    for (int i = leftVec.size() - 1; i >= 0; --i)
+}
+
+/* IS ZERO - HELPER */
+bool BigInt::is_zero_mag(const LimbVector &mag)
+{
+  for (uint64_t block : mag)
+  {
+    if (block != 0)
     {
-      if (leftVec[i] > rightVec[i])
-      {
-        return 1;
-      }
-      else if (leftVec[i] < rightVec[i])
-      {
-        return -1;
-      }
+      return false;
     }
-    return 0; // Magnitudes are equal
   }
+  return true;
 }
 
 /* MULTIPLICATION */
 BigInt BigInt::operator*(const BigInt &rhs) const
 {
+  BIGINT_STAT_OP(MUL, magnitude.size() + rhs.magnitude.size());
   // Edge Case
-  if (magnitude.empty() || (magnitude.size() == 1 && magnitude[0] == 0) || rhs.magnitude.empty() || (rhs.magnitude.size() == 1 && rhs.magnitude[0] == 0))
+  if (is_zero_mag(magnitude) || is_zero_mag(rhs.magnitude))
   {
     return BigInt(0);
   }
@@ -432,162 +462,3724 @@ BigInt BigInt::operator*(const BigInt &rhs) const
   return product;
 }
 
+namespace
+{
+  // Largest operands whose contents are compared to detect a square
+  const size_t SQUARE_DETECT_BLOCKS = 8;
+}
+
 /* MULTIPLICATION - HELPER */
 BigInt BigInt::multiply(const BigInt &left, const BigInt &right) const
 {
   BigInt product;
 
-  // Drop signs
-  BigInt leftCopy = left;
-  leftCopy.isNeg = false;
-  BigInt rightCopy = right;
-
-  // Break right BigInt into powers of 2 components
-  for (int i = 0; i < (int)right.magnitude.size() * 64; i++)
+  // Squaring needs roughly half the block products. Equal contents are
+  // only looked for in small operands, where the compare is cheap next
+  // to the product; large squares are expected to pass the same object.
+  bool square = &left == &right;
+  if (!square && left.magnitude.size() == right.magnitude.size() && left.magnitude.size() <= SQUARE_DETECT_BLOCKS)
   {
-    if (rightCopy.is_bit_set(i))
-    {
-      // Multiply left BigInt by 2^i
-      BigInt powOf2 = leftCopy << i;
-
-      // Add to product
-      product = product + powOf2;
-    }
+    square = left.magnitude == right.magnitude;
+  }
+  if (square)
+  {
+    sqr_mag(left.magnitude, product.magnitude);
+  }
+  else
+  {
+    mul_mag(left.magnitude, right.magnitude, product.magnitude);
   }
 
   return product;
 }
 
-/* DIVISION - HELPER */
-BigInt BigInt::divideByTwo(const BigInt &val) const
+/* SIGNIFICANT BLOCKS - HELPER */
+size_t BigInt::used_blocks(const LimbVector &mag)
+{
+  size_t n = mag.size();
+  while (n > 0 && mag[n - 1] == 0)
+  {
+    --n;
+  }
+  return n;
+}
+
+namespace
 {
-    // Variables for iteration
-    BigInt res = val;
+  // Operands from this many blocks up are multiplied (squared) with
+  // Karatsuba; below 4 blocks a split would not make them smaller
+  const size_t MIN_KARATSUBA_CUTOFF = 4;
+  // Atomic, since pool threads read them while another thread may set them
+  std::atomic<size_t> karatsubaCutoff(BIGINT_MUL_KARATSUBA_CUTOFF);
+  std::atomic<size_t> sqrKaratsubaCutoff(BIGINT_SQR_KARATSUBA_CUTOFF);
+
+  /* ADD INTO - HELPER */
+  // r[0..rn) += a[0..an), an <= rn; returns the carry out of r
+  uint64_t add_into(uint64_t *r, size_t rn, const uint64_t *a, size_t an)
+  {
     uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < an; ++i)
+    {
+      unsigned __int128 t = (unsigned __int128)r[i] + a[i] + carry;
+      r[i] = (uint64_t)t;
+      carry = (uint64_t)(t >> 64);
+    }
+    for (; carry != 0 && i < rn; ++i)
+    {
+      carry = ++r[i] == 0;
+    }
+    return carry;
+  }
 
-    // Iterate through magnitude to shift right
-    for (int i = res.magnitude.size() - 1; i >= 0; --i)
+  /* SUBTRACT FROM - HELPER */
+  // r[0..rn) -= a[0..an), an <= rn; returns the borrow out of r
+  uint64_t sub_from(uint64_t *r, size_t rn, const uint64_t *a, size_t an)
+  {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < an; ++i)
     {
-        // Save least significant bit
-        uint64_t nextCarry = res.magnitude[i] & 1;
+      unsigned __int128 d = (unsigned __int128)r[i] - a[i] - borrow;
+      r[i] = (uint64_t)d;
+      borrow = (d >> 64) != 0;
+    }
+    for (; borrow != 0 && i < rn; ++i)
+    {
+      borrow = r[i]-- == 0;
+    }
+    return borrow;
+  }
 
-        // Right shift
-        res.magnitude[i] >>= 1;
+  /* SIGNIFICANT LENGTH - HELPER */
+  size_t trimmed(const uint64_t *a, size_t n)
+  {
+    while (n > 0 && a[n - 1] == 0)
+    {
+      --n;
+    }
+    return n;
+  }
 
-        // Add carry to most significant bit
-        res.magnitude[i] |= (carry << 63);
+  /* SCHOOLBOOK MULTIPLICATION - KERNEL */
+  // out[0..n+m) = a[0..n) * b[0..m)
+  void mul_basecase(const uint64_t *a, size_t n, const uint64_t *b, size_t m, uint64_t *out)
+  {
+    BIGINT_STAT_TIER(MUL_SCHOOLBOOK, n + m);
+    std::fill(out, out + n + m, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (a[i] == 0)
+      {
+        continue;
+      }
+      uint64_t carry = 0;
+      for (size_t j = 0; j < m; ++j)
+      {
+        unsigned __int128 t = (unsigned __int128)a[i] * b[j] + out[i + j] + carry;
+        out[i + j] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+      }
+      out[i + m] = carry;
+    }
+  }
 
-        // Update carry
-        carry = nextCarry;
+  /* SCHOOLBOOK SQUARING - KERNEL */
+  // out[0..2n) = a[0..n)^2
+  void sqr_basecase(const uint64_t *a, size_t n, uint64_t *out)
+  {
+    BIGINT_STAT_TIER(SQR_SCHOOLBOOK, n);
+    // Each cross product a[i]*a[j] (i < j) appears twice in the square,
+    // so compute them once, double the sum, then add the diagonal a[i]^2
+    std::fill(out, out + 2 * n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+      uint64_t carry = 0;
+      for (size_t j = i + 1; j < n; ++j)
+      {
+        unsigned __int128 t = (unsigned __int128)a[i] * a[j] + out[i + j] + carry;
+        out[i + j] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+      }
+      out[i + n] = carry;
     }
 
-    return res;
-}
+    // Double the cross products
+    uint64_t topBit = 0;
+    for (size_t i = 0; i < 2 * n; ++i)
+    {
+      uint64_t nextBit = out[i] >> 63;
+      out[i] = (out[i] << 1) | topBit;
+      topBit = nextBit;
+    }
 
-/* DIVSION */
-BigInt BigInt::operator/(const BigInt &rhs) const
-{
-  // Edge Case
-  if (rhs.magnitude.empty() || (rhs.magnitude.size() == 1 && rhs.magnitude[0] == 0))
+    // Add the diagonal
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      unsigned __int128 sq = (unsigned __int128)a[i] * a[i];
+      unsigned __int128 lo = (unsigned __int128)out[2 * i] + (uint64_t)sq + carry;
+      out[2 * i] = (uint64_t)lo;
+      unsigned __int128 hi = (unsigned __int128)out[2 * i + 1] + (uint64_t)(sq >> 64) + (uint64_t)(lo >> 64);
+      out[2 * i + 1] = (uint64_t)hi;
+      carry = (uint64_t)(hi >> 64);
+    }
+  }
+
+  void mul_rec(const uint64_t *a, size_t n, const uint64_t *b, size_t m, uint64_t *out);
+  void sqr_rec(const uint64_t *a, size_t n, uint64_t *out);
+
+  /* KARATSUBA MIDDLE PRODUCT - HELPER */
+  // mid[0..2h+2) = (a0 + a1)(b0 + b1), where mid starts zeroed. Reads
+  // only the operands, so it can run alongside z0 and z2.
+  void karatsuba_middle(const uint64_t *a, size_t n, const uint64_t *b, size_t m,
+                        size_t h, bool square, uint64_t *mid)
   {
-    throw std::invalid_argument("Division by zero");
+    LimbVector sa(a, a + h);
+    sa.push_back(0);
+    add_into(sa.data(), h + 1, a + h, n - h);
+    size_t sn = trimmed(sa.data(), h + 1);
+
+    if (square)
+    {
+      sqr_rec(sa.data(), sn, mid);
+    }
+    else
+    {
+      LimbVector sb(b, b + h);
+      sb.push_back(0);
+      add_into(sb.data(), h + 1, b + h, m - h);
+      size_t sm = trimmed(sb.data(), h + 1);
+      if (sn >= sm)
+      {
+        mul_rec(sa.data(), sn, sb.data(), sm, mid);
+      }
+      else
+      {
+        mul_rec(sb.data(), sm, sa.data(), sn, mid);
+      }
+    }
   }
 
-  // Variables for binary search + drop signs
-  BigInt dividend = *this;
-  dividend.isNeg = false;
-  BigInt divisor = rhs;
-  BigInt low(0);
-  divisor.isNeg = false;
-  BigInt high = dividend + BigInt(1);
+  /* KARATSUBA COMBINE - HELPER */
+  // Add mid - z0 - z2 into out at block h, where z0 and z2 are already
+  // in place: z0 = out[0..2h), z2 = out[2h..n+m)
+  void karatsuba_combine(LimbVector &mid, size_t n, size_t m, size_t h, uint64_t *out)
+  {
+    // The middle term is non-negative, so the subtractions cannot
+    // borrow out of it
+    sub_from(mid.data(), mid.size(), out, 2 * h);
+    sub_from(mid.data(), mid.size(), out + 2 * h, n + m - 2 * h);
+    add_into(out + h, n + m - h, mid.data(), trimmed(mid.data(), mid.size()));
+  }
 
-  // Binary Search
-  while (low + BigInt(1) < high)
+  /* KARATSUBA MULTIPLICATION - KERNEL */
+  // out[0..n+m) = a[0..n) * b[0..m), where n >= m; out must not
+  // overlap the operands
+  void mul_rec(const uint64_t *a, size_t n, const uint64_t *b, size_t m, uint64_t *out)
   {
-    // Midpoint and current product
-    BigInt mid = divideByTwo(low + high);
-    BigInt product = divisor * mid;
+    if (m == 0)
+    {
+      std::fill(out, out + n, 0);
+      return;
+    }
+    if (m < karatsubaCutoff)
+    {
+      mul_basecase(a, n, b, m, out);
+      return;
+    }
+    BIGINT_STAT_TIER(MUL_KARATSUBA, n + m);
 
-    if (product > dividend)
+    size_t h = (n + 1) / 2;
+    if (m <= h)
     {
-      // Update high
-      high = mid;
+      // Unbalanced: multiply b by m-block slices of a
+      std::fill(out, out + n + m, 0);
+      LimbVector slice(2 * m);
+      for (size_t i = 0; i < n; i += m)
+      {
+        size_t len = std::min(m, n - i);
+        if (len >= m)
+        {
+          mul_rec(a + i, len, b, m, slice.data());
+        }
+        else
+        {
+          mul_rec(b, m, a + i, len, slice.data());
+        }
+        add_into(out + i, n + m - i, slice.data(), len + m);
+      }
+      return;
     }
-    else if (product < dividend)
+
+    // a = a0 + a1 B^h, b = b0 + b1 B^h; z0 = a0 b0 and z2 = a1 b1 go
+    // straight into their (disjoint) places in out
+    const uint64_t *a1 = a + h;
+    const uint64_t *b1 = b + h;
+    size_t a0n = trimmed(a, h);
+    size_t b0n = trimmed(b, h);
+    auto low = [=]
     {
-      // Avoid infinite loop
-      if (low == mid)
+      std::fill(out, out + 2 * h, 0);
+      if (a0n >= b0n)
       {
-        break;
+        mul_rec(a, a0n, b, b0n, out);
+      }
+      else
+      {
+        mul_rec(b, b0n, a, a0n, out);
       }
-      // Update low
-      low = mid;
+    };
+    auto high = [=]
+    {
+      mul_rec(a1, n - h, b1, m - h, out + 2 * h);
+    };
+    // Allocated here: tasks may run on threads with another limb resource
+    LimbVector mid(2 * h + 2, 0);
+    uint64_t *midOut = mid.data();
+    auto middle = [=]
+    {
+      karatsuba_middle(a, n, b, m, h, false, midOut);
+    };
+
+    if (n >= get_parallel_multiply_cutoff() && get_parallel_threads() > 1)
+    {
+      TaskGroup group;
+      group.run(low);
+      group.run(high);
+      group.run(middle);
+      group.wait();
     }
-    else // Found match
+    else
     {
-      low = mid;
-      break;
+      low();
+      high();
+      middle();
     }
+    karatsuba_combine(mid, n, m, h, out);
   }
 
-  // Assign negativity
-  BigInt result = low;
-  result.isNeg = isNeg != rhs.isNeg;
-  if (result.magnitude.size() == 1 && result.magnitude[0] == 0)
+  /* KARATSUBA SQUARING - KERNEL */
+  // out[0..2n) = a[0..n)^2; out must not overlap a
+  void sqr_rec(const uint64_t *a, size_t n, uint64_t *out)
   {
-    result.isNeg = false;
+    if (n < sqrKaratsubaCutoff)
+    {
+      sqr_basecase(a, n, out);
+      return;
+    }
+    BIGINT_STAT_TIER(SQR_KARATSUBA, n);
+
+    size_t h = (n + 1) / 2;
+    size_t a0n = trimmed(a, h);
+    auto low = [=]
+    {
+      std::fill(out, out + 2 * h, 0);
+      sqr_rec(a, a0n, out);
+    };
+    auto high = [=]
+    {
+      sqr_rec(a + h, n - h, out + 2 * h);
+    };
+    LimbVector mid(2 * h + 2, 0);
+    uint64_t *midOut = mid.data();
+    auto middle = [=]
+    {
+      karatsuba_middle(a, n, a, n, h, true, midOut);
+    };
+
+    if (n >= get_parallel_multiply_cutoff() && get_parallel_threads() > 1)
+    {
+      TaskGroup group;
+      group.run(low);
+      group.run(high);
+      group.run(middle);
+      group.wait();
+    }
+    else
+    {
+      low();
+      high();
+      middle();
+    }
+    karatsuba_combine(mid, n, n, h, out);
   }
-  return result;
 }
 
-/* TO DECIMAL */
-std::string BigInt::to_dec() const
+/* KARATSUBA CUTOFFS */
+void set_karatsuba_cutoff(size_t blocks)
 {
-  // Edge Case
-  if (magnitude.size() == 1 && magnitude[0] == 0)
+  karatsubaCutoff.store(std::max(blocks, MIN_KARATSUBA_CUTOFF), std::memory_order_relaxed);
+}
+
+size_t get_karatsuba_cutoff()
+{
+  return karatsubaCutoff.load(std::memory_order_relaxed);
+}
+
+void set_sqr_karatsuba_cutoff(size_t blocks)
+{
+  sqrKaratsubaCutoff.store(std::max(blocks, MIN_KARATSUBA_CUTOFF), std::memory_order_relaxed);
+}
+
+size_t get_sqr_karatsuba_cutoff()
+{
+  return sqrKaratsubaCutoff.load(std::memory_order_relaxed);
+}
+
+/* MULTIPLICATION - KERNEL */
+void BigInt::mul_mag(const LimbVector &leftMag, const LimbVector &rightMag, LimbVector &prodMag)
+{
+  // prodMag must not alias either operand
+  mul_limbs(leftMag.data(), used_blocks(leftMag), rightMag.data(), used_blocks(rightMag), prodMag);
+}
+
+/* MULTIPLY LIMB ARRAYS - KERNEL */
+void BigInt::mul_limbs(const uint64_t *a, size_t n, const uint64_t *b, size_t m, LimbVector &prodMag)
+{
+  n = trimmed(a, n);
+  m = trimmed(b, m);
+  prodMag.resize(n + m);
+  if (n >= m)
   {
-    return "0";
+    mul_rec(a, n, b, m, prodMag.data());
   }
+  else
+  {
+    mul_rec(b, m, a, n, prodMag.data());
+  }
+  remove_zeroes(prodMag);
+}
 
-  // String stream
-  std::stringstream ss;
+/* ADD LIMB ARRAYS - KERNEL */
+void BigInt::add_limbs(const uint64_t *a, size_t n, const uint64_t *b, size_t m, LimbVector &sumMag)
+{
+  if (n < m)
+  {
+    std::swap(a, b);
+    std::swap(n, m);
+  }
+  sumMag.assign(a, a + n);
+  sumMag.push_back(0);
+  add_into(sumMag.data(), n + 1, b, m);
+  remove_zeroes(sumMag);
+}
 
-  // Variables
-  std::string result;
-  std::string temp;
+/* SUBTRACT LIMB ARRAYS - KERNEL */
+bool BigInt::sub_limbs(const uint64_t *a, size_t n, const uint64_t *b, size_t m, LimbVector &diffMag)
+{
+  // diffMag = |a - b|; returns true if b > a
+  n = trimmed(a, n);
+  m = trimmed(b, m);
+  bool swapped = n < m;
+  if (n == m)
+  {
+    size_t i = n;
+    while (i > 0 && a[i - 1] == b[i - 1])
+    {
+      --i;
+    }
+    swapped = i > 0 && a[i - 1] < b[i - 1];
+  }
+  if (swapped)
+  {
+    std::swap(a, b);
+    std::swap(n, m);
+  }
+  diffMag.assign(a, a + n);
+  sub_from(diffMag.data(), n, b, m);
+  remove_zeroes(diffMag);
+  return swapped;
+}
+
+/* SQUARING - KERNEL */
+void BigInt::sqr_mag(const LimbVector &mag, LimbVector &prodMag)
+{
+  size_t n = used_blocks(mag);
+  prodMag.resize(2 * n);
+  sqr_rec(mag.data(), n, prodMag.data());
+  remove_zeroes(prodMag);
+}
+
+/* MULTIPLY BY ONE BLOCK - HELPER */
+LimbVector BigInt::mul_1(const LimbVector &mag, uint64_t factor)
+{
+  LimbVector product(mag.size() + 1);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < mag.size(); ++i)
+  {
+    unsigned __int128 t = (unsigned __int128)mag[i] * factor + carry;
+    product[i] = (uint64_t)t;
+    carry = (uint64_t)(t >> 64);
+  }
+  product[mag.size()] = carry;
+  remove_zeroes(product);
+  return product;
+}
+
+namespace
+{
+  // Division by one block with a precomputed reciprocal (Moller and
+  // Granlund, "Improved division by invariant integers", 2011): each
+  // block takes two multiplications instead of a hardware division
+  struct Reciprocal
+  {
+    uint64_t d;     // divisor shifted so that its top bit is set
+    uint64_t v;     // floor((2^128 - 1) / d) - 2^64
+    unsigned shift; // how far the divisor was shifted
+  };
 
-  // Copy BigInt to modify
-  BigInt copy = *this;
+  /* RECIPROCAL - HELPER */
+  Reciprocal make_reciprocal(uint64_t divisor)
+  {
+    Reciprocal r;
+    r.shift = __builtin_clzll(divisor);
+    r.d = divisor << r.shift;
+    r.v = (uint64_t)((((unsigned __int128)~r.d << 64) | ~0ULL) / r.d);
+    return r;
+  }
 
-  // Set negativity and drop sign
-  bool isNeg = copy.isNeg;
-  copy.isNeg = false;
+  /* TWO BY ONE DIVISION - KERNEL */
+  // Quotient of (hi, lo) by r.d, where hi < r.d; the remainder goes to rem
+  inline uint64_t div_2by1(uint64_t hi, uint64_t lo, const Reciprocal &r, uint64_t &rem)
+  {
+    unsigned __int128 q = (unsigned __int128)r.v * hi + (((unsigned __int128)hi << 64) | lo);
+    uint64_t q1 = (uint64_t)(q >> 64) + 1;
+    uint64_t q0 = (uint64_t)q;
+    uint64_t rest = lo - q1 * r.d;
 
-  BigInt zero(0);
+    // The first correction is unpredictable, so it is masked rather
+    // than branched on; the second is rare
+    uint64_t mask = 0 - (uint64_t)(rest > q0);
+    q1 += mask;
+    rest += mask & r.d;
+    if (__builtin_expect(rest >= r.d, 0))
+    {
+      ++q1;
+      rest -= r.d;
+    }
+    rem = rest;
+    return q1;
+  }
 
-  // Convert to base 10
-  while (copy > zero)
+  /* DIVIDE BY RECIPROCAL - KERNEL */
+  // q[0..n) = a[0..n) / divisor, returning the remainder; q may be a
+  uint64_t div_limbs(const uint64_t *a, size_t n, const Reciprocal &r, uint64_t *q)
   {
-    // Repeatedly divide by 10
-    BigInt base10 = copy / 10;
+    if (n == 0)
+    {
+      return 0;
+    }
+    unsigned s = r.shift;
 
-    // Append remainder
-    temp = std::to_string((copy - (base10 * 10)).get_bits(0));
+    // Work on the dividend shifted left like the divisor; the bits
+    // shifted out of the top block start the remainder
+    uint64_t rem = s ? a[n - 1] >> (64 - s) : 0;
+    for (size_t i = n; i-- > 0;)
+    {
+      uint64_t lo = a[i] << s;
+      if (s && i > 0)
+      {
+        lo |= a[i - 1] >> (64 - s);
+      }
+      q[i] = div_2by1(rem, lo, r, rem);
+    }
+    return rem >> s;
+  }
 
-    // Store to stream and update copy
-    ss << temp;
-    copy = base10;
+  /* REMAINDER BY RECIPROCAL - KERNEL */
+  // a[0..n) % divisor, as div_limbs without storing the quotient
+  uint64_t mod_limbs(const uint64_t *a, size_t n, const Reciprocal &r)
+  {
+    if (n == 0)
+    {
+      return 0;
+    }
+    unsigned s = r.shift;
+    uint64_t rem = s ? a[n - 1] >> (64 - s) : 0;
+    for (size_t i = n; i-- > 0;)
+    {
+      uint64_t lo = a[i] << s;
+      if (s && i > 0)
+      {
+        lo |= a[i - 1] >> (64 - s);
+      }
+      div_2by1(rem, lo, r, rem);
+    }
+    return rem >> s;
   }
+}
 
-  // Reverse string
-  result = ss.str();
-  std::reverse(result.begin(), result.end());
+/* DIVIDE BY ONE BLOCK - HELPER */
+uint64_t BigInt::div_1(LimbVector &mag, uint64_t divisor)
+{
+  // Divides mag in place and returns the remainder
+  uint64_t rem = div_limbs(mag.data(), mag.size(), make_reciprocal(divisor), mag.data());
+  remove_zeroes(mag);
+  return rem;
+}
 
-  // Assign negativity
-  if (isNeg)
+/* DIVIDE BY ONE BLOCK */
+uint64_t BigInt::div_1(uint64_t divisor)
+{
+  if (divisor == 0)
   {
-    result.insert(result.begin(), '-');
+    throw std::invalid_argument("Division by zero");
   }
+  uint64_t rem = div_1(magnitude, divisor);
+  isNeg = isNeg && !is_zero_mag(magnitude);
+  return rem;
+}
 
+/* DIVIDE BY 64-BIT VALUE */
+std::pair<BigInt, uint64_t> divmod_u64(const BigInt &n, uint64_t divisor)
+{
+  std::pair<BigInt, uint64_t> result(n, 0);
+  result.second = result.first.div_1(divisor);
   return result;
 }
+
+/* SUBTRACT IN PLACE - HELPER */
+void BigInt::sub_in_place(LimbVector &leftMag, const LimbVector &rightMag)
+{
+  // Requires leftMag >= rightMag
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < leftMag.size(); ++i)
+  {
+    uint64_t rightVal = i < rightMag.size() ? rightMag[i] : 0;
+    if (i >= rightMag.size() && borrow == 0)
+    {
+      break;
+    }
+    unsigned __int128 d = (unsigned __int128)leftMag[i] - rightVal - borrow;
+    leftMag[i] = (uint64_t)d;
+    borrow = (d >> 64) != 0;
+  }
+  remove_zeroes(leftMag);
+}
+
+/* LINEAR COMBINATION - HELPER */
+LimbVector BigInt::combine_mag(const LimbVector &u, const LimbVector &v, int64_t p, int64_t q)
+{
+  // Computes p*u + q*v for cofactors of opposite sign (as produced by
+  // Lehmer's algorithm), where the result is known to be non-negative
+  LimbVector pu = mul_1(u, (uint64_t)(p < 0 ? -p : p));
+  LimbVector qv = mul_1(v, (uint64_t)(q < 0 ? -q : q));
+  if (q <= 0)
+  {
+    sub_in_place(pu, qv);
+    return pu;
+  }
+  sub_in_place(qv, pu);
+  return qv;
+}
+
+namespace
+{
+  /* LONG DIVISION - KERNEL */
+  // Schoolbook long division (Knuth, TAOCP vol. 2, algorithm D) of
+  // normalized operands: v[0..n) has its top bit set and n >= 2, and
+  // u has m + n + 1 blocks, shifted like v (so u < v * 2^(64 * (m + 1))).
+  // Writes the quotient to q[0..m] and leaves the remainder in u[0..n);
+  // `top` is the reciprocal of v[n - 1].
+  void div_normalized(uint64_t *u, size_t m, const uint64_t *v, size_t n, const Reciprocal &top, uint64_t *q)
+  {
+    for (size_t j = m + 1; j-- > 0;)
+    {
+      // Estimate the quotient block from the top two blocks
+      uint64_t qhat;
+      uint64_t rhat;
+      bool rhatOverflow = false;
+      if (u[j + n] >= v[n - 1])
+      {
+        qhat = ~0ULL;
+        rhat = u[j + n - 1] + v[n - 1];
+        rhatOverflow = rhat < v[n - 1];
+      }
+      else
+      {
+        qhat = div_2by1(u[j + n], u[j + n - 1], top, rhat);
+      }
+      while (!rhatOverflow &&
+             (unsigned __int128)qhat * v[n - 2] > (((unsigned __int128)rhat << 64) | u[j + n - 2]))
+      {
+        --qhat;
+        rhat += v[n - 1];
+        rhatOverflow = rhat < v[n - 1];
+      }
+
+      // Multiply and subtract
+      uint64_t borrow = 0;
+      uint64_t carry = 0;
+      for (size_t i = 0; i < n; ++i)
+      {
+        unsigned __int128 p = (unsigned __int128)qhat * v[i] + carry;
+        carry = (uint64_t)(p >> 64);
+        unsigned __int128 d = (unsigned __int128)u[i + j] - (uint64_t)p - borrow;
+        u[i + j] = (uint64_t)d;
+        borrow = (d >> 64) != 0;
+      }
+      unsigned __int128 d = (unsigned __int128)u[j + n] - carry - borrow;
+      u[j + n] = (uint64_t)d;
+
+      // Estimate was one too large: add the divisor back
+      if ((d >> 64) != 0)
+      {
+        --qhat;
+        uint64_t addCarry = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+          unsigned __int128 s = (unsigned __int128)u[i + j] + v[i] + addCarry;
+          u[i + j] = (uint64_t)s;
+          addCarry = (uint64_t)(s >> 64);
+        }
+        u[j + n] += addCarry;
+      }
+      q[j] = qhat;
+    }
+  }
+
+  /* SHIFT LEFT - HELPER */
+  // out[0..n] = a[0..n) << shift, for shift < 64
+  void shift_left(const uint64_t *a, size_t n, unsigned shift, uint64_t *out)
+  {
+    out[n] = shift ? a[n - 1] >> (64 - shift) : 0;
+    for (size_t i = n; i-- > 1;)
+    {
+      out[i] = shift ? (a[i] << shift) | (a[i - 1] >> (64 - shift)) : a[i];
+    }
+    out[0] = a[0] << shift;
+  }
+
+  /* SHIFT RIGHT - HELPER */
+  // a[0..n) >>= shift in place, for shift < 64
+  void shift_right(uint64_t *a, size_t n, unsigned shift)
+  {
+    if (shift == 0)
+    {
+      return;
+    }
+    for (size_t i = 0; i + 1 < n; ++i)
+    {
+      a[i] = (a[i] >> shift) | (a[i + 1] << (64 - shift));
+    }
+    a[n - 1] >>= shift;
+  }
+
+  /* COMPARE BLOCKS - HELPER */
+  // Sign of a[0..n) - b[0..n)
+  int compare_blocks(const uint64_t *a, const uint64_t *b, size_t n)
+  {
+    for (size_t i = n; i-- > 0;)
+    {
+      if (a[i] != b[i])
+      {
+        return a[i] < b[i] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+}
+
+/* DIVISION - HELPER */
+void BigInt::divmod_mag(const LimbVector &leftMag, const LimbVector &rightMag,
+                        LimbVector &quotMag, LimbVector &remMag)
+{
+  size_t un = used_blocks(leftMag);
+  size_t n = used_blocks(rightMag);
+
+  // Edge Case: dividend smaller than divisor
+  if (compare_mag(leftMag, rightMag) < 0)
+  {
+    quotMag = {0};
+    remMag.assign(leftMag.begin(), leftMag.begin() + un);
+    remove_zeroes(remMag);
+    return;
+  }
+
+  // Edge Case: single block divisor
+  if (n == 1)
+  {
+    BIGINT_STAT_TIER(DIV_SINGLE_LIMB, un + 1);
+    quotMag.resize(un);
+    uint64_t rem = div_limbs(leftMag.data(), un, make_reciprocal(rightMag[0]), quotMag.data());
+    remove_zeroes(quotMag);
+    remMag = {rem};
+    return;
+  }
+
+  // Normalize so that the top bit of the divisor is set
+  BIGINT_STAT_TIER(DIV_SCHOOLBOOK, un + n);
+  size_t m = un - n;
+  unsigned shift = __builtin_clzll(rightMag[n - 1]);
+  LimbVector v(n + 1);
+  shift_left(rightMag.data(), n, shift, v.data());
+  v.pop_back();
+  LimbVector u(un + 1);
+  shift_left(leftMag.data(), un, shift, u.data());
+
+  quotMag.assign(m + 1, 0);
+  div_normalized(u.data(), m, v.data(), n, make_reciprocal(v[n - 1]), quotMag.data());
+
+  // Unnormalize the remainder
+  remMag.assign(u.begin(), u.begin() + n);
+  shift_right(remMag.data(), n, shift);
+  remove_zeroes(quotMag);
+  remove_zeroes(remMag);
+}
+
+namespace
+{
+  /* HENSEL DIVISION - KERNEL */
+  // q[0..qn) = a[0..qn) / b mod 2^(64 * qn), for odd b[0..bn) with
+  // binv = b[0]^-1 mod 2^64; a[0..qn) is overwritten. Works from the
+  // least significant block up: each quotient block is the one that
+  // clears the lowest remaining block of a.
+  void bdiv_basecase(uint64_t *a, size_t qn, const uint64_t *b, size_t bn, uint64_t binv, uint64_t *q)
+  {
+    for (size_t i = 0; i < qn; ++i)
+    {
+      uint64_t qi = a[i] * binv;
+      q[i] = qi;
+
+      // a[i..qn) -= qi * b, dropping what falls above block qn
+      size_t len = std::min(bn, qn - i);
+      uint64_t borrow = 0;
+      for (size_t j = 0; j < len; ++j)
+      {
+        unsigned __int128 p = (unsigned __int128)qi * b[j] + borrow;
+        uint64_t lo = (uint64_t)p;
+        borrow = (uint64_t)(p >> 64) + (a[i + j] < lo);
+        a[i + j] -= lo;
+      }
+      for (size_t k = i + len; borrow != 0 && k < qn; ++k)
+      {
+        uint64_t t = a[k];
+        a[k] = t - borrow;
+        borrow = t < borrow;
+      }
+    }
+  }
+
+  /* HENSEL DIVISION - KERNEL */
+  // Same as bdiv_basecase, divide and conquer: the low half of the
+  // quotient comes from the low half of a; subtracting its product with
+  // b (a Karatsuba multiplication) leaves the problem for the high half
+  void bdiv_rec(uint64_t *a, size_t qn, const uint64_t *b, size_t bn, uint64_t binv, uint64_t *q)
+  {
+    bn = std::min(bn, qn);
+    if (std::min(qn, bn) < 4 * karatsubaCutoff)
+    {
+      bdiv_basecase(a, qn, b, bn, binv, q);
+      return;
+    }
+
+    size_t lo = qn / 2;
+    bdiv_rec(a, lo, b, bn, binv, q);
+
+    size_t qlo = trimmed(q, lo);
+    LimbVector prod(qlo + bn, 0);
+    if (qlo >= bn)
+    {
+      mul_rec(q, qlo, b, bn, prod.data());
+    }
+    else if (qlo > 0)
+    {
+      mul_rec(b, bn, q, qlo, prod.data());
+    }
+    size_t high = std::min(prod.size(), qn);
+    if (high > lo)
+    {
+      sub_from(a + lo, qn - lo, prod.data() + lo, high - lo);
+    }
+    bdiv_rec(a + lo, qn - lo, b, bn, binv, q + lo);
+  }
+}
+
+/* EXACT DIVISION - HELPER */
+void BigInt::divexact_mag(const LimbVector &leftMag, const LimbVector &rightMag, LimbVector &quotMag)
+{
+  size_t an = used_blocks(leftMag);
+  size_t bn = used_blocks(rightMag);
+
+  // Remove the factors of two of the divisor from both operands (the
+  // dividend has at least as many), so the divisor is odd
+  size_t zeroBlocks = 0;
+  while (rightMag[zeroBlocks] == 0)
+  {
+    ++zeroBlocks;
+  }
+  if (an <= zeroBlocks)
+  {
+    quotMag = {0};
+    return;
+  }
+  LimbVector a(leftMag.begin() + zeroBlocks, leftMag.begin() + an);
+  LimbVector b(rightMag.begin() + zeroBlocks, rightMag.begin() + bn);
+  unsigned shift = __builtin_ctzll(b[0]);
+  if (shift)
+  {
+    for (LimbVector *v : {&a, &b})
+    {
+      for (size_t i = 0; i + 1 < v->size(); ++i)
+      {
+        (*v)[i] = ((*v)[i] >> shift) | ((*v)[i + 1] << (64 - shift));
+      }
+      v->back() >>= shift;
+    }
+  }
+  an = used_blocks(a);
+  bn = used_blocks(b);
+  if (an < bn)
+  {
+    quotMag = {0};
+    return;
+  }
+
+  // The quotient fits in an - bn + 1 blocks, so it equals the quotient
+  // modulo 2^(64 * (an - bn + 1))
+  size_t qn = an - bn + 1;
+  quotMag.assign(qn, 0);
+  bdiv_rec(a.data(), qn, b.data(), bn, -mont_inverse(b[0]), quotMag.data());
+  remove_zeroes(quotMag);
+}
+
+/* EXACT DIVISION */
+BigInt divexact(const BigInt &a, const BigInt &b)
+{
+  if (BigInt::is_zero_mag(b.magnitude))
+  {
+    throw std::invalid_argument("Division by zero");
+  }
+  BigInt quotient;
+  BigInt::divexact_mag(a.magnitude, b.magnitude, quotient.magnitude);
+  quotient.isNeg = (a.isNeg != b.isNeg) && !BigInt::is_zero_mag(quotient.magnitude);
+  return quotient;
+}
+
+/* DIVSION */
+BigInt BigInt::operator/(const BigInt &rhs) const
+{
+  BIGINT_STAT_OP(DIV, magnitude.size() + rhs.magnitude.size());
+  // Edge Case
+  if (is_zero_mag(rhs.magnitude))
+  {
+    throw std::invalid_argument("Division by zero");
+  }
+
+  BigInt quotient;
+  LimbVector remainder;
+  divmod_mag(magnitude, rhs.magnitude, quotient.magnitude, remainder);
+
+  // Assign negativity
+  quotient.isNeg = (isNeg != rhs.isNeg) && !is_zero_mag(quotient.magnitude);
+  return quotient;
+}
+
+/* REMAINDER */
+BigInt BigInt::operator%(const BigInt &rhs) const
+{
+  BIGINT_STAT_OP(MOD, magnitude.size() + rhs.magnitude.size());
+  // Edge Case
+  if (is_zero_mag(rhs.magnitude))
+  {
+    throw std::invalid_argument("Division by zero");
+  }
+
+  BigInt remainder;
+  LimbVector quotient;
+  divmod_mag(magnitude, rhs.magnitude, quotient, remainder.magnitude);
+
+  // Remainder takes the sign of the dividend
+  remainder.isNeg = isNeg && !is_zero_mag(remainder.magnitude);
+  return remainder;
+}
+
+///////////////////////////////////////////////////////////////////
+/////////////////////* MIXED-TYPE ARITHMETIC */////////////////////
+//////////////////////////////////////////////////////////////////
+
+/* SIGNED ADDITION OF A SCALAR - HELPER */
+void BigInt::add_signed(const LimbVector &mag, bool negative, const Scalar &rhs, BigInt &sum)
+{
+  size_t n = used_blocks(mag);
+  size_t m = trimmed(rhs.blocks, 2);
+  if (negative == rhs.negative)
+  {
+    add_limbs(mag.data(), n, rhs.blocks, m, sum.magnitude);
+    sum.isNeg = negative;
+  }
+  else
+  {
+    // The larger magnitude decides the sign
+    bool swapped = sub_limbs(mag.data(), n, rhs.blocks, m, sum.magnitude);
+    sum.isNeg = swapped ? rhs.negative : negative;
+  }
+  sum.isNeg = sum.isNeg && !is_zero_mag(sum.magnitude);
+}
+
+/* ADD SCALAR */
+BigInt BigInt::add_scalar(const Scalar &rhs) const
+{
+  BIGINT_STAT_OP(ADD, magnitude.size() + 1);
+  BigInt sum;
+  add_signed(magnitude, isNeg, rhs, sum);
+  return sum;
+}
+
+/* SUBTRACT SCALAR */
+BigInt BigInt::sub_scalar(Scalar rhs) const
+{
+  BIGINT_STAT_OP(SUB, magnitude.size() + 1);
+  rhs.negative = !rhs.negative;
+  BigInt difference;
+  add_signed(magnitude, isNeg, rhs, difference);
+  return difference;
+}
+
+/* MULTIPLY BY SCALAR */
+BigInt BigInt::mul_scalar(const Scalar &rhs) const
+{
+  BIGINT_STAT_OP(MUL, magnitude.size() + 1);
+  BigInt product;
+  if (rhs.blocks[1] == 0)
+  {
+    product.magnitude = mul_1(magnitude, rhs.blocks[0]);
+  }
+  else
+  {
+    mul_limbs(magnitude.data(), magnitude.size(), rhs.blocks, 2, product.magnitude);
+  }
+  product.isNeg = (isNeg != rhs.negative) && !is_zero_mag(product.magnitude);
+  return product;
+}
+
+/* DIVIDE BY SCALAR */
+BigInt BigInt::div_scalar(const Scalar &rhs) const
+{
+  BIGINT_STAT_OP(DIV, magnitude.size() + 1);
+  BigInt quotient;
+  if (rhs.blocks[1] == 0)
+  {
+    if (rhs.blocks[0] == 0)
+    {
+      throw std::invalid_argument("Division by zero");
+    }
+    BIGINT_STAT_TIER(DIV_SINGLE_LIMB, magnitude.size() + 1);
+    size_t n = used_blocks(magnitude);
+    quotient.magnitude.resize(n);
+    div_limbs(magnitude.data(), n, make_reciprocal(rhs.blocks[0]), quotient.magnitude.data());
+    remove_zeroes(quotient.magnitude);
+  }
+  else
+  {
+    LimbVector remainder;
+    divmod_mag(magnitude, LimbVector(rhs.blocks, rhs.blocks + 2), quotient.magnitude, remainder);
+  }
+  quotient.isNeg = (isNeg != rhs.negative) && !is_zero_mag(quotient.magnitude);
+  return quotient;
+}
+
+/* REMAINDER BY SCALAR */
+BigInt BigInt::mod_scalar(const Scalar &rhs) const
+{
+  BIGINT_STAT_OP(MOD, magnitude.size() + 1);
+  BigInt remainder;
+  if (rhs.blocks[1] == 0)
+  {
+    if (rhs.blocks[0] == 0)
+    {
+      throw std::invalid_argument("Division by zero");
+    }
+    BIGINT_STAT_TIER(DIV_SINGLE_LIMB, magnitude.size() + 1);
+    remainder.magnitude[0] = mod_limbs(magnitude.data(), used_blocks(magnitude), make_reciprocal(rhs.blocks[0]));
+  }
+  else
+  {
+    LimbVector quotient;
+    divmod_mag(magnitude, LimbVector(rhs.blocks, rhs.blocks + 2), quotient, remainder.magnitude);
+  }
+  remainder.isNeg = isNeg && !is_zero_mag(remainder.magnitude);
+  return remainder;
+}
+
+/* COMPARE WITH SCALAR */
+int BigInt::compare_scalar(const Scalar &rhs) const
+{
+  BIGINT_STAT_OP(COMPARE, magnitude.size() + 1);
+  size_t n = used_blocks(magnitude);
+  bool lneg = isNeg && n > 0;
+  bool rneg = rhs.negative && (rhs.blocks[0] | rhs.blocks[1]) != 0;
+  if (lneg != rneg)
+  {
+    return lneg ? -1 : 1;
+  }
+
+  int result = 1;
+  if (n <= 2)
+  {
+    unsigned __int128 left = n == 0 ? 0 : magnitude[0];
+    if (n == 2)
+    {
+      left |= (unsigned __int128)magnitude[1] << 64;
+    }
+    unsigned __int128 right = ((unsigned __int128)rhs.blocks[1] << 64) | rhs.blocks[0];
+    result = left == right ? 0 : (left < right ? -1 : 1);
+  }
+  return lneg ? -result : result;
+}
+
+/* FITS IN UINT64 */
+bool BigInt::fits_u64() const
+{
+  return used_blocks(magnitude) <= 1 && !(isNeg && !is_zero_mag(magnitude));
+}
+
+/* CONVERT TO UINT64 */
+uint64_t BigInt::to_u64() const
+{
+  if (!fits_u64())
+  {
+    throw std::invalid_argument("Value does not fit in 64 bits");
+  }
+  return get_bits(0);
+}
+
+/* CONVERT TO INT64 */
+int64_t BigInt::to_i64() const
+{
+  uint64_t low = get_bits(0);
+  uint64_t limit = isNeg ? (uint64_t)1 << 63 : ((uint64_t)1 << 63) - 1;
+  if (used_blocks(magnitude) > 1 || low > limit)
+  {
+    throw std::invalid_argument("Value does not fit in 64 bits");
+  }
+  // Negate in unsigned arithmetic so that -2^63 does not overflow
+  return (int64_t)(isNeg ? 0 - low : low);
+}
+
+/* CONVERT TO INT128 */
+__int128 BigInt::to_i128() const
+{
+  unsigned __int128 mag = ((unsigned __int128)get_bits(1) << 64) | get_bits(0);
+  unsigned __int128 limit = ((unsigned __int128)1 << 127) - (isNeg ? 0 : 1);
+  if (used_blocks(magnitude) > 2 || mag > limit)
+  {
+    throw std::invalid_argument("Value does not fit in 128 bits");
+  }
+  return (__int128)(isNeg ? 0 - mag : mag);
+}
+
+///////////////////////////////////////////////////////////////////
+/////////////////////* PRECOMPUTED DIVISOR */////////////////////////
+//////////////////////////////////////////////////////////////////
+
+/* CONSTRUCTOR */
+Divisor::Divisor(const BigInt &divisor)
+    : value(divisor), shift(0), inverse(0)
+{
+  size_t n = BigInt::used_blocks(divisor.magnitude);
+  if (n == 0)
+  {
+    throw std::invalid_argument("Division by zero");
+  }
+  shift = __builtin_clzll(divisor.magnitude[n - 1]);
+  norm.resize(n + 1);
+  shift_left(divisor.magnitude.data(), n, shift, norm.data());
+  norm.pop_back();
+  inverse = make_reciprocal(norm[n - 1]).v;
+
+  // Barrett division pays off once its products use Karatsuba
+  if (n >= 4 * karatsubaCutoff)
+  {
+    reciprocal = reciprocal_of(norm);
+  }
+}
+
+/* RECIPROCAL - HELPER */
+LimbVector Divisor::reciprocal_of(const LimbVector &norm)
+{
+  // floor(2^(128n) / norm) for a normalized norm of n blocks
+  size_t n = norm.size();
+  LimbVector power(2 * n + 1, 0);
+  power[2 * n] = 1;
+  if (n < 4 * karatsubaCutoff)
+  {
+    LimbVector quot, rem;
+    BigInt::divmod_mag(power, norm, quot, rem);
+    return quot;
+  }
+
+  // Start from the reciprocal of the top k blocks, accurate to about
+  // 64k bits, and double its precision with one Newton step:
+  // x += x * (2^(128n) - norm * x) / 2^(128n)
+  size_t k = n / 2 + 1;
+  BigInt d;
+  d.magnitude = norm;
+  BigInt x;
+  x.magnitude.assign(n - k, 0);
+  LimbVector top = reciprocal_of(LimbVector(norm.begin() + (n - k), norm.end()));
+  x.magnitude.insert(x.magnitude.end(), top.begin(), top.end());
+  BigInt one;
+  one.magnitude = power;
+  BigInt error = one - d * x;
+  BigInt step = x * error;
+  if (step.magnitude.size() > 2 * n)
+  {
+    BigInt delta;
+    delta.magnitude.assign(step.magnitude.begin() + 2 * n, step.magnitude.end());
+    x = step.is_negative() ? x - delta : x + delta;
+  }
+
+  // The estimate is now within a few units; make it exact
+  BigInt rem = one - d * x;
+  while (rem < 0)
+  {
+    x = x - 1;
+    rem = rem + d;
+  }
+  while (rem >= d)
+  {
+    x = x + 1;
+    rem = rem - d;
+  }
+  BigInt::remove_zeroes(x.magnitude);
+  return x.magnitude;
+}
+
+/* DIVISOR VALUE */
+const BigInt &Divisor::get_value() const
+{
+  return value;
+}
+
+/* DIVIDE */
+BigInt Divisor::divide(const BigInt &dividend) const
+{
+  BigInt quotient;
+  LimbVector remainder;
+  divmod_mag(dividend.magnitude, quotient.magnitude, remainder);
+  quotient.isNeg = (dividend.isNeg != value.isNeg) && !BigInt::is_zero_mag(quotient.magnitude);
+  return quotient;
+}
+
+/* MODULO */
+BigInt Divisor::mod(const BigInt &dividend) const
+{
+  BigInt remainder;
+  LimbVector quotient;
+  divmod_mag(dividend.magnitude, quotient, remainder.magnitude);
+  remainder.isNeg = dividend.isNeg && !BigInt::is_zero_mag(remainder.magnitude);
+  return remainder;
+}
+
+/* DIVIDE WITH REMAINDER */
+void Divisor::divmod(const BigInt &dividend, BigInt &quotient, BigInt &remainder) const
+{
+  LimbVector quotMag;
+  LimbVector remMag;
+  divmod_mag(dividend.magnitude, quotMag, remMag);
+  bool negative = dividend.isNeg;
+  quotient.magnitude = std::move(quotMag);
+  quotient.isNeg = (negative != value.isNeg) && !BigInt::is_zero_mag(quotient.magnitude);
+  remainder.magnitude = std::move(remMag);
+  remainder.isNeg = negative && !BigInt::is_zero_mag(remainder.magnitude);
+}
+
+/* DIVISION - HELPER */
+void Divisor::divmod_mag(const LimbVector &dividend, LimbVector &quotMag, LimbVector &remMag) const
+{
+  size_t an = BigInt::used_blocks(dividend);
+  size_t n = norm.size();
+  if (BigInt::compare_mag(dividend, value.magnitude) < 0)
+  {
+    quotMag = {0};
+    remMag.assign(dividend.begin(), dividend.begin() + an);
+    BigInt::remove_zeroes(remMag);
+    return;
+  }
+
+  if (n == 1)
+  {
+    BIGINT_STAT_TIER(DIV_SINGLE_LIMB, an + 1);
+    quotMag.resize(an);
+    remMag = {div_limbs(dividend.data(), an, Reciprocal{norm[0], inverse, shift}, quotMag.data())};
+    BigInt::remove_zeroes(quotMag);
+    return;
+  }
+
+  LimbVector u(an + 1);
+  shift_left(dividend.data(), an, shift, u.data());
+  if (!reciprocal.empty())
+  {
+    barrett(u, quotMag, remMag);
+  }
+  else
+  {
+    BIGINT_STAT_TIER(DIV_SCHOOLBOOK, an + n);
+    quotMag.assign(an - n + 1, 0);
+    div_normalized(u.data(), an - n, norm.data(), n, Reciprocal{norm[n - 1], inverse, 0}, quotMag.data());
+    remMag.assign(u.begin(), u.begin() + n);
+  }
+
+  shift_right(remMag.data(), n, shift);
+  BigInt::remove_zeroes(quotMag);
+  BigInt::remove_zeroes(remMag);
+}
+
+/* BARRETT DIVISION - HELPER */
+void Divisor::barrett(LimbVector &u, LimbVector &quotMag, LimbVector &remMag) const
+{
+  // Long division in base 2^(64n): each step divides the remainder so
+  // far, followed by the next n blocks of u, by norm. With x < norm *
+  // 2^(64n), the estimate floor(floor(x / 2^(64(n-1))) * reciprocal /
+  // 2^(64(n+1))) is at most two below the true quotient block.
+  BIGINT_STAT_TIER(DIV_BARRETT, u.size() + norm.size());
+  size_t n = norm.size();
+  size_t steps = (u.size() + n - 1) / n;
+  size_t rn = trimmed(reciprocal.data(), reciprocal.size());
+  quotMag.assign(steps * n, 0);
+  LimbVector x(2 * n, 0); // remainder so far (high half) and the next blocks
+  LimbVector estimate(2 * n + 2);
+  LimbVector product(2 * n + 1);
+
+  for (size_t step = steps; step-- > 0;)
+  {
+    size_t lo = step * n;
+    size_t len = std::min(n, u.size() - lo);
+    std::copy(u.begin() + lo, u.begin() + lo + len, x.begin());
+    std::fill(x.begin() + len, x.begin() + n, 0);
+
+    // Estimate the quotient block
+    size_t xn = trimmed(x.data() + n - 1, n + 1);
+    std::fill(estimate.begin(), estimate.end(), 0);
+    if (xn >= rn)
+    {
+      mul_rec(x.data() + n - 1, xn, reciprocal.data(), rn, estimate.data());
+    }
+    else
+    {
+      mul_rec(reciprocal.data(), rn, x.data() + n - 1, xn, estimate.data());
+    }
+    uint64_t *qhat = estimate.data() + n + 1; // n + 1 blocks
+
+    // x -= qhat * norm, leaving less than 3 * norm
+    size_t qn = trimmed(qhat, n + 1);
+    std::fill(product.begin(), product.end(), 0);
+    if (qn >= n)
+    {
+      mul_rec(qhat, qn, norm.data(), n, product.data());
+    }
+    else if (qn > 0)
+    {
+      mul_rec(norm.data(), n, qhat, qn, product.data());
+    }
+    sub_from(x.data(), 2 * n, product.data(), trimmed(product.data(), 2 * n));
+
+    // Correct the estimate
+    const uint64_t one = 1;
+    while (x[n] != 0 || compare_blocks(x.data(), norm.data(), n) >= 0)
+    {
+      sub_from(x.data(), n + 1, norm.data(), n);
+      add_into(qhat, n + 1, &one, 1);
+    }
+    std::copy(qhat, qhat + n, quotMag.begin() + lo);
+    std::copy(x.begin(), x.begin() + n, x.begin() + n);
+  }
+
+  remMag.assign(x.begin() + n, x.end());
+}
+
+namespace
+{
+  // Decimal conversion works on 19-digit chunks, the largest power of
+  // ten that fits in one block
+  const uint64_t DEC_BLOCK_POWER = 10000000000000000000ULL;
+  const size_t DEC_BLOCK_DIGITS = 19;
+
+  // Values up to this many blocks are converted by repeated division
+  std::atomic<size_t> decBasecaseCutoff(BIGINT_DEC_BASECASE_CUTOFF);
+
+  // Number of conversions using the table of powers of ten; retired
+  // tables are only freed when there are none
+  std::atomic<size_t> decReaders(0);
+
+  // Marks a conversion as a reader of the table for its whole duration
+  struct DecReadGuard
+  {
+    DecReadGuard() { decReaders.fetch_add(1); }
+    ~DecReadGuard() { decReaders.fetch_sub(1); }
+  };
+}
+
+/* DECIMAL CONVERSION CUTOFF */
+void set_dec_basecase_cutoff(size_t blocks)
+{
+  decBasecaseCutoff.store(blocks, std::memory_order_relaxed);
+}
+
+size_t get_dec_basecase_cutoff()
+{
+  return decBasecaseCutoff.load(std::memory_order_relaxed);
+}
+
+/* TO DECIMAL */
+std::string BigInt::to_dec() const
+{
+  BIGINT_STAT_OP(TO_DEC, magnitude.size());
+  // Edge Case
+  if (is_zero_mag(magnitude))
+  {
+    return "0";
+  }
+
+  DecReadGuard reader;
+  size_t top;
+  const DecPowers &powers = dec_powers(magnitude, top);
+
+  // Write every digit into its final place, then drop the leading
+  // zeros (keeping one slot in front for the sign)
+  size_t digits = (size_t)DEC_BLOCK_DIGITS << top;
+  std::string result(digits + 1, '0');
+  dec_digits(magnitude, powers, top, &result[1]);
+  size_t first = result.find_first_not_of('0', 1);
+  if (isNeg)
+  {
+    result[first - 1] = '-';
+    --first;
+  }
+  result.erase(0, first);
+  return result;
+}
+
+// One cached power 10^(19 * 2^k). Its division constants are only
+// computed once it is divided by, since the largest cached power
+// usually just bounds the number of digits.
+struct BigInt::DecPower
+{
+  BigInt value;
+  mutable std::once_flag once;
+  mutable std::unique_ptr<const Divisor> divisor;
+
+  const Divisor &get_divisor() const
+  {
+    std::call_once(once, [this]
+                   {
+                     LimbResourceScope scope(limb_pool_resource());
+                     divisor.reset(new Divisor(value)); });
+    return *divisor;
+  }
+};
+
+// Process-wide table of powers, extended whenever a larger value comes
+// along. A table is never changed once published, so readers need no
+// lock: a writer extends a copy under the lock and swaps the pointer.
+// Superseded tables stay valid for readers that loaded them, until
+// clear_decimal_cache() finds no conversion running.
+struct BigInt::DecCache
+{
+  std::atomic<const DecPowers *> current{nullptr};
+  std::mutex lock;
+  std::vector<const DecPowers *> retired; // under lock
+  std::vector<const DecPower *> powers;   // every power made, under lock
+};
+
+/* DECIMAL CACHE - HELPER */
+BigInt::DecCache &BigInt::dec_cache()
+{
+  // Never destroyed, since conversions may still run at exit
+  static DecCache *cache = new DecCache;
+  return *cache;
+}
+
+/* DECIMAL POWERS - HELPER */
+const BigInt::DecPowers &BigInt::dec_powers(const LimbVector &mag, size_t &top)
+{
+  // The caller must hold a DecReadGuard while it uses the table
+  DecCache &cache = dec_cache();
+  const DecPowers *table = cache.current.load();
+  if (!table || compare_mag(table->back()->value.magnitude, mag) <= 0)
+  {
+    std::lock_guard<std::mutex> guard(cache.lock);
+    table = cache.current.load();
+    if (!table || compare_mag(table->back()->value.magnitude, mag) <= 0)
+    {
+      // The powers outlive any arena the caller may have set up
+      LimbResourceScope scope(limb_pool_resource());
+      DecPowers *grown = new DecPowers();
+      if (table)
+      {
+        *grown = *table; // shares the powers themselves
+        cache.retired.push_back(table);
+      }
+      else
+      {
+        DecPower *first = new DecPower;
+        first->value = BigInt(DEC_BLOCK_POWER);
+        grown->push_back(first);
+        cache.powers.push_back(first);
+      }
+      while (compare_mag(grown->back()->value.magnitude, mag) <= 0)
+      {
+        DecPower *next = new DecPower;
+        sqr_mag(grown->back()->value.magnitude, next->value.magnitude);
+        grown->push_back(next);
+        cache.powers.push_back(next);
+      }
+      cache.current.store(grown);
+      table = grown;
+    }
+  }
+
+  // The value has at most 19 * 2^top digits, for the first power above it
+  top = 0;
+  while (compare_mag((*table)[top]->value.magnitude, mag) <= 0)
+  {
+    ++top;
+  }
+  return *table;
+}
+
+/* CLEAR DECIMAL CACHE */
+void clear_decimal_cache()
+{
+  // Unpublish the table first: a conversion that starts after the
+  // reader count is read below can then only see a table built later.
+  // Both sides use sequentially consistent operations for this.
+  BigInt::DecCache &cache = BigInt::dec_cache();
+  std::lock_guard<std::mutex> guard(cache.lock);
+  const BigInt::DecPowers *table = cache.current.exchange(nullptr);
+  if (table)
+  {
+    cache.retired.push_back(table);
+  }
+  if (decReaders.load() != 0)
+  {
+    return; // freed by a later call
+  }
+  for (const BigInt::DecPowers *retired : cache.retired)
+  {
+    delete retired;
+  }
+  for (const BigInt::DecPower *power : cache.powers)
+  {
+    delete power;
+  }
+  cache.retired.clear();
+  cache.powers.clear();
+}
+
+/* TO DECIMAL - HELPER */
+void BigInt::dec_digits(const LimbVector &mag, const DecPowers &powers, size_t level, char *out)
+{
+  // Writes exactly 19 * 2^level digits, where mag < powers[level]
+  size_t digits = (size_t)DEC_BLOCK_DIGITS << level;
+  size_t used = used_blocks(mag);
+  if (used == 0)
+  {
+    std::fill(out, out + digits, '0');
+    return;
+  }
+
+  // Small values: peel off 19 digits at a time from the right
+  if (level == 0 || used <= decBasecaseCutoff)
+  {
+    LimbVector rest(mag.begin(), mag.begin() + used);
+    for (size_t end = digits; end > 0; end -= DEC_BLOCK_DIGITS)
+    {
+      uint64_t chunk = div_1(rest, DEC_BLOCK_POWER);
+      for (size_t i = end; i > end - DEC_BLOCK_DIGITS; --i)
+      {
+        out[i - 1] = (char)('0' + chunk % 10);
+        chunk /= 10;
+      }
+    }
+    return;
+  }
+
+  // Split on 10^(19 * 2^(level - 1)); the quotient fills the first half
+  // of the digits and the remainder the second half
+  LimbVector quot, rem;
+  powers[level - 1]->get_divisor().divmod_mag(mag, quot, rem);
+  size_t half = digits / 2;
+  if (used >= get_parallel_convert_cutoff() && get_parallel_threads() > 1)
+  {
+    TaskGroup group;
+    group.run([&]
+              { dec_digits(quot, powers, level - 1, out); });
+    dec_digits(rem, powers, level - 1, out + half);
+    group.wait();
+  }
+  else
+  {
+    dec_digits(quot, powers, level - 1, out);
+    dec_digits(rem, powers, level - 1, out + half);
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+//////////////////////* STREAM OUTPUT *//////////////////////////////
+//////////////////////////////////////////////////////////////////
+
+// Buffers digits and passes them to a sink one block at a time.
+// Leading zeros are dropped; if no digit is left, "0" is written.
+class BigInt::DigitStream
+{
+private:
+  const DigitSink &sink;
+  std::vector<char> buffer;
+  size_t used;
+  bool started;
+
+public:
+  DigitStream(const DigitSink &s, size_t blockSize)
+      : sink(s), buffer(std::max(blockSize, (size_t)1)), used(0), started(false)
+  {
+    // No code needed
+  }
+
+  void put(char c)
+  {
+    if (!started)
+    {
+      if (c == '0')
+      {
+        return;
+      }
+      started = true;
+    }
+    buffer[used++] = c;
+    if (used == buffer.size())
+    {
+      flush();
+    }
+  }
+
+  void put_zeros(size_t count)
+  {
+    for (size_t i = 0; started && i < count; ++i)
+    {
+      put('0');
+    }
+  }
+
+  void finish()
+  {
+    if (!started)
+    {
+      started = true;
+      buffer[used++] = '0';
+    }
+    flush();
+  }
+
+  void flush()
+  {
+    if (used > 0)
+    {
+      sink(buffer.data(), used);
+      used = 0;
+    }
+  }
+};
+
+/* WRITE DECIMAL */
+void BigInt::write_dec(const DigitSink &sink, size_t blockSize) const
+{
+  BIGINT_STAT_OP(TO_DEC, magnitude.size());
+  DigitStream out(sink, blockSize);
+  if (isNeg && !is_zero_mag(magnitude))
+  {
+    sink("-", 1);
+  }
+  write_digits(out, 10, false);
+  out.finish();
+}
+
+/* WRITE HEXADECIMAL */
+void BigInt::write_hex(const DigitSink &sink, size_t blockSize, bool uppercase) const
+{
+  BIGINT_STAT_OP(TO_HEX, magnitude.size());
+  DigitStream out(sink, blockSize);
+  if (isNeg && !is_zero_mag(magnitude))
+  {
+    sink("-", 1);
+  }
+  write_digits(out, 16, uppercase);
+  out.finish();
+}
+
+/* WRITE DIGITS - HELPER */
+void BigInt::write_digits(DigitStream &out, unsigned base, bool uppercase) const
+{
+  const char *digitChars = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+  size_t used = used_blocks(magnitude);
+  if (used == 0)
+  {
+    return;
+  }
+
+  if (base == 10)
+  {
+    DecReadGuard reader;
+    size_t top;
+    const DecPowers &powers = dec_powers(magnitude, top);
+    dec_stream(magnitude, powers, top, out);
+    return;
+  }
+
+  // Power-of-two bases: take digits straight from the bits, starting
+  // from a digit boundary above the top bit
+  unsigned bits = base == 16 ? 4 : 3;
+  size_t top = (64 * used + bits - 1) / bits * bits;
+  for (size_t pos = top; pos > 0; pos -= bits)
+  {
+    size_t lo = pos - bits;
+    uint64_t digit = magnitude[lo / 64] >> (lo % 64);
+    if (lo % 64 + bits > 64 && lo / 64 + 1 < used)
+    {
+      digit |= magnitude[lo / 64 + 1] << (64 - lo % 64);
+    }
+    out.put(digitChars[digit & (base - 1)]);
+  }
+}
+
+/* DECIMAL STREAM - HELPER */
+void BigInt::dec_stream(const LimbVector &mag, const DecPowers &powers, size_t level,
+                        DigitStream &out)
+{
+  // Emits exactly 19 * 2^level digits, where mag < powers[level]
+  size_t digits = (size_t)DEC_BLOCK_DIGITS << level;
+  size_t used = used_blocks(mag);
+  if (used == 0)
+  {
+    out.put_zeros(digits);
+    return;
+  }
+
+  // Small values: split into 19-digit chunks, emitted after the zeros
+  // that pad them to the full width
+  if (level == 0 || used <= decBasecaseCutoff)
+  {
+    LimbVector rest(mag.begin(), mag.begin() + used);
+    vector<uint64_t> chunks;
+    while (!is_zero_mag(rest))
+    {
+      chunks.push_back(div_1(rest, DEC_BLOCK_POWER));
+    }
+    out.put_zeros(digits - DEC_BLOCK_DIGITS * chunks.size());
+    for (size_t c = chunks.size(); c-- > 0;)
+    {
+      char text[DEC_BLOCK_DIGITS];
+      uint64_t chunk = chunks[c];
+      for (size_t i = DEC_BLOCK_DIGITS; i-- > 0;)
+      {
+        text[i] = (char)('0' + chunk % 10);
+        chunk /= 10;
+      }
+      for (char ch : text)
+      {
+        out.put(ch);
+      }
+    }
+    return;
+  }
+
+  // The quotient's digits come first
+  LimbVector quot, rem;
+  powers[level - 1]->get_divisor().divmod_mag(mag, quot, rem);
+  dec_stream(quot, powers, level - 1, out);
+  quot = LimbVector();
+  dec_stream(rem, powers, level - 1, out);
+}
+
+/* STREAM OUTPUT */
+std::ostream &operator<<(std::ostream &os, const BigInt &value)
+{
+  std::ostream::sentry guard(os);
+  if (!guard)
+  {
+    return os;
+  }
+
+  std::ios_base::fmtflags flags = os.flags();
+  unsigned base = 10;
+  if ((flags & std::ios_base::basefield) == std::ios_base::hex)
+  {
+    base = 16;
+  }
+  else if ((flags & std::ios_base::basefield) == std::ios_base::oct)
+  {
+    base = 8;
+  }
+  bool uppercase = (flags & std::ios_base::uppercase) != 0;
+  size_t used = BigInt::used_blocks(value.magnitude);
+
+  // Sign and base prefix (none for zero, like built-in integers)
+  std::string prefix;
+  if (value.isNeg && used > 0)
+  {
+    prefix = "-";
+  }
+  else if ((flags & std::ios_base::showpos) && base == 10)
+  {
+    prefix = "+";
+  }
+  if ((flags & std::ios_base::showbase) && used > 0 && base != 10)
+  {
+    prefix += base == 16 ? (uppercase ? "0X" : "0x") : "0";
+  }
+
+  // A lower bound on the digit count decides whether padding is needed
+  size_t bits = used == 0 ? 1 : 64 * used - __builtin_clzll(value.magnitude[used - 1]);
+  size_t minDigits = base == 10 ? (bits - 1) * 30102 / 100000 + 1 : (bits + (base == 16 ? 3 : 2)) / (base == 16 ? 4 : 3);
+  size_t width = os.width() > 0 ? (size_t)os.width() : 0;
+  os.width(0);
+
+  BigInt::DigitSink toStream = [&](const char *chars, size_t length)
+  {
+    os.write(chars, length);
+  };
+  if (prefix.size() + minDigits >= width)
+  {
+    os.write(prefix.data(), prefix.size());
+    BigInt::DigitStream out(toStream, 1 << 16);
+    value.write_digits(out, base, uppercase);
+    out.finish();
+    return os;
+  }
+
+  // Padding needed: the number is shorter than the field, so build it
+  std::string digits;
+  BigInt::DigitSink toString = [&](const char *chars, size_t length)
+  {
+    digits.append(chars, length);
+  };
+  BigInt::DigitStream out(toString, 1 << 16);
+  value.write_digits(out, base, uppercase);
+  out.finish();
+
+  size_t length = prefix.size() + digits.size();
+  std::string padding(length < width ? width - length : 0, os.fill());
+  std::ios_base::fmtflags adjust = flags & std::ios_base::adjustfield;
+  std::string text;
+  if (adjust == std::ios_base::left)
+  {
+    text = prefix + digits + padding;
+  }
+  else if (adjust == std::ios_base::internal)
+  {
+    text = prefix + padding + digits;
+  }
+  else
+  {
+    text = padding + prefix + digits;
+  }
+  os.write(text.data(), text.size());
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////
+//////////////////////* NUMBER THEORY *///////////////////////////
+//////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /* BINARY GCD OF TWO BLOCKS - HELPER */
+  uint64_t gcd_u64(uint64_t a, uint64_t b)
+  {
+    if (a == 0)
+    {
+      return b;
+    }
+    if (b == 0)
+    {
+      return a;
+    }
+
+    // Factor out common powers of two, then subtract odd values
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0)
+    {
+      b >>= __builtin_ctzll(b);
+      if (a > b)
+      {
+        std::swap(a, b);
+      }
+      b -= a;
+    }
+    return a << shift;
+  }
+
+  /* LEADING 63 BITS - HELPER */
+  int64_t leading_bits(const LimbVector &mag, size_t start)
+  {
+    // Returns bits [start, start + 63) of mag
+    size_t index = start / 64;
+    unsigned offset = start % 64;
+    uint64_t lo = index < mag.size() ? mag[index] : 0;
+    uint64_t hi = index + 1 < mag.size() ? mag[index + 1] : 0;
+    uint64_t bits = offset ? (lo >> offset) | (hi << (64 - offset)) : lo;
+    return (int64_t)(bits & 0x7FFFFFFFFFFFFFFFUL);
+  }
+
+  /* LEHMER COFACTORS - HELPER */
+  void lehmer_cofactors(int64_t x, int64_t y, int64_t &a, int64_t &b, int64_t &c, int64_t &d)
+  {
+    // Simulate Euclid's algorithm on the leading bits of the two values,
+    // stopping as soon as the quotient is no longer certain
+    // (Knuth, TAOCP vol. 2, algorithm L)
+    __int128 xx = x, yy = y;
+    __int128 A = 1, B = 0, C = 0, D = 1;
+    while (yy + C != 0 && yy + D != 0)
+    {
+      __int128 q = (xx + A) / (yy + C);
+      if (q != (xx + B) / (yy + D))
+      {
+        break;
+      }
+      __int128 t = A - q * C;
+      A = C;
+      C = t;
+      t = B - q * D;
+      B = D;
+      D = t;
+      t = xx - q * yy;
+      xx = yy;
+      yy = t;
+    }
+    a = (int64_t)A;
+    b = (int64_t)B;
+    c = (int64_t)C;
+    d = (int64_t)D;
+  }
+
+  // Values from this many blocks up are reduced with the half-GCD by
+  // gcd(), and from a quarter of it by xgcd(): Lehmer's algorithm
+  // updates the cofactors with full multiplications, so the half-GCD
+  // pays off sooner there (measured crossovers: about 1024 and 256)
+  std::atomic<size_t> hgcdCutoff(BIGINT_HGCD_CUTOFF);
+
+  // Unimodular matrix taking (u, v) to (a * u + b * v, c * u + d * v)
+  struct GcdMatrix
+  {
+    BigInt a, b, c, d;
+
+    GcdMatrix() : a(1), b(0), c(0), d(1) {}
+  };
+
+  /* SIGNED BLOCK - HELPER */
+  BigInt from_int64(int64_t value)
+  {
+    return BigInt(value < 0 ? -(uint64_t)value : (uint64_t)value, value < 0);
+  }
+
+  /* GCD MATRIX PRODUCT - HELPER */
+  // m = step * m, so that m also applies step after its own steps
+  void compose(const GcdMatrix &step, GcdMatrix &m)
+  {
+    BigInt a = step.a * m.a + step.b * m.c;
+    BigInt b = step.a * m.b + step.b * m.d;
+    BigInt c = step.c * m.a + step.d * m.c;
+    BigInt d = step.c * m.b + step.d * m.d;
+    m.a = a;
+    m.b = b;
+    m.c = c;
+    m.d = d;
+  }
+
+  /* GCD STEP - HELPER */
+  // One Lehmer step on u >= v > 0, or a Euclidean step where Lehmer
+  // cannot determine a quotient; the step is recorded in m
+  void gcd_step(BigInt &u, BigInt &v, GcdMatrix *m)
+  {
+    GcdMatrix step;
+    size_t bits = u.bit_length();
+    int64_t A = 0, B = 0, C = 0, D = 0;
+    if (bits > 64)
+    {
+      lehmer_cofactors(leading_bits(u.get_bit_vector(), bits - 63),
+                       leading_bits(v.get_bit_vector(), bits - 63), A, B, C, D);
+    }
+    if (B == 0)
+    {
+      BigInt q = u / v;
+      BigInt r = u - q * v;
+      u = v;
+      v = r;
+      step.a = 0;
+      step.b = 1;
+      step.c = 1;
+      step.d = -q;
+    }
+    else
+    {
+      step.a = from_int64(A);
+      step.b = from_int64(B);
+      step.c = from_int64(C);
+      step.d = from_int64(D);
+      BigInt nextU = step.a * u + step.b * v;
+      v = step.c * u + step.d * v;
+      u = nextU;
+    }
+    if (m)
+    {
+      compose(step, *m);
+    }
+  }
+
+  /* HALF GCD - KERNEL */
+  // Reduce u >= v >= 0 by Euclidean steps until v has at most stop
+  // bits, recording the steps in m (if given). Each round computes the
+  // steps for the leading 2r + 64 bits recursively, where they are the
+  // same as for the whole values up to about r bits of quotients, and
+  // applies them with a few multiplications (Moller, "On Schonhage's
+  // algorithm and subquadratic integer GCD computation"). The matrices
+  // are unimodular, so the gcd is kept even if a quotient found from
+  // the leading bits turns out wrong; such a round is then replaced by
+  // a single step.
+  void half_gcd(BigInt &u, BigInt &v, size_t stop, GcdMatrix *m)
+  {
+    // Below the Karatsuba cutoff the matrices would be multiplied by
+    // schoolbook anyway, so single steps are as fast
+    size_t cutoffBits = 64 * karatsubaCutoff.load(std::memory_order_relaxed);
+    while (v.bit_length() > stop)
+    {
+      size_t n = u.bit_length();
+      size_t work = n - stop;
+      size_t r = 2 * work + 64 < n ? work : work / 2;
+      if (n < cutoffBits || 2 * r + 64 >= n)
+      {
+        gcd_step(u, v, m);
+        continue;
+      }
+
+      // Steps for the leading bits
+      unsigned k = (unsigned)(n - 2 * r - 64);
+      BigInt topU = u >> k;
+      BigInt topV = v >> k;
+      GcdMatrix sub;
+      half_gcd(topU, topV, topU.bit_length() - r, &sub);
+
+      // Apply them to the whole values, keeping u >= v >= 0
+      BigInt nextU = sub.a * u + sub.b * v;
+      BigInt nextV = sub.c * u + sub.d * v;
+      if (nextU.is_negative())
+      {
+        nextU = -nextU;
+        sub.a = -sub.a;
+        sub.b = -sub.b;
+      }
+      if (nextV.is_negative())
+      {
+        nextV = -nextV;
+        sub.c = -sub.c;
+        sub.d = -sub.d;
+      }
+      if (nextU < nextV)
+      {
+        std::swap(nextU, nextV);
+        std::swap(sub.a, sub.c);
+        std::swap(sub.b, sub.d);
+      }
+      if (nextU >= u)
+      {
+        gcd_step(u, v, m);
+        continue;
+      }
+      u = nextU;
+      v = nextV;
+      if (m)
+      {
+        compose(sub, *m);
+      }
+    }
+  }
+}
+
+/* HALF GCD CUTOFF */
+void set_hgcd_cutoff(size_t blocks)
+{
+  hgcdCutoff.store(blocks, std::memory_order_relaxed);
+}
+
+size_t get_hgcd_cutoff()
+{
+  return hgcdCutoff.load(std::memory_order_relaxed);
+}
+
+/* GCD */
+BigInt gcd(const BigInt &a, const BigInt &b)
+{
+  LimbVector u = a.magnitude;
+  LimbVector v = b.magnitude;
+  BigInt::remove_zeroes(u);
+  BigInt::remove_zeroes(v);
+  if (BigInt::compare_mag(u, v) < 0)
+  {
+    std::swap(u, v);
+  }
+
+  // Lehmer steps while the smaller value spans several blocks; large
+  // values are halved with the half-GCD first
+  while (v.size() > 1)
+  {
+    if (v.size() >= get_hgcd_cutoff())
+    {
+      BigInt bigU, bigV;
+      bigU.magnitude = std::move(u);
+      bigV.magnitude = std::move(v);
+      half_gcd(bigU, bigV, std::min(bigU.bit_length() / 2, bigV.bit_length() - 1), nullptr);
+      u = std::move(bigU.magnitude);
+      v = std::move(bigV.magnitude);
+      BigInt::remove_zeroes(u);
+      BigInt::remove_zeroes(v);
+      continue;
+    }
+    size_t start = (u.size() - 1) * 64 + (64 - __builtin_clzll(u.back())) - 63;
+    int64_t A, B, C, D;
+    lehmer_cofactors(leading_bits(u, start), leading_bits(v, start), A, B, C, D);
+
+    if (B == 0)
+    {
+      // No quotient could be determined: take a full Euclidean step
+      LimbVector quot, rem;
+      BigInt::divmod_mag(u, v, quot, rem);
+      u = v;
+      v = rem;
+    }
+    else
+    {
+      // Apply the simulated steps: u' = A*u + B*v, v' = C*u + D*v
+      LimbVector nextU = BigInt::combine_mag(u, v, A, B);
+      v = BigInt::combine_mag(u, v, C, D);
+      u = nextU;
+    }
+  }
+
+  // Finish on machine words
+  BigInt result;
+  if (BigInt::is_zero_mag(v))
+  {
+    result.magnitude = u;
+    return result;
+  }
+  uint64_t rem = BigInt::div_1(u, v[0]);
+  result.magnitude = {gcd_u64(v[0], rem)};
+  return result;
+}
+
+/* LCM */
+BigInt lcm(const BigInt &a, const BigInt &b)
+{
+  BigInt g = gcd(a, b);
+  if (g == 0)
+  {
+    return g;
+  }
+
+  BigInt result = divexact(a, g) * b;
+  return result.is_negative() ? -result : result;
+}
+
+/* EXTENDED GCD */
+BigInt xgcd(const BigInt &a, const BigInt &b, BigInt &x, BigInt &y)
+{
+  // Track s such that u == s * |a| (mod |b|) and likewise for v
+  LimbVector u = a.magnitude;
+  LimbVector v = b.magnitude;
+  BigInt::remove_zeroes(u);
+  BigInt::remove_zeroes(v);
+  BigInt s0(1), s1(0);
+
+  while (!BigInt::is_zero_mag(v))
+  {
+    if (v.size() >= get_hgcd_cutoff() / 4 && v.size() > 1 && BigInt::compare_mag(u, v) >= 0)
+    {
+      // Halve large values with the half-GCD, applying its steps to the
+      // cofactors as well
+      BigInt bigU, bigV;
+      bigU.magnitude = std::move(u);
+      bigV.magnitude = std::move(v);
+      GcdMatrix m;
+      half_gcd(bigU, bigV, std::min(bigU.bit_length() / 2, bigV.bit_length() - 1), &m);
+      u = std::move(bigU.magnitude);
+      v = std::move(bigV.magnitude);
+      BigInt::remove_zeroes(u);
+      BigInt::remove_zeroes(v);
+      BigInt next0 = m.a * s0 + m.b * s1;
+      BigInt next1 = m.c * s0 + m.d * s1;
+      s0 = next0;
+      s1 = next1;
+      continue;
+    }
+
+    int64_t A = 0, B = 0, C = 0, D = 0;
+    if (v.size() > 1 && BigInt::compare_mag(u, v) >= 0)
+    {
+      size_t start = (u.size() - 1) * 64 + (64 - __builtin_clzll(u.back())) - 63;
+      lehmer_cofactors(leading_bits(u, start), leading_bits(v, start), A, B, C, D);
+    }
+
+    if (B == 0)
+    {
+      // Full Euclidean step
+      LimbVector quot, rem;
+      BigInt::divmod_mag(u, v, quot, rem);
+      BigInt q;
+      q.magnitude = quot;
+      BigInt next = s0 - q * s1;
+      s0 = s1;
+      s1 = next;
+      u = v;
+      v = rem;
+    }
+    else
+    {
+      // Apply the simulated steps to the values and the cofactors
+      LimbVector nextU = BigInt::combine_mag(u, v, A, B);
+      v = BigInt::combine_mag(u, v, C, D);
+      u = nextU;
+      BigInt bigA((uint64_t)(A < 0 ? -A : A), A < 0), bigB((uint64_t)(B < 0 ? -B : B), B < 0);
+      BigInt bigC((uint64_t)(C < 0 ? -C : C), C < 0), bigD((uint64_t)(D < 0 ? -D : D), D < 0);
+      BigInt next0 = bigA * s0 + bigB * s1;
+      BigInt next1 = bigC * s0 + bigD * s1;
+      s0 = next0;
+      s1 = next1;
+    }
+  }
+
+  BigInt g;
+  g.magnitude = u;
+
+  // Recover the second cofactor: t = (g - s * |a|) / |b|
+  BigInt absA = a.is_negative() ? -a : a;
+  BigInt absB = b.is_negative() ? -b : b;
+  BigInt t = BigInt::is_zero_mag(absB.magnitude) ? BigInt(0) : divexact(g - s0 * absA, absB);
+  if (BigInt::is_zero_mag(u))
+  {
+    s0 = BigInt(0); // gcd(0, 0)
+  }
+
+  x = a.is_negative() ? -s0 : s0;
+  y = b.is_negative() ? -t : t;
+  return g;
+}
+
+/* MODULAR INVERSE */
+BigInt mod_inverse(const BigInt &a, const BigInt &m)
+{
+  if (m.is_negative() || m == 0)
+  {
+    throw std::invalid_argument("Modulus must be positive");
+  }
+
+  BigInt x, y;
+  BigInt g = xgcd(a % m, m, x, y);
+  if (g != 1)
+  {
+    throw std::invalid_argument("Value is not invertible");
+  }
+
+  // Bring the coefficient into [0, m)
+  x = x % m;
+  if (x.is_negative())
+  {
+    x = x + m;
+  }
+  return x;
+}
+
+/* POWER */
+BigInt pow(const BigInt &base, uint64_t exp)
+{
+  BigInt result(1);
+  if (exp == 0)
+  {
+    return result;
+  }
+  result.isNeg = base.isNeg && (exp & 1);
+
+  size_t n = BigInt::used_blocks(base.magnitude);
+  if (n == 0)
+  {
+    return BigInt(0);
+  }
+
+  // Power of two: (2^k)^exp is a single shift
+  size_t bits = (n - 1) * 64 + (64 - __builtin_clzll(base.magnitude[n - 1]));
+  size_t lowBit = 0;
+  while (base.magnitude[lowBit / 64] == 0)
+  {
+    lowBit += 64;
+  }
+  lowBit += __builtin_ctzll(base.magnitude[lowBit / 64]);
+  if (lowBit + 1 == bits)
+  {
+    size_t shift;
+    if (__builtin_mul_overflow(lowBit, exp, &shift))
+    {
+      throw std::invalid_argument("Power too large");
+    }
+    result.magnitude.assign(shift / 64 + 1, 0);
+    result.magnitude[shift / 64] = 1UL << (shift % 64);
+    return result;
+  }
+
+  // Preallocate both buffers to the final size so the loop never
+  // reallocates
+  size_t maxBits;
+  if (__builtin_mul_overflow(bits, exp, &maxBits))
+  {
+    throw std::invalid_argument("Power too large");
+  }
+  size_t maxBlocks = maxBits / 64 + 2;
+  LimbVector acc(base.magnitude.begin(), base.magnitude.begin() + n);
+  LimbVector tmp;
+  acc.reserve(maxBlocks);
+  tmp.reserve(maxBlocks);
+
+  // Left-to-right binary exponentiation
+  int topBit = 63 - __builtin_clzll(exp);
+  for (int i = topBit - 1; i >= 0; --i)
+  {
+    BigInt::sqr_mag(acc, tmp);
+    acc.swap(tmp);
+    if ((exp >> i) & 1)
+    {
+      if (n == 1)
+      {
+        // Single block bases (e.g., 10) only need a linear pass
+        uint64_t carry = 0;
+        for (size_t j = 0; j < acc.size(); ++j)
+        {
+          unsigned __int128 t = (unsigned __int128)acc[j] * base.magnitude[0] + carry;
+          acc[j] = (uint64_t)t;
+          carry = (uint64_t)(t >> 64);
+        }
+        if (carry)
+        {
+          acc.push_back(carry);
+        }
+      }
+      else
+      {
+        BigInt::mul_mag(acc, base.magnitude, tmp);
+        acc.swap(tmp);
+      }
+    }
+  }
+
+  result.magnitude.swap(acc);
+  return result;
+}
+
+/* INTEGER SQUARE ROOT */
+BigInt isqrt(const BigInt &n)
+{
+  if (n.is_negative())
+  {
+    throw std::invalid_argument("Square root of a negative value");
+  }
+  size_t bits = n.bit_length();
+  if (bits <= 64)
+  {
+    // The double estimate is within one of the root; correct it exactly
+    uint64_t v = n.get_bits(0);
+    uint64_t r = (uint64_t)std::sqrt((double)v);
+    while (r > 0 && (unsigned __int128)r * r > v)
+    {
+      --r;
+    }
+    while ((unsigned __int128)(r + 1) * (r + 1) <= v)
+    {
+      ++r;
+    }
+    return BigInt(r);
+  }
+
+  // With m = n >> 2k, n < (m + 1) * 4^k <= ((isqrt(m) + 1) * 2^k)^2, so
+  // x starts above the root with about half its bits correct; from
+  // above, Newton's iteration decreases until it reaches the root
+  unsigned k = (unsigned)(bits / 4);
+  BigInt x = (isqrt(n >> (2 * k)) + 1) << k;
+  while (true)
+  {
+    BigInt y = (x + n / x) >> 1;
+    if (y >= x)
+    {
+      return x;
+    }
+    x = y;
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+/////////////////////////* COMBINATORICS *//////////////////////////
+//////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /* PRIME SIEVE - HELPER */
+  LimbVector primes_up_to(uint64_t limit)
+  {
+    LimbVector primes;
+    if (limit < 2)
+    {
+      return primes;
+    }
+
+    // Sieve of Eratosthenes over odd numbers only (index i is 2i + 1)
+    vector<bool> composite(limit / 2 + 1, false);
+    primes.push_back(2);
+    for (uint64_t i = 1; 2 * i + 1 <= limit; ++i)
+    {
+      if (composite[i])
+      {
+        continue;
+      }
+      uint64_t p = 2 * i + 1;
+      primes.push_back(p);
+      if (p > limit / p)
+      {
+        continue;
+      }
+      for (uint64_t j = p * p / 2; j <= limit / 2; j += p)
+      {
+        composite[j] = true;
+      }
+    }
+    return primes;
+  }
+
+  /* PACK FACTOR - HELPER */
+  void pack_factor(LimbVector &packed, uint64_t &acc, uint64_t factor)
+  {
+    // Multiply small factors together until they fill a block, so the
+    // product tree starts from full-width leaves
+    uint64_t next;
+    if (__builtin_mul_overflow(acc, factor, &next))
+    {
+      packed.push_back(acc);
+      acc = factor;
+    }
+    else
+    {
+      acc = next;
+    }
+  }
+}
+
+/* PRODUCT TREE - HELPER */
+LimbVector BigInt::tree_product(const LimbVector &factors, size_t lo, size_t hi)
+{
+  // Multiply factors[lo, hi) by splitting the range in half, so that the
+  // operands of every multiplication have similar sizes
+  if (hi - lo <= 8)
+  {
+    LimbVector acc = {1};
+    for (size_t i = lo; i < hi; ++i)
+    {
+      acc = mul_1(acc, factors[i]);
+    }
+    return acc;
+  }
+
+  size_t mid = lo + (hi - lo) / 2;
+  LimbVector left = tree_product(factors, lo, mid);
+  LimbVector right = tree_product(factors, mid, hi);
+  LimbVector product;
+  mul_mag(left, right, product);
+  return product;
+}
+
+/* FACTORIAL */
+BigInt factorial(uint64_t n)
+{
+  // n! = 2^(n - popcount(n)) * (product of the odd parts of 1..n)
+  LimbVector packed;
+  uint64_t acc = 1;
+  for (uint64_t i = 3; i <= n; ++i)
+  {
+    pack_factor(packed, acc, i >> __builtin_ctzll(i));
+  }
+  packed.push_back(acc);
+
+  BigInt result;
+  result.magnitude = BigInt::tree_product(packed, 0, packed.size());
+  return result << (unsigned)(n - __builtin_popcountll(n));
+}
+
+/* BINOMIAL COEFFICIENT */
+BigInt binomial(uint64_t n, uint64_t k)
+{
+  if (k > n)
+  {
+    return BigInt(0);
+  }
+  k = std::min(k, n - k);
+
+  BigInt result;
+  LimbVector packed;
+  uint64_t acc = 1;
+  if (k < n / 64)
+  {
+    // Few factors compared to n: sieving up to n would dominate, so
+    // divide the falling factorial n (n-1) ... (n-k+1) by k!
+    for (uint64_t i = n - k + 1; i <= n; ++i)
+    {
+      pack_factor(packed, acc, i);
+    }
+    packed.push_back(acc);
+    LimbVector numerator = BigInt::tree_product(packed, 0, packed.size());
+    BigInt::divexact_mag(numerator, factorial(k).magnitude, result.magnitude);
+    return result;
+  }
+
+  // The exponent of each prime p in C(n, k) is the number of borrows when
+  // subtracting k from n in base p (Kummer), computed here with Legendre's
+  // formula
+  for (uint64_t p : primes_up_to(n))
+  {
+    unsigned exponent = 0;
+    for (uint64_t pk = p; pk <= n; pk *= p)
+    {
+      exponent += n / pk - k / pk - (n - k) / pk;
+      if (pk > n / p)
+      {
+        break;
+      }
+    }
+    for (unsigned e = 0; e < exponent; ++e)
+    {
+      pack_factor(packed, acc, p);
+    }
+  }
+  packed.push_back(acc);
+
+  result.magnitude = BigInt::tree_product(packed, 0, packed.size());
+  return result;
+}
+
+namespace
+{
+  /* FIBONACCI PAIR - HELPER */
+  void fibonacci_pair(uint64_t n, BigInt &fn, BigInt &fn1)
+  {
+    // Fast doubling: with a = F(k) and b = F(k+1),
+    //   F(2k)   = a * (2b - a)
+    //   F(2k+1) = a^2 + b^2
+    BigInt a(0), b(1);
+    for (int i = n ? 63 - __builtin_clzll(n) : -1; i >= 0; --i)
+    {
+      BigInt a2 = a * ((b << 1) - a);
+      BigInt b2 = a * a + b * b;
+      if ((n >> i) & 1)
+      {
+        a = b2;
+        b = a2 + b2;
+      }
+      else
+      {
+        a = a2;
+        b = b2;
+      }
+    }
+    fn = a;
+    fn1 = b;
+  }
+}
+
+/* FIBONACCI */
+BigInt fibonacci(uint64_t n)
+{
+  BigInt fn, fn1;
+  fibonacci_pair(n, fn, fn1);
+  return fn;
+}
+
+/* LUCAS */
+BigInt lucas(uint64_t n)
+{
+  // L(n) = 2 F(n+1) - F(n)
+  BigInt fn, fn1;
+  fibonacci_pair(n, fn, fn1);
+  return (fn1 << 1) - fn;
+}
+
+///////////////////////////////////////////////////////////////////
+/////////////////////////* PRIMALITY *//////////////////////////////
+//////////////////////////////////////////////////////////////////
+
+/* MONTGOMERY INVERSE - HELPER */
+uint64_t BigInt::mont_inverse(uint64_t low)
+{
+  // Newton iteration for low^-1 mod 2^64 (each step doubles the number
+  // of correct bits; low * low == 1 mod 8 gives the first three), negated
+  uint64_t inv = low;
+  for (int i = 0; i < 5; ++i)
+  {
+    inv *= 2 - low * inv;
+  }
+  return -inv;
+}
+
+/* MONTGOMERY MULTIPLICATION - KERNEL */
+void BigInt::mont_mul(const LimbVector &a, const LimbVector &b, const LimbVector &mod,
+                      uint64_t modInv, LimbVector &out)
+{
+  // Computes a * b / 2^(64k) mod `mod`, where k = mod.size() and a, b are
+  // reduced values padded to k blocks (coarsely integrated operand
+  // scanning). out must not alias a or b.
+  size_t k = mod.size();
+  out.assign(k + 2, 0);
+  for (size_t i = 0; i < k; ++i)
+  {
+    // out += a[i] * b
+    uint64_t carry = 0;
+    for (size_t j = 0; j < k; ++j)
+    {
+      unsigned __int128 t = (unsigned __int128)a[i] * b[j] + out[j] + carry;
+      out[j] = (uint64_t)t;
+      carry = (uint64_t)(t >> 64);
+    }
+    unsigned __int128 t = (unsigned __int128)out[k] + carry;
+    out[k] = (uint64_t)t;
+    out[k + 1] = (uint64_t)(t >> 64);
+
+    // out = (out + m * mod) / 2^64, with m chosen to clear the low block
+    uint64_t m = out[0] * modInv;
+    t = (unsigned __int128)m * mod[0] + out[0];
+    carry = (uint64_t)(t >> 64);
+    for (size_t j = 1; j < k; ++j)
+    {
+      t = (unsigned __int128)m * mod[j] + out[j] + carry;
+      out[j - 1] = (uint64_t)t;
+      carry = (uint64_t)(t >> 64);
+    }
+    t = (unsigned __int128)out[k] + carry;
+    out[k - 1] = (uint64_t)t;
+    out[k] = out[k + 1] + (uint64_t)(t >> 64);
+    out[k + 1] = 0;
+  }
+
+  // Final conditional subtraction
+  out.resize(k + 1);
+  if (out[k] != 0 || compare_mag(out, mod) >= 0)
+  {
+    uint64_t borrow = 0;
+    for (size_t j = 0; j < k; ++j)
+    {
+      unsigned __int128 d = (unsigned __int128)out[j] - mod[j] - borrow;
+      out[j] = (uint64_t)d;
+      borrow = (d >> 64) != 0;
+    }
+  }
+  out.resize(k);
+}
+
+/* TO MONTGOMERY FORM - HELPER */
+LimbVector BigInt::to_mont(const LimbVector &val, const LimbVector &mod)
+{
+  // val * 2^(64k) mod `mod`, padded to k blocks
+  LimbVector shifted(mod.size(), 0);
+  shifted.insert(shifted.end(), val.begin(), val.end());
+  LimbVector quot, rem;
+  divmod_mag(shifted, mod, quot, rem);
+  rem.resize(mod.size(), 0);
+  return rem;
+}
+
+namespace
+{
+  /* MODULAR ADDITION - HELPER */
+  void add_mod(LimbVector &a, const LimbVector &b, const LimbVector &mod)
+  {
+    // a = (a + b) mod `mod` for reduced values padded to mod.size() blocks
+    size_t k = mod.size();
+    uint64_t carry = 0;
+    for (size_t i = 0; i < k; ++i)
+    {
+      unsigned __int128 s = (unsigned __int128)a[i] + b[i] + carry;
+      a[i] = (uint64_t)s;
+      carry = (uint64_t)(s >> 64);
+    }
+    bool reduce = carry != 0;
+    for (size_t i = k; !reduce && i-- > 0;)
+    {
+      if (a[i] != mod[i])
+      {
+        reduce = a[i] > mod[i];
+        break;
+      }
+      reduce = i == 0; // equal to mod
+    }
+    if (reduce)
+    {
+      uint64_t borrow = 0;
+      for (size_t i = 0; i < k; ++i)
+      {
+        unsigned __int128 d = (unsigned __int128)a[i] - mod[i] - borrow;
+        a[i] = (uint64_t)d;
+        borrow = (d >> 64) != 0;
+      }
+    }
+  }
+
+  /* MODULAR SUBTRACTION - HELPER */
+  void sub_mod(LimbVector &a, const LimbVector &b, const LimbVector &mod)
+  {
+    // a = (a - b) mod `mod` for reduced values padded to mod.size() blocks
+    size_t k = mod.size();
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < k; ++i)
+    {
+      unsigned __int128 d = (unsigned __int128)a[i] - b[i] - borrow;
+      a[i] = (uint64_t)d;
+      borrow = (d >> 64) != 0;
+    }
+    if (borrow)
+    {
+      uint64_t carry = 0;
+      for (size_t i = 0; i < k; ++i)
+      {
+        unsigned __int128 s = (unsigned __int128)a[i] + mod[i] + carry;
+        a[i] = (uint64_t)s;
+        carry = (uint64_t)(s >> 64);
+      }
+    }
+  }
+
+  /* MODULAR HALVING - HELPER */
+  void half_mod(LimbVector &a, const LimbVector &mod)
+  {
+    // a = a / 2 mod `mod` (odd modulus): make a even by adding mod if
+    // needed, then shift right, keeping the carry out of the addition
+    size_t k = mod.size();
+    uint64_t carry = 0;
+    if (a[0] & 1)
+    {
+      for (size_t i = 0; i < k; ++i)
+      {
+        unsigned __int128 s = (unsigned __int128)a[i] + mod[i] + carry;
+        a[i] = (uint64_t)s;
+        carry = (uint64_t)(s >> 64);
+      }
+    }
+    for (size_t i = 0; i < k; ++i)
+    {
+      uint64_t high = i + 1 < k ? a[i + 1] : carry;
+      a[i] = (a[i] >> 1) | (high << 63);
+    }
+  }
+
+  /* JACOBI SYMBOL OF TWO WORDS - HELPER */
+  int jacobi_u64(uint64_t a, uint64_t n)
+  {
+    // n odd and positive
+    int result = 1;
+    a %= n;
+    while (a != 0)
+    {
+      while ((a & 1) == 0)
+      {
+        a >>= 1;
+        if ((n & 7) == 3 || (n & 7) == 5)
+        {
+          result = -result;
+        }
+      }
+      std::swap(a, n);
+      if ((a & 3) == 3 && (n & 3) == 3)
+      {
+        result = -result;
+      }
+      a %= n;
+    }
+    return n == 1 ? result : 0;
+  }
+
+  /* SMALL PRIMES - HELPER */
+  const LimbVector &small_primes()
+  {
+    // Odd primes used for trial division and candidate sieving. Built in
+    // the pool, since the first caller's resource may not outlive it.
+    static const LimbVector primes = []
+    {
+      LimbResourceScope scope(limb_pool_resource());
+      LimbVector all = primes_up_to(1 << 14);
+      return LimbVector(all.begin() + 1, all.end());
+    }();
+    return primes;
+  }
+
+  /* PRIMORIAL - HELPER */
+  const BigInt &small_primorial()
+  {
+    // Product of the odd primes below 1000; a single gcd against it
+    // replaces 167 trial divisions (built in the pool, as above)
+    static const BigInt primorial = []
+    {
+      LimbResourceScope scope(limb_pool_resource());
+      BigInt product(1);
+      for (uint64_t p : small_primes())
+      {
+        if (p >= 1000)
+        {
+          break;
+        }
+        product = product * p;
+      }
+      return product;
+    }();
+    return primorial;
+  }
+}
+
+/* MODULAR EXPONENTIATION */
+BigInt pow_mod(const BigInt &base, const BigInt &exp, const BigInt &m)
+{
+  if (m.is_negative() || BigInt::is_zero_mag(m.magnitude))
+  {
+    throw std::invalid_argument("Modulus must be positive");
+  }
+  if (exp.is_negative())
+  {
+    return pow_mod(mod_inverse(base, m), -exp, m);
+  }
+
+  // Reduce the base into [0, m)
+  BigInt b = base % m;
+  if (b.is_negative())
+  {
+    b = b + m;
+  }
+  LimbVector mod = m.magnitude;
+  BigInt::remove_zeroes(mod);
+  size_t expBits = BigInt::used_blocks(exp.magnitude) * 64;
+
+  BigInt result;
+  if ((mod[0] & 1) == 0)
+  {
+    // Even modulus: plain square-and-multiply
+    result = BigInt(1) % m;
+    for (size_t i = expBits; i-- > 0;)
+    {
+      result = (result * result) % m;
+      if (exp.is_bit_set(i))
+      {
+        result = (result * b) % m;
+      }
+    }
+    return result;
+  }
+
+  // Odd modulus: fixed 4-bit window exponentiation in Montgomery form
+  uint64_t modInv = BigInt::mont_inverse(mod[0]);
+  vector<LimbVector> table(16);
+  table[0] = BigInt::to_mont({1}, mod);
+  table[1] = BigInt::to_mont(b.magnitude, mod);
+  for (int i = 2; i < 16; ++i)
+  {
+    BigInt::mont_mul(table[i - 1], table[1], mod, modInv, table[i]);
+  }
+
+  LimbVector acc = table[0];
+  LimbVector tmp;
+  for (size_t i = (expBits + 3) / 4; i-- > 0;)
+  {
+    for (int s = 0; s < 4; ++s)
+    {
+      BigInt::mont_mul(acc, acc, mod, modInv, tmp);
+      acc.swap(tmp);
+    }
+    unsigned window = (exp.get_bits(i / 16) >> ((i % 16) * 4)) & 0xF;
+    if (window)
+    {
+      BigInt::mont_mul(acc, table[window], mod, modInv, tmp);
+      acc.swap(tmp);
+    }
+  }
+
+  // Leave Montgomery form
+  LimbVector one(mod.size(), 0);
+  one[0] = 1;
+  BigInt::mont_mul(acc, one, mod, modInv, result.magnitude);
+  BigInt::remove_zeroes(result.magnitude);
+  return result;
+}
+
+/* PROBABLE PRIME TEST */
+bool is_probable_prime(const BigInt &n)
+{
+  LimbVector mod = n.magnitude;
+  BigInt::remove_zeroes(mod);
+  if (n.is_negative() || (mod.size() == 1 && mod[0] < 2))
+  {
+    return false;
+  }
+  if ((mod[0] & 1) == 0)
+  {
+    return mod.size() == 1 && mod[0] == 2;
+  }
+
+  // Trial division by the small primes, batched into one gcd
+  if (mod.size() == 1 && mod[0] < 1000)
+  {
+    const LimbVector &primes = small_primes();
+    return std::binary_search(primes.begin(), primes.end(), mod[0]);
+  }
+  if (gcd(n, small_primorial()) != 1)
+  {
+    return false;
+  }
+
+  size_t k = mod.size();
+  uint64_t modInv = BigInt::mont_inverse(mod[0]);
+  LimbVector one = BigInt::to_mont({1}, mod);
+  LimbVector minusOne(k, 0);
+  sub_mod(minusOne, one, mod);
+  LimbVector tmp;
+
+  // Strong probable prime test to base 2 (Miller-Rabin)
+  {
+    BigInt d = n - 1;
+    unsigned s = 0;
+    while (!d.is_bit_set(s))
+    {
+      ++s;
+    }
+    LimbVector two = BigInt::to_mont({2}, mod);
+    LimbVector x = one;
+    for (size_t i = BigInt::used_blocks(d.magnitude) * 64; i-- > s;)
+    {
+      BigInt::mont_mul(x, x, mod, modInv, tmp);
+      x.swap(tmp);
+      if (d.is_bit_set(i))
+      {
+        add_mod(x, x, mod);
+      }
+    }
+    bool passed = x == one || x == minusOne;
+    for (unsigned r = 1; r < s && !passed; ++r)
+    {
+      BigInt::mont_mul(x, x, mod, modInv, tmp);
+      x.swap(tmp);
+      passed = x == minusOne;
+    }
+    if (!passed)
+    {
+      return false;
+    }
+  }
+
+  // Strong Lucas probable prime test with Selfridge's parameters:
+  // the first D in 5, -7, 9, -11, ... with Jacobi(D/n) == -1, P = 1,
+  // Q = (1 - D) / 4
+  uint64_t nMod4 = mod[0] & 3;
+  int64_t D = 5;
+  for (;; D = D > 0 ? -(D + 2) : -D + 2)
+  {
+    uint64_t absD = (uint64_t)(D < 0 ? -D : D);
+    LimbVector scratch = mod;
+    int j = jacobi_u64(BigInt::div_1(scratch, absD), absD);
+    if ((absD & 3) == 3 && nMod4 == 3)
+    {
+      j = -j; // quadratic reciprocity: (|D|/n) from (n/|D|)
+    }
+    if (D < 0 && nMod4 == 3)
+    {
+      j = -j; // Jacobi(-1/n)
+    }
+    if (j == -1)
+    {
+      break;
+    }
+    if (j == 0 && !(mod.size() == 1 && mod[0] == absD))
+    {
+      return false;
+    }
+    if (D == 13)
+    {
+      // A perfect square never yields -1; rule it out once
+      BigInt root = n;
+      BigInt next = (root + 1) / 2;
+      while (next < root)
+      {
+        root = next;
+        next = (root + n / root) / 2;
+      }
+      if (root * root == n)
+      {
+        return false;
+      }
+    }
+  }
+  int64_t Q = (1 - D) / 4;
+
+  // Multiply a Montgomery value by a small signed constant
+  auto mul_small = [&](const LimbVector &a, int64_t c)
+  {
+    LimbVector product = BigInt::mul_1(a, (uint64_t)(c < 0 ? -c : c));
+    LimbVector quot, rem;
+    BigInt::divmod_mag(product, mod, quot, rem);
+    rem.resize(k, 0);
+    if (c < 0)
+    {
+      LimbVector negated(k, 0);
+      sub_mod(negated, rem, mod);
+      return negated;
+    }
+    return rem;
+  };
+
+  // n + 1 = d * 2^s with d odd
+  BigInt d = n + 1;
+  unsigned s = 0;
+  while (!d.is_bit_set(s))
+  {
+    ++s;
+  }
+
+  // Compute U_d, V_d and Q^d, starting from U_1 = 1, V_1 = P = 1
+  LimbVector U = one, V = one;
+  LimbVector Qk = mul_small(one, Q);
+  LimbVector QmOne = Qk;
+  size_t top = BigInt::used_blocks(d.magnitude) * 64;
+  while (!d.is_bit_set(top - 1))
+  {
+    --top;
+  }
+  for (size_t i = top - 1; i-- > s;)
+  {
+    // Double: U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+    BigInt::mont_mul(U, V, mod, modInv, tmp);
+    U.swap(tmp);
+    BigInt::mont_mul(V, V, mod, modInv, tmp);
+    V.swap(tmp);
+    sub_mod(V, Qk, mod);
+    sub_mod(V, Qk, mod);
+    BigInt::mont_mul(Qk, Qk, mod, modInv, tmp);
+    Qk.swap(tmp);
+
+    if (d.is_bit_set(i))
+    {
+      // Increment: U_k+1 = (P U_k + V_k) / 2, V_k+1 = (D U_k + P V_k) / 2
+      LimbVector nextU = U;
+      add_mod(nextU, V, mod);
+      half_mod(nextU, mod);
+      LimbVector nextV = mul_small(U, D);
+      add_mod(nextV, V, mod);
+      half_mod(nextV, mod);
+      U.swap(nextU);
+      V.swap(nextV);
+      BigInt::mont_mul(Qk, QmOne, mod, modInv, tmp);
+      Qk.swap(tmp);
+    }
+  }
+
+  LimbVector zero(k, 0);
+  if (U == zero || V == zero)
+  {
+    return true;
+  }
+  for (unsigned r = 1; r < s; ++r)
+  {
+    // V_2k = V_k^2 - 2 Q^k
+    BigInt::mont_mul(V, V, mod, modInv, tmp);
+    V.swap(tmp);
+    sub_mod(V, Qk, mod);
+    sub_mod(V, Qk, mod);
+    if (V == zero)
+    {
+      return true;
+    }
+    BigInt::mont_mul(Qk, Qk, mod, modInv, tmp);
+    Qk.swap(tmp);
+  }
+  return false;
+}
+
+/* NEXT PRIME */
+BigInt next_prime(const BigInt &n)
+{
+  if (n < 2)
+  {
+    return BigInt(2);
+  }
+
+  // Start from the first odd candidate above n
+  BigInt start = n + 1;
+  if (!start.is_bit_set(0))
+  {
+    if (start == 2)
+    {
+      return start;
+    }
+    start = start + 1;
+  }
+
+  // Sieve windows of odd candidates start + 2i against the small primes,
+  // running the full test only on the survivors. Below the largest
+  // sieving prime the sieve would strike the primes themselves, so small
+  // candidates go straight to the test.
+  const size_t window = 4096;
+  const LimbVector &primes = small_primes();
+  for (;;)
+  {
+    vector<bool> composite(window, false);
+    bool sieve = start > BigInt(primes.back());
+
+    // Batch the remainder computations: reduce start once per group of
+    // primes whose product fits in a block, then reduce by each prime
+    size_t p = sieve ? 0 : primes.size();
+    while (p < primes.size())
+    {
+      uint64_t group = 1;
+      size_t end = p;
+      while (end < primes.size() && group <= UINT64_MAX / primes[end])
+      {
+        group *= primes[end++];
+      }
+      LimbVector scratch = start.magnitude;
+      uint64_t groupRem = BigInt::div_1(scratch, group);
+      for (; p < end; ++p)
+      {
+        uint64_t prime = primes[p];
+        uint64_t rem = groupRem % prime;
+
+        // Offset i with start + 2i == 0 (mod prime)
+        uint64_t first = rem == 0 ? 0 : (prime - rem) % prime;
+        if (first & 1)
+        {
+          first += prime;
+        }
+        first /= 2;
+        for (uint64_t i = first; i < window; i += prime)
+        {
+          composite[i] = true;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < window; ++i)
+    {
+      if (composite[i])
+      {
+        continue;
+      }
+      BigInt candidate = start + BigInt(2 * i);
+      if (is_probable_prime(candidate))
+      {
+        return candidate;
+      }
+    }
+    start = start + BigInt(2 * window);
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+//////////////////////* DEFERRED EXPRESSIONS *///////////////////////
+//////////////////////////////////////////////////////////////////
+
+/* ADD PRODUCT - KERNEL */
+void BigInt::addmul_mag(LimbVector &acc, const LimbVector &leftMag, const LimbVector &rightMag)
+{
+  // acc += left * right, where acc has room for the result
+  size_t n = used_blocks(leftMag);
+  size_t m = used_blocks(rightMag);
+  if (std::min(n, m) >= karatsubaCutoff)
+  {
+    LimbVector prod;
+    mul_mag(leftMag, rightMag, prod);
+    add_into(acc.data(), acc.size(), prod.data(), used_blocks(prod));
+    return;
+  }
+  for (size_t i = 0; i < n; ++i)
+  {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < m; ++j)
+    {
+      unsigned __int128 t = (unsigned __int128)leftMag[i] * rightMag[j] + acc[i + j] + carry;
+      acc[i + j] = (uint64_t)t;
+      carry = (uint64_t)(t >> 64);
+    }
+    for (size_t k = i + m; carry != 0 && k < acc.size(); ++k)
+    {
+      unsigned __int128 t = (unsigned __int128)acc[k] + carry;
+      acc[k] = (uint64_t)t;
+      carry = (uint64_t)(t >> 64);
+    }
+  }
+}
+
+/* SUBTRACT PRODUCT - KERNEL */
+bool BigInt::submul_mag(LimbVector &acc, const LimbVector &leftMag, const LimbVector &rightMag)
+{
+  // acc -= left * right modulo 2^(64 * acc.size()); returns true if the
+  // subtraction borrowed, i.e., the product was larger than acc
+  size_t n = used_blocks(leftMag);
+  size_t m = used_blocks(rightMag);
+  if (std::min(n, m) >= karatsubaCutoff)
+  {
+    LimbVector prod;
+    mul_mag(leftMag, rightMag, prod);
+    return sub_from(acc.data(), acc.size(), prod.data(), used_blocks(prod)) != 0;
+  }
+  bool borrowOut = false;
+  for (size_t i = 0; i < n; ++i)
+  {
+    uint64_t carry = 0;
+    uint64_t borrow = 0;
+    for (size_t j = 0; j < m; ++j)
+    {
+      unsigned __int128 p = (unsigned __int128)leftMag[i] * rightMag[j] + carry;
+      carry = (uint64_t)(p >> 64);
+      unsigned __int128 d = (unsigned __int128)acc[i + j] - (uint64_t)p - borrow;
+      acc[i + j] = (uint64_t)d;
+      borrow = (d >> 64) != 0;
+    }
+    uint64_t owed = carry + borrow; // cannot overflow: carry < 2^64 - 1
+    for (size_t k = i + m; owed != 0 && k < acc.size(); ++k)
+    {
+      unsigned __int128 d = (unsigned __int128)acc[k] - owed;
+      acc[k] = (uint64_t)d;
+      owed = (d >> 64) != 0;
+    }
+    borrowOut = borrowOut != (owed != 0);
+  }
+  return borrowOut;
+}
+
+/* TWO'S COMPLEMENT NEGATION - HELPER */
+void BigInt::negate_mag(LimbVector &mag)
+{
+  uint64_t carry = 1;
+  for (uint64_t &block : mag)
+  {
+    block = ~block + carry;
+    carry = carry && block == 0;
+  }
+}
+
+/* ASSIGNMENT FROM TERMS */
+void BigInt::assign_terms(const BigIntTerm *terms, size_t count)
+{
+  // Evaluate into a temporary if the destination is also an operand
+  for (size_t t = 0; t < count; ++t)
+  {
+    if (terms[t].left == this || terms[t].right == this)
+    {
+      BigInt result;
+      result.assign_terms(terms, count);
+      magnitude.swap(result.magnitude);
+      isNeg = result.isNeg;
+      return;
+    }
+  }
+
+  // Size the result: the widest operand or product, plus a carry block
+  size_t linearSize = 0;
+  size_t size = 0;
+  for (size_t t = 0; t < count; ++t)
+  {
+    const BigIntTerm &term = terms[t];
+    if (term.right)
+    {
+      size = std::max(size, used_blocks(term.left->magnitude) + used_blocks(term.right->magnitude));
+    }
+    else
+    {
+      linearSize = std::max(linearSize, used_blocks(term.left->magnitude));
+    }
+  }
+  size = std::max(size, linearSize) + 1;
+  magnitude.assign(size, 0);
+
+  // Sum every added and subtracted value in a single signed carry pass,
+  // producing a two's complement result
+  __int128 carry = 0;
+  for (size_t i = 0; i < linearSize; ++i)
+  {
+    __int128 sum = carry;
+    for (size_t t = 0; t < count; ++t)
+    {
+      const BigIntTerm &term = terms[t];
+      if (!term.right && i < term.left->magnitude.size())
+      {
+        uint64_t block = term.left->magnitude[i];
+        sum += (term.negate != term.left->isNeg) ? -(__int128)block : (__int128)block;
+      }
+    }
+    magnitude[i] = (uint64_t)sum;
+    carry = sum >> 64;
+  }
+  for (size_t i = linearSize; i < size; ++i)
+  {
+    magnitude[i] = (uint64_t)carry;
+    carry >>= 64;
+  }
+  isNeg = carry < 0;
+  if (isNeg)
+  {
+    negate_mag(magnitude);
+  }
+
+  // Multiply each product directly into the result
+  for (size_t t = 0; t < count; ++t)
+  {
+    const BigIntTerm &term = terms[t];
+    if (!term.right)
+    {
+      continue;
+    }
+    bool productNeg = term.negate != (term.left->isNeg != term.right->isNeg);
+    if (productNeg == isNeg)
+    {
+      addmul_mag(magnitude, term.left->magnitude, term.right->magnitude);
+    }
+    else if (submul_mag(magnitude, term.left->magnitude, term.right->magnitude))
+    {
+      // The product outweighed the result so far: flip the sign
+      negate_mag(magnitude);
+      isNeg = !isNeg;
+    }
+  }
+
+  remove_zeroes(magnitude);
+  if (is_zero_mag(magnitude))
+  {
+    isNeg = false;
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+//////////////////////* RANGE OPERATIONS *///////////////////////////
+//////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /* PRODUCT TREE - HELPER */
+  // Product of values[lo..hi), where prefix[i] is the number of blocks
+  // in values[0..i)
+  BigInt product_tree(const BigInt *const *values, const vector<size_t> &prefix, size_t lo, size_t hi)
+  {
+    if (hi - lo == 1)
+    {
+      return *values[lo];
+    }
+
+    // Split where the halves hold about the same number of blocks
+    size_t half = prefix[lo] + (prefix[hi] - prefix[lo]) / 2;
+    size_t mid = std::upper_bound(prefix.begin() + lo + 1, prefix.begin() + hi, half) - prefix.begin();
+    mid = std::min(std::max(mid, lo + 1), hi - 1);
+
+    BigInt left, right;
+    if (prefix[hi] - prefix[lo] >= get_parallel_multiply_cutoff() && get_parallel_threads() > 1)
+    {
+      TaskGroup group;
+      group.run([&]
+                { left = product_tree(values, prefix, lo, mid); });
+      right = product_tree(values, prefix, mid, hi);
+      group.wait();
+    }
+    else
+    {
+      left = product_tree(values, prefix, lo, mid);
+      right = product_tree(values, prefix, mid, hi);
+    }
+    return left * right;
+  }
+}
+
+/* PRODUCT OF VALUES */
+BigInt product_of(const BigInt *const *values, size_t count)
+{
+  if (count == 0)
+  {
+    return BigInt(1UL);
+  }
+  vector<size_t> prefix(count + 1, 0);
+  for (size_t i = 0; i < count; ++i)
+  {
+    prefix[i + 1] = prefix[i] + values[i]->get_bit_vector().size();
+  }
+  return product_tree(values, prefix, 0, count);
+}
+
+/* SUM OF VALUES */
+BigInt sum_of(const BigInt *const *values, size_t count)
+{
+  // Every accumulator gets room for the widest value plus the carries
+  // of up to 2^64 terms
+  size_t total = 0;
+  size_t size = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    size_t used = BigInt::used_blocks(values[i]->magnitude);
+    total += used;
+    size = std::max(size, used);
+  }
+  size += 2;
+
+  // Positive and negative terms are added into separate accumulators
+  // (one pair per chunk), so no term needs a sign check per block
+  size_t chunks = 1;
+  if (total >= get_parallel_sum_cutoff() && get_parallel_threads() > 1)
+  {
+    chunks = std::min((size_t)get_parallel_threads(), count);
+  }
+  vector<LimbVector> pos(chunks, LimbVector(size, 0));
+  vector<LimbVector> neg(chunks, LimbVector(size, 0));
+  auto sum_chunk = [&](size_t c)
+  {
+    for (size_t i = c * count / chunks; i < (c + 1) * count / chunks; ++i)
+    {
+      const LimbVector &mag = values[i]->magnitude;
+      LimbVector &acc = values[i]->isNeg ? neg[c] : pos[c];
+      add_into(acc.data(), size, mag.data(), BigInt::used_blocks(mag));
+    }
+  };
+
+  if (chunks > 1)
+  {
+    TaskGroup group;
+    for (size_t c = 1; c < chunks; ++c)
+    {
+      group.run([&, c]
+                { sum_chunk(c); });
+    }
+    sum_chunk(0);
+    group.wait();
+    for (size_t c = 1; c < chunks; ++c)
+    {
+      add_into(pos[0].data(), size, pos[c].data(), size);
+      add_into(neg[0].data(), size, neg[c].data(), size);
+    }
+  }
+  else
+  {
+    sum_chunk(0);
+  }
+
+  BigInt result;
+  result.isNeg = BigInt::compare_mag(pos[0], neg[0]) < 0;
+  if (result.isNeg)
+  {
+    pos[0].swap(neg[0]);
+  }
+  sub_from(pos[0].data(), size, neg[0].data(), size);
+  BigInt::remove_zeroes(pos[0]);
+  result.magnitude.swap(pos[0]);
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////
+//////////////////////* SERIALIZATION *//////////////////////////////
+//////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /* STORE LITTLE-ENDIAN - HELPER */
+  // Write limbs[0..used) as `length` little-endian bytes, truncating or
+  // padding with zeros
+  void store_le(const uint64_t *limbs, size_t used, uint8_t *out, size_t length)
+  {
+    size_t full = std::min(used * 8, length);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(out, limbs, full);
+#else
+    for (size_t k = 0; k < full; ++k)
+    {
+      out[k] = (uint8_t)(limbs[k / 8] >> (8 * (k % 8)));
+    }
+#endif
+    std::memset(out + full, 0, length - full);
+  }
+
+  /* LOAD LITTLE-ENDIAN - HELPER */
+  // Fill limbs[0..ceil(length / 8)) from `length` little-endian bytes
+  void load_le(const uint8_t *in, size_t length, uint64_t *limbs)
+  {
+    limbs[(length - 1) / 8] = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(limbs, in, length);
+#else
+    for (size_t k = 0; k < length; ++k)
+    {
+      if (k % 8 == 0)
+      {
+        limbs[k / 8] = 0;
+      }
+      limbs[k / 8] |= (uint64_t)in[k] << (8 * (k % 8));
+    }
+#endif
+  }
+
+  /* LOAD BIG-ENDIAN - HELPER */
+  // Fill limbs[0..ceil(length / 8)) from `length` big-endian bytes
+  void load_be(const uint8_t *in, size_t length, uint64_t *limbs)
+  {
+    size_t full = length / 8;
+    for (size_t i = 0; i < full; ++i)
+    {
+      const uint8_t *p = in + length - 8 * (i + 1);
+      uint64_t block = 0;
+      for (unsigned k = 0; k < 8; ++k)
+      {
+        block = (block << 8) | p[k];
+      }
+      limbs[i] = block;
+    }
+    if (length % 8 != 0)
+    {
+      uint64_t block = 0;
+      for (size_t k = 0; k < length % 8; ++k)
+      {
+        block = (block << 8) | in[k];
+      }
+      limbs[full] = block;
+    }
+  }
+}
+
+/* BYTE LENGTH */
+size_t BigInt::byte_length(bool isSigned) const
+{
+  size_t used = used_blocks(magnitude);
+  if (used == 0)
+  {
+    return 1;
+  }
+  uint64_t top = magnitude[used - 1];
+  size_t bits = 64 * used - __builtin_clzll(top);
+  if (!isSigned)
+  {
+    return (bits + 7) / 8;
+  }
+
+  // A negative power of two, -2^k, needs only k bits plus the sign
+  if (isNeg && (top & (top - 1)) == 0)
+  {
+    bool lowerZero = true;
+    for (size_t i = 0; i + 1 < used; ++i)
+    {
+      lowerZero = lowerZero && magnitude[i] == 0;
+    }
+    if (lowerZero)
+    {
+      --bits;
+    }
+  }
+  return bits / 8 + 1;
+}
+
+/* TO BYTES */
+void BigInt::to_bytes(uint8_t *out, size_t length, ByteOrder order, bool isSigned) const
+{
+  size_t used = used_blocks(magnitude);
+  if (!isSigned && isNeg && used > 0)
+  {
+    throw std::invalid_argument("Negative value needs a signed representation");
+  }
+  if (length < byte_length(isSigned))
+  {
+    throw std::invalid_argument("Buffer too small for the value");
+  }
+
+  store_le(magnitude.data(), used, out, length);
+
+  // Two's complement: invert and add one
+  if (isSigned && isNeg && used > 0)
+  {
+    unsigned carry = 1;
+    for (size_t k = 0; k < length; ++k)
+    {
+      unsigned v = (uint8_t)~out[k] + carry;
+      out[k] = (uint8_t)v;
+      carry = v >> 8;
+    }
+  }
+
+  if (order == ByteOrder::BIG)
+  {
+    std::reverse(out, out + length);
+  }
+}
+
+std::vector<uint8_t> BigInt::to_bytes(ByteOrder order, bool isSigned) const
+{
+  if (!isSigned && isNeg && !is_zero_mag(magnitude))
+  {
+    throw std::invalid_argument("Negative value needs a signed representation");
+  }
+  std::vector<uint8_t> bytes(byte_length(isSigned));
+  to_bytes(bytes.data(), bytes.size(), order, isSigned);
+  return bytes;
+}
+
+/* FROM BYTES */
+BigInt BigInt::from_bytes(const uint8_t *data, size_t length, ByteOrder order, bool isSigned)
+{
+  BigInt result;
+  if (length == 0)
+  {
+    return result;
+  }
+
+  size_t count = (length + 7) / 8;
+  result.magnitude.resize(count);
+  if (order == ByteOrder::LITTLE)
+  {
+    load_le(data, length, result.magnitude.data());
+  }
+  else
+  {
+    load_be(data, length, result.magnitude.data());
+  }
+
+  // Negative two's complement: sign-extend the top block, then negate
+  uint8_t msb = order == ByteOrder::BIG ? data[0] : data[length - 1];
+  if (isSigned && (msb & 0x80))
+  {
+    if (length % 8 != 0)
+    {
+      result.magnitude[count - 1] |= ~0ULL << (8 * (length % 8));
+    }
+    negate_mag(result.magnitude);
+    result.isNeg = true;
+  }
+  remove_zeroes(result.magnitude);
+  return result;
+}
+
+/* WRITE RECORD */
+size_t BigInt::write_record(std::vector<uint8_t> &out) const
+{
+  size_t used = used_blocks(magnitude);
+  size_t length = used == 0 ? 0 : byte_length(false);
+  uint64_t header = ((uint64_t)length << 1) | (isNeg && used > 0);
+
+  size_t start = out.size();
+  do
+  {
+    uint8_t byte = header & 0x7f;
+    header >>= 7;
+    out.push_back(header != 0 ? (byte | 0x80) : byte);
+  } while (header != 0);
+
+  size_t pos = out.size();
+  out.resize(pos + length);
+  store_le(magnitude.data(), used, out.data() + pos, length);
+  return out.size() - start;
+}
+
+/* READ RECORD */
+BigInt BigInt::read_record(const uint8_t *data, size_t length, size_t &consumed)
+{
+  uint64_t header = 0;
+  size_t pos = 0;
+  for (unsigned shift = 0;; shift += 7)
+  {
+    if (pos >= length || shift > 63)
+    {
+      throw std::invalid_argument("Truncated or malformed record header");
+    }
+    uint8_t byte = data[pos++];
+    header |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+    {
+      break;
+    }
+  }
+
+  size_t bytes = header >> 1;
+  if (bytes > length - pos)
+  {
+    throw std::invalid_argument("Truncated record");
+  }
+  BigInt result = from_bytes(data + pos, bytes, ByteOrder::LITTLE, false);
+  result.isNeg = (header & 1) && !is_zero_mag(result.magnitude);
+  consumed = pos + bytes;
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////
+////////////////////////////* HASHING *///////////////////////////
+//////////////////////////////////////////////////////////////////
+
+namespace
+{
+  // Odd constants with well-mixed bits, as in wyhash
+  const uint64_t HASH_P0 = 0xa0761d6478bd642fULL;
+  const uint64_t HASH_P1 = 0xe7037ed1a0b428dbULL;
+  const uint64_t HASH_P2 = 0x8ebc6af09c88c6e3ULL;
+  const uint64_t HASH_P3 = 0x589965cc75374cc3ULL;
+
+  /* MULTIPLY AND FOLD - HELPER */
+  inline uint64_t mum(uint64_t a, uint64_t b)
+  {
+    unsigned __int128 r = (unsigned __int128)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+  }
+
+  /* HASH STEP - HELPER */
+  // Mix one limb into a state. The product is only zero when the limb
+  // equals the state, and folding the state back in keeps it even then
+  inline uint64_t hash_step(uint64_t state, uint64_t limb)
+  {
+    return mum(state ^ limb, HASH_P1) ^ state;
+  }
+
+  /* HASH SEED - HELPER */
+  // Chosen once per process, so inputs that collide cannot be worked
+  // out in advance
+  uint64_t hash_seed()
+  {
+    static const uint64_t seed = []
+    {
+      std::random_device device;
+      uint64_t entropy = ((uint64_t)device() << 32) ^ device();
+      uint64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+      return mum(entropy ^ HASH_P2, now ^ HASH_P3) | 1;
+    }();
+    return seed;
+  }
+}
+
+/* HASH LIMBS - KERNEL */
+uint64_t BigInt::hash_limbs(const uint64_t *limbs, size_t count, bool negative)
+{
+  // Four independent lanes, so consecutive multiplications do not
+  // wait for each other
+  uint64_t seed = hash_seed();
+  uint64_t length = (count << 1) ^ negative;
+  uint64_t lane0 = seed ^ HASH_P0 ^ length;
+  uint64_t lane1 = seed ^ HASH_P1;
+  uint64_t lane2 = seed ^ HASH_P2;
+  uint64_t lane3 = seed ^ HASH_P3;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    lane0 = hash_step(lane0, limbs[i]);
+    lane1 = hash_step(lane1, limbs[i + 1]);
+    lane2 = hash_step(lane2, limbs[i + 2]);
+    lane3 = hash_step(lane3, limbs[i + 3]);
+  }
+  for (; i < count; ++i)
+  {
+    lane0 = hash_step(lane0, limbs[i]);
+  }
+  uint64_t h = hash_step(lane0, lane1);
+  h = hash_step(h, lane2);
+  h = hash_step(h, lane3);
+  return hash_step(h, length);
+}
+
+/* HASH */
+uint64_t BigInt::hash() const
+{
+  size_t n = used_blocks(magnitude);
+  return hash_limbs(magnitude.data(), n, isNeg && n > 0);
+}
@@ -2,23 +2,56 @@
 #define BIGINT_H
 
 #include <initializer_list>
+#include <functional>
+#include <iosfwd>
 #include <vector>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <cstdint>
+#include "bigint_alloc.h"
 
 //! @file
 //! Arbitrary-precision integer data type.
 
+template <class E>
+class BigIntExpr;
+struct BigIntTerm;
+class Divisor;
+
+//! True for the native integer types that BigInt operators accept
+//! directly: the built-in integer types, including `__int128` and
+//! `unsigned __int128`.
+template <class T>
+struct is_native_integer
+    : std::integral_constant<bool, std::is_integral<T>::value || std::is_same<T, __int128>::value ||
+                                       std::is_same<T, unsigned __int128>::value>
+{
+};
+
+//! Enables an overload for native integer types only.
+template <class T>
+using EnableIfNative = typename std::enable_if<is_native_integer<T>::value>::type;
+
 //! Class representing an arbitrary-precision integer represented as a bit string
 //! (implemented using a vector of `uint64_t` elements) and a boolean flag
-//! to record whether or not the value is negative.
+//! to record whether or not the value is negative. The vector allocates
+//! its (64-byte aligned) storage from the calling thread's current limb
+//! resource; see bigint_alloc.h.
 class BigInt
 {
 private:
-  std::vector<uint64_t> magnitude;
+  LimbVector magnitude;
   bool isNeg;
 
 public:
+  //! Byte order of binary representations.
+  enum class ByteOrder
+  {
+    LITTLE, //!< least significant byte first
+    BIG     //!< most significant byte first
+  };
+
   //! Default constructor.
   //! The initialized BigInt value should be equal to 0.
   BigInt();
@@ -55,6 +88,14 @@ public:
   //!            identical to
   BigInt &operator=(const BigInt &rhs);
 
+  //! Assignment from a deferred expression (see bigint_expr.h, which
+  //! must be included to use this operator). The expression is
+  //! evaluated directly into this object's existing storage.
+  //!
+  //! @param expr the expression to evaluate
+  template <class E>
+  BigInt &operator=(const BigIntExpr<E> &expr);
+
   //! Check whether value is negative.
   //!
   //! @return true if the value is negative, false otherwise
@@ -70,7 +111,7 @@ public:
   //!
   //! @return const reference to the vector containing the bit string values
   //!         (element at index has the least-significant 64 bits, etc.)
-  const std::vector<uint64_t> &get_bit_vector() const;
+  const LimbVector &get_bit_vector() const;
 
   //! Get one `uint64_t` chunk of the overall bit string.
   //! Note that this function should work correctly regardless of the
@@ -85,6 +126,12 @@ public:
   //!         containing the bit string)
   uint64_t get_bits(unsigned index) const;
 
+  //! Get the number of bits needed to represent the magnitude, i.e.,
+  //! one more than the index of the highest bit set.
+  //!
+  //! @return the bit length of the magnitude (0 for the value 0)
+  size_t bit_length() const;
+
   //! Addition operator.
   //!
   //! @param rhs the right-hand side BigInt value (the left hand value
@@ -122,6 +169,16 @@ public:
   //! @throw std::invalid_argument if this object represents a negative value
   BigInt operator<<(unsigned n) const;
 
+  //! Right shift by n bits, discarding the bits shifted out (i.e.,
+  //! dividing by `2^n` and truncating). As with left shift, it is only
+  //! allowed to use this operation on non-negative values.
+  //!
+  //! @param n number of bits to shift right by
+  //! @return BigInt value representing the result of shifting this
+  //!         value right by `n` bits
+  //! @throw std::invalid_argument if this object represents a negative value
+  BigInt operator>>(unsigned n) const;
+
   //! Multiplication operator.
   //!
   //! @param rhs the right-hand side BigInt value (the left hand value
@@ -151,6 +208,34 @@ public:
   //!        equal to 0
   BigInt operator/(const BigInt &rhs) const;
 
+  //! Remainder operator.
+  //! The remainder is the value left over after truncating division,
+  //! so that `(a / b) * b + (a % b) == a` always holds. As a consequence
+  //! the sign of a nonzero remainder matches the sign of the dividend.
+  //!
+  //! Some examples to illustrate:
+  //! - `5 % 2 = 1`
+  //! - `-5 % 2 = -1`
+  //! - `5 % -2 = 1`
+  //!
+  //! @param rhs the right-hand side BigInt value (the left hand value
+  //!            is the implicit receiver object, i.e., `*this`)
+  //! @return the remainder resulting from dividing the left hand
+  //!         BigInt by the right-hand BigInt
+  //! @throw std::invalid_argument if the right hand object is
+  //!        equal to 0
+  BigInt operator%(const BigInt &rhs) const;
+
+  //! Divide this value in place by a 64-bit divisor, truncating like
+  //! operator/. Uses a precomputed reciprocal of the divisor, so each
+  //! block costs two multiplications rather than a hardware division.
+  //!
+  //! @param divisor the divisor
+  //! @return the magnitude of the remainder (the remainder itself has
+  //!         the sign of the original value, as with operator%)
+  //! @throw std::invalid_argument if `divisor` is 0
+  uint64_t div_1(uint64_t divisor);
+
   //! Compare two BigInt values, returning
   //!   - negative if lhs < rhs
   //!   - 0 if lhs < rhs
@@ -171,6 +256,58 @@ public:
   bool operator>(const BigInt &rhs) const { return compare(rhs) > 0; }
   bool operator>=(const BigInt &rhs) const { return compare(rhs) >= 0; }
 
+  // Mixed-type arithmetic and comparison with a native integer (e.g.,
+  // `n / 10`, `low + 1`, `product * 10`). The integer is used as one or
+  // two blocks by the single-block kernels rather than being converted
+  // to a BigInt first. Results are the same as for BigInt operands.
+  template <class T, class = EnableIfNative<T>>
+  BigInt operator+(T rhs) const { return add_scalar(to_scalar(rhs)); }
+  template <class T, class = EnableIfNative<T>>
+  BigInt operator-(T rhs) const { return sub_scalar(to_scalar(rhs)); }
+  template <class T, class = EnableIfNative<T>>
+  BigInt operator*(T rhs) const { return mul_scalar(to_scalar(rhs)); }
+  template <class T, class = EnableIfNative<T>>
+  BigInt operator/(T rhs) const { return div_scalar(to_scalar(rhs)); }
+  template <class T, class = EnableIfNative<T>>
+  BigInt operator%(T rhs) const { return mod_scalar(to_scalar(rhs)); }
+  template <class T, class = EnableIfNative<T>>
+  int compare(T rhs) const { return compare_scalar(to_scalar(rhs)); }
+  template <class T, class = EnableIfNative<T>>
+  bool operator==(T rhs) const { return compare(rhs) == 0; }
+  template <class T, class = EnableIfNative<T>>
+  bool operator!=(T rhs) const { return compare(rhs) != 0; }
+  template <class T, class = EnableIfNative<T>>
+  bool operator<(T rhs) const { return compare(rhs) < 0; }
+  template <class T, class = EnableIfNative<T>>
+  bool operator<=(T rhs) const { return compare(rhs) <= 0; }
+  template <class T, class = EnableIfNative<T>>
+  bool operator>(T rhs) const { return compare(rhs) > 0; }
+  template <class T, class = EnableIfNative<T>>
+  bool operator>=(T rhs) const { return compare(rhs) >= 0; }
+
+  //! Check whether the value fits in a `uint64_t`.
+  //!
+  //! @return true if the value is in the range `[0, 2^64)`
+  bool fits_u64() const;
+
+  //! Convert to `uint64_t`.
+  //!
+  //! @return the value
+  //! @throw std::invalid_argument if the value does not fit (see fits_u64())
+  uint64_t to_u64() const;
+
+  //! Convert to `int64_t`.
+  //!
+  //! @return the value
+  //! @throw std::invalid_argument if the value is outside `[-2^63, 2^63)`
+  int64_t to_i64() const;
+
+  //! Convert to `__int128`.
+  //!
+  //! @return the value
+  //! @throw std::invalid_argument if the value is outside `[-2^127, 2^127)`
+  __int128 to_i128() const;
+
   //! Return a string representing the value of this BigInt, in
   //! lower-case hexadecimal (base-16). Note that there should be a leading
   //! minus sign (`-`) if this value is negative.
@@ -185,17 +322,538 @@ public:
   //! @return the value of this BigInt object in decimal (base-10)
   std::string to_dec() const;
 
+  //! Receiver of digits written by write_dec() and write_hex(): called
+  //! with a pointer to the next block of characters and its length.
+  typedef std::function<void(const char *, size_t)> DigitSink;
+
+  //! Write the value in decimal (as to_dec() would) to a sink, in
+  //! blocks of at most `blockSize` characters. Digits are produced by
+  //! a divide-and-conquer conversion from left to right and passed on
+  //! as each block fills, so the whole string is never materialized.
+  //!
+  //! @param sink receives the characters
+  //! @param blockSize maximum number of characters per call of `sink`
+  void write_dec(const DigitSink &sink, size_t blockSize = 1 << 16) const;
+
+  //! Write the value in hexadecimal (as to_hex() would) to a sink, in
+  //! blocks of at most `blockSize` characters.
+  //!
+  //! @param sink receives the characters
+  //! @param blockSize maximum number of characters per call of `sink`
+  //! @param uppercase if true, use the digits `A` to `F`
+  void write_hex(const DigitSink &sink, size_t blockSize = 1 << 16, bool uppercase = false) const;
+
+  //! Return the number of bytes needed to represent this value in
+  //! binary (see to_bytes()).
+  //!
+  //! @param isSigned if true, count the bytes of the two's complement
+  //!                 representation (including a sign bit); otherwise
+  //!                 count the bytes of the magnitude
+  //! @return the minimum number of bytes (at least 1)
+  size_t byte_length(bool isSigned) const;
+
+  //! Write this value in binary into a caller-provided buffer.
+  //! Values are padded to `length` bytes (with 0s, or with 1s for
+  //! negative values in two's complement).
+  //!
+  //! @param out the buffer to write to
+  //! @param length number of bytes to write
+  //! @param order byte order of the output
+  //! @param isSigned if true, write two's complement; otherwise write
+  //!                 the magnitude of a non-negative value
+  //! @throw std::invalid_argument if `length` is less than
+  //!        `byte_length(isSigned)`, or if `isSigned` is false and
+  //!        this value is negative
+  void to_bytes(uint8_t *out, size_t length, ByteOrder order, bool isSigned) const;
+
+  //! Return this value in binary, using the minimum number of bytes.
+  //!
+  //! @param order byte order of the output
+  //! @param isSigned if true, use two's complement; otherwise write
+  //!                 the magnitude of a non-negative value
+  //! @return the bytes
+  //! @throw std::invalid_argument if `isSigned` is false and this value
+  //!        is negative
+  std::vector<uint8_t> to_bytes(ByteOrder order, bool isSigned) const;
+
+  //! Create a BigInt from its binary representation.
+  //!
+  //! @param data the bytes
+  //! @param length number of bytes
+  //! @param order byte order of the input
+  //! @param isSigned if true, the bytes are in two's complement;
+  //!                 otherwise they are an unsigned magnitude
+  //! @return the value
+  static BigInt from_bytes(const uint8_t *data, size_t length, ByteOrder order, bool isSigned);
+
+  //! Append a binary record holding this value to a buffer. A record is
+  //! a header, `(n << 1) | sign` in LEB128 (7 bits per byte, low bits
+  //! first, high bit set on all but the last byte), followed by the `n`
+  //! bytes of the magnitude in little-endian order.
+  //!
+  //! @param out the buffer to append to
+  //! @return number of bytes appended
+  size_t write_record(std::vector<uint8_t> &out) const;
+
+  //! Read a binary record written by write_record().
+  //!
+  //! @param data the bytes, starting at a record
+  //! @param length number of bytes available
+  //! @param consumed set to the number of bytes of the record
+  //! @return the value
+  //! @throw std::invalid_argument if the record is truncated or malformed
+  static BigInt read_record(const uint8_t *data, size_t length, size_t &consumed);
+
+  //! Hash the value, e.g., for `std::unordered_map` (see the
+  //! `std::hash` specialization below). The significant blocks are
+  //! mixed with 64x64-to-128-bit multiplications, as in wyhash; equal
+  //! values hash equally, whatever leading zero blocks they store. The
+  //! hash is seeded randomly once per process, so it differs between
+  //! runs and must not be stored.
+  //!
+  //! @return the hash
+  uint64_t hash() const;
+
+  // number theory functions need access to the magnitude limbs
+  friend BigInt gcd(const BigInt &a, const BigInt &b);
+  friend BigInt divexact(const BigInt &a, const BigInt &b);
+  friend BigInt xgcd(const BigInt &a, const BigInt &b, BigInt &x, BigInt &y);
+  friend BigInt pow(const BigInt &base, uint64_t exp);
+  friend BigInt factorial(uint64_t n);
+  friend BigInt binomial(uint64_t n, uint64_t k);
+  friend BigInt pow_mod(const BigInt &base, const BigInt &exp, const BigInt &m);
+  friend bool is_probable_prime(const BigInt &n);
+  friend BigInt next_prime(const BigInt &n);
+  friend std::ostream &operator<<(std::ostream &os, const BigInt &value);
+  friend void clear_decimal_cache();
+  friend class BigIntBatch;
+  friend class BigIntView;
+  friend class Divisor;
+  friend BigInt sum_of(const BigInt *const *values, size_t count);
+
 private:
+  // A native integer operand: its magnitude in two blocks and its sign
+  struct Scalar
+  {
+    uint64_t blocks[2];
+    bool negative;
+  };
+
   // TODO: add helper functions
-  std::vector<uint64_t> subtract(std::vector<uint64_t> leftMag, std::vector<uint64_t> rightMag, bool &isNeg) const;
-  std::vector<uint64_t> add(std::vector<uint64_t> leftMag, std::vector<uint64_t> rightMag) const;
+  LimbVector subtract(LimbVector leftMag, LimbVector rightMag, bool &isNeg) const;
+  LimbVector add(LimbVector leftMag, LimbVector rightMag) const;
   BigInt multiply(const BigInt &left, const BigInt &right) const;
-  BigInt divide(const BigInt &left, const BigInt &right) const;
-  BigInt divideByTwo(const BigInt &val) const;
   void print_bits() const;
-  int compare_mag(const std::vector<uint64_t> lhs, const std::vector<uint64_t> rhs) const;
-  void remove_zeroes(std::vector<uint64_t> &mag);
+  static size_t used_blocks(const LimbVector &mag);
+  static void mul_mag(const LimbVector &leftMag, const LimbVector &rightMag, LimbVector &prodMag);
+  static void sqr_mag(const LimbVector &mag, LimbVector &prodMag);
+  static int compare_mag(const LimbVector &lhs, const LimbVector &rhs);
+  static void remove_zeroes(LimbVector &mag);
+  static bool is_zero_mag(const LimbVector &mag);
+  static LimbVector mul_1(const LimbVector &mag, uint64_t factor);
+  static uint64_t div_1(LimbVector &mag, uint64_t divisor);
+  static void sub_in_place(LimbVector &leftMag, const LimbVector &rightMag);
+  static LimbVector combine_mag(const LimbVector &u, const LimbVector &v, int64_t p, int64_t q);
+  static LimbVector tree_product(const LimbVector &factors, size_t lo, size_t hi);
+  static uint64_t mont_inverse(uint64_t low);
+  static void mont_mul(const LimbVector &a, const LimbVector &b, const LimbVector &mod,
+                       uint64_t modInv, LimbVector &out);
+  static LimbVector to_mont(const LimbVector &val, const LimbVector &mod);
+  static void addmul_mag(LimbVector &acc, const LimbVector &leftMag, const LimbVector &rightMag);
+  static bool submul_mag(LimbVector &acc, const LimbVector &leftMag, const LimbVector &rightMag);
+  static void negate_mag(LimbVector &mag);
+  void assign_terms(const BigIntTerm *terms, size_t count);
+  static void divexact_mag(const LimbVector &leftMag, const LimbVector &rightMag, LimbVector &quotMag);
+  static uint64_t hash_limbs(const uint64_t *limbs, size_t count, bool negative);
+  static void divmod_mag(const LimbVector &leftMag, const LimbVector &rightMag,
+                         LimbVector &quotMag, LimbVector &remMag);
+  static void add_limbs(const uint64_t *a, size_t n, const uint64_t *b, size_t m, LimbVector &sumMag);
+  static bool sub_limbs(const uint64_t *a, size_t n, const uint64_t *b, size_t m, LimbVector &diffMag);
+  static void mul_limbs(const uint64_t *a, size_t n, const uint64_t *b, size_t m, LimbVector &prodMag);
+  class DigitStream;
+  struct DecPower;
+  typedef std::vector<const DecPower *> DecPowers;
+  struct DecCache;
+  static DecCache &dec_cache();
+  static const DecPowers &dec_powers(const LimbVector &mag, size_t &top);
+  static void dec_digits(const LimbVector &mag, const DecPowers &powers, size_t level, char *out);
+  static void dec_stream(const LimbVector &mag, const DecPowers &powers, size_t level,
+                         DigitStream &out);
+  void write_digits(DigitStream &out, unsigned base, bool uppercase) const;
   BigInt adjustSign(const BigInt &result) const;
+  template <class T>
+  static Scalar to_scalar(T value);
+  static void add_signed(const LimbVector &mag, bool negative, const Scalar &rhs, BigInt &sum);
+  BigInt add_scalar(const Scalar &rhs) const;
+  BigInt sub_scalar(Scalar rhs) const;
+  BigInt mul_scalar(const Scalar &rhs) const;
+  BigInt div_scalar(const Scalar &rhs) const;
+  BigInt mod_scalar(const Scalar &rhs) const;
+  int compare_scalar(const Scalar &rhs) const;
 };
 
+/* SCALAR OPERAND - HELPER */
+template <class T>
+BigInt::Scalar BigInt::to_scalar(T value)
+{
+  // Negate in the unsigned type, which also handles the most negative value
+  typedef typename std::conditional<(sizeof(T) > 8), unsigned __int128, uint64_t>::type Unsigned;
+  bool negative = T(-1) < T(0) && value < T(0);
+  Unsigned mag = negative ? Unsigned(0) - Unsigned(value) : Unsigned(value);
+  return Scalar{{(uint64_t)mag, (uint64_t)(mag >> 32 >> 32)}, negative};
+}
+
+namespace std
+{
+  //! Hash of a BigInt (see BigInt::hash()).
+  template <>
+  struct hash<BigInt>
+  {
+    size_t operator()(const BigInt &value) const { return value.hash(); }
+  };
+}
+
+// Native integer on the left-hand side
+template <class T, class = EnableIfNative<T>>
+BigInt operator+(T lhs, const BigInt &rhs) { return rhs + lhs; }
+template <class T, class = EnableIfNative<T>>
+BigInt operator-(T lhs, const BigInt &rhs) { return -(rhs - lhs); }
+template <class T, class = EnableIfNative<T>>
+BigInt operator*(T lhs, const BigInt &rhs) { return rhs * lhs; }
+template <class T, class = EnableIfNative<T>>
+bool operator==(T lhs, const BigInt &rhs) { return rhs.compare(lhs) == 0; }
+template <class T, class = EnableIfNative<T>>
+bool operator!=(T lhs, const BigInt &rhs) { return rhs.compare(lhs) != 0; }
+template <class T, class = EnableIfNative<T>>
+bool operator<(T lhs, const BigInt &rhs) { return rhs.compare(lhs) > 0; }
+template <class T, class = EnableIfNative<T>>
+bool operator<=(T lhs, const BigInt &rhs) { return rhs.compare(lhs) >= 0; }
+template <class T, class = EnableIfNative<T>>
+bool operator>(T lhs, const BigInt &rhs) { return rhs.compare(lhs) < 0; }
+template <class T, class = EnableIfNative<T>>
+bool operator>=(T lhs, const BigInt &rhs) { return rhs.compare(lhs) <= 0; }
+
+//! Divide a value by one of its divisors, e.g., a product by one of its
+//! factors or a value by its gcd with another. Uses Hensel (2-adic)
+//! division from the least significant block up, which needs no
+//! quotient estimates or corrections, and divide and conquer with
+//! Karatsuba products for large quotients.
+//!
+//! @param a the dividend
+//! @param b the divisor; it must divide `a` exactly, otherwise the
+//!          result is unspecified
+//! @return `a / b`
+//! @throw std::invalid_argument if `b` is 0
+BigInt divexact(const BigInt &a, const BigInt &b);
+
+//! Compute the greatest common divisor of two BigInt values.
+//! Small operands are handled with a binary GCD on machine words;
+//! larger ones use Lehmer's algorithm, which simulates several
+//! Euclidean steps on the leading 63 bits and then applies them to
+//! the full values with a single linear combination. Very large
+//! operands (see set_hgcd_cutoff()) are first reduced by a recursive
+//! half-GCD, whose subquadratic cost comes from BigInt multiplication.
+//!
+//! @param a the first value
+//! @param b the second value
+//! @return the (non-negative) greatest common divisor of `a` and `b`;
+//!         `gcd(0, 0)` is 0
+BigInt gcd(const BigInt &a, const BigInt &b);
+
+//! Compute the least common multiple of two BigInt values.
+//!
+//! @param a the first value
+//! @param b the second value
+//! @return the (non-negative) least common multiple of `a` and `b`;
+//!         0 if either value is 0
+BigInt lcm(const BigInt &a, const BigInt &b);
+
+//! Extended GCD: compute the greatest common divisor of `a` and `b`
+//! along with Bezout coefficients `x` and `y` such that
+//! `a * x + b * y == gcd(a, b)`.
+//!
+//! @param a the first value
+//! @param b the second value
+//! @param x set to the coefficient of `a`
+//! @param y set to the coefficient of `b`
+//! @return the (non-negative) greatest common divisor of `a` and `b`
+BigInt xgcd(const BigInt &a, const BigInt &b, BigInt &x, BigInt &y);
+
+//! Compute the inverse of `a` modulo `m`, i.e., the value `x` in the
+//! range `[0, m)` such that `(a * x) % m == 1 % m`.
+//!
+//! @param a the value to invert (may be negative)
+//! @param m the modulus
+//! @return the modular inverse of `a`
+//! @throw std::invalid_argument if `m` is not positive, or if `a`
+//!        and `m` are not coprime
+BigInt mod_inverse(const BigInt &a, const BigInt &m);
+
+//! Raise a BigInt value to a non-negative integer power using
+//! left-to-right binary exponentiation. Powers of two are computed
+//! with a single shift.
+//!
+//! @param base the value to raise to a power
+//! @param exp the exponent
+//! @return `base` raised to the power `exp` (`pow(x, 0)` is 1 for
+//!         every `x`, including 0)
+//! @throw std::invalid_argument if the result would have 2^64 bits or
+//!        more
+BigInt pow(const BigInt &base, uint64_t exp);
+
+//! Compute the integer square root, the largest value whose square
+//! does not exceed `n`. The root of the upper half of `n` gives a
+//! starting value with half the bits right, so Newton's iteration
+//! needs only a couple of full-size divisions at each level.
+//!
+//! @param n the value (must be non-negative)
+//! @return `floor(sqrt(n))`
+//! @throw std::invalid_argument if `n` is negative
+BigInt isqrt(const BigInt &n);
+
+//! Compute `n!`. The odd parts of `1..n` are packed into full blocks and
+//! multiplied with a balanced product tree; the factors of two are
+//! applied with a single shift at the end.
+//!
+//! @param n the argument
+//! @return `n!`
+BigInt factorial(uint64_t n);
+
+//! Compute the binomial coefficient `C(n, k)`, the number of ways to
+//! choose `k` items out of `n`. The coefficient is assembled from its
+//! prime factorization with a balanced product tree.
+//!
+//! @param n the number of items
+//! @param k the number of items chosen
+//! @return `C(n, k)`, or 0 if `k > n`
+BigInt binomial(uint64_t n, uint64_t k);
+
+//! Compute the `n`-th Fibonacci number (`F(0) = 0`, `F(1) = 1`)
+//! using fast doubling.
+//!
+//! @param n the index
+//! @return `F(n)`
+BigInt fibonacci(uint64_t n);
+
+//! Compute the `n`-th Lucas number (`L(0) = 2`, `L(1) = 1`)
+//! using fast doubling.
+//!
+//! @param n the index
+//! @return `L(n)`
+BigInt lucas(uint64_t n);
+
+//! Compute `base` raised to the power `exp`, modulo `m`. Odd moduli use
+//! Montgomery multiplication with a 4-bit exponent window.
+//!
+//! @param base the base (may be negative)
+//! @param exp the exponent; if negative, the inverse of `base` is raised
+//!            to `-exp`
+//! @param m the modulus
+//! @return the result, in the range `[0, m)`
+//! @throw std::invalid_argument if `m` is not positive, or if `exp` is
+//!        negative and `base` is not invertible modulo `m`
+BigInt pow_mod(const BigInt &base, const BigInt &exp, const BigInt &m);
+
+//! Baillie-PSW probable prime test: trial division by small primes
+//! (batched into one gcd against their product), a strong probable prime
+//! test to base 2 and a strong Lucas probable prime test. No composite
+//! number is known to pass this combination.
+//!
+//! @param n the value to test
+//! @return true if `n` is (probably) prime; false if `n` is composite,
+//!         negative, 0 or 1
+bool is_probable_prime(const BigInt &n);
+
+//! Find the smallest probable prime strictly greater than `n`.
+//! Candidates are sieved in windows by the small primes, so only a
+//! fraction of them reach the full test.
+//!
+//! @param n the starting value
+//! @return the next probable prime after `n` (2 if `n` is less than 2)
+BigInt next_prime(const BigInt &n);
+
+//! Write a BigInt to an output stream. The stream's format flags are
+//! respected: `hex`, `oct` or `dec` select the base, `showbase` adds
+//! the `0x` or `0` prefix, `uppercase`, `showpos`, and the field width,
+//! fill character and adjustment (`left`, `right`, `internal`) apply as
+//! they do for built-in integers. Digits are streamed in blocks as they
+//! are produced (see BigInt::write_dec()).
+//!
+//! @param os the output stream
+//! @param value the value to write
+//! @return the output stream
+std::ostream &operator<<(std::ostream &os, const BigInt &value);
+
+//! Divide by a 64-bit divisor (see BigInt::div_1()).
+//!
+//! @param n the dividend
+//! @param divisor the divisor
+//! @return the quotient `n / divisor` and the magnitude of the
+//!         remainder `n % divisor`
+//! @throw std::invalid_argument if `divisor` is 0
+std::pair<BigInt, uint64_t> divmod_u64(const BigInt &n, uint64_t divisor);
+
+//! Divisor with its division constants precomputed, for dividing many
+//! values by the same one. The normalization shift, the normalized
+//! divisor and the reciprocal of its top block (which replaces the
+//! hardware division in each quotient estimate) are computed once.
+//! Large divisors also get a Barrett reciprocal `2^(128n) / d` (for n
+//! blocks), which turns each n blocks of quotient into two Karatsuba
+//! multiplications. Results are the same as those of operator/ and
+//! operator%.
+class Divisor
+{
+private:
+  BigInt value;
+  LimbVector norm;       // magnitude shifted so that its top bit is set
+  LimbVector reciprocal; // floor(2^(128n) / norm), for large divisors only
+  unsigned shift;
+  uint64_t inverse; // reciprocal of the top block of norm
+
+public:
+  //! Constructor.
+  //!
+  //! @param divisor the value to divide by
+  //! @throw std::invalid_argument if `divisor` is 0
+  explicit Divisor(const BigInt &divisor);
+
+  //! Get the divisor.
+  //!
+  //! @return the value divided by
+  const BigInt &get_value() const;
+
+  //! Divide a value by the divisor.
+  //!
+  //! @param dividend the value to divide
+  //! @return the truncated quotient, as `dividend / get_value()`
+  BigInt divide(const BigInt &dividend) const;
+
+  //! Compute the remainder of a value divided by the divisor.
+  //!
+  //! @param dividend the value to divide
+  //! @return the remainder, as `dividend % get_value()`
+  BigInt mod(const BigInt &dividend) const;
+
+  //! Compute both the quotient and the remainder.
+  //!
+  //! @param dividend the value to divide
+  //! @param quotient receives `dividend / get_value()`
+  //! @param remainder receives `dividend % get_value()`
+  void divmod(const BigInt &dividend, BigInt &quotient, BigInt &remainder) const;
+
+private:
+  friend class BigInt;
+  void divmod_mag(const LimbVector &dividend, LimbVector &quotMag, LimbVector &remMag) const;
+  void barrett(LimbVector &u, LimbVector &quotMag, LimbVector &remMag) const;
+  static LimbVector reciprocal_of(const LimbVector &norm);
+};
+
+//! Set the operand size, in 64-bit blocks, from which multiplication
+//! splits its operands with Karatsuba instead of using the schoolbook
+//! method. The default is measured by `bigint_tune` when a generated
+//! bigint_tuning.h is present, and 32 otherwise.
+//!
+//! @param blocks the cutoff (values below 4 count as 4)
+void set_karatsuba_cutoff(size_t blocks);
+
+//! Get the Karatsuba multiplication cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_karatsuba_cutoff();
+
+//! Set the operand size, in 64-bit blocks, from which squaring uses
+//! Karatsuba (see set_karatsuba_cutoff()).
+//!
+//! @param blocks the cutoff (values below 4 count as 4)
+void set_sqr_karatsuba_cutoff(size_t blocks);
+
+//! Get the Karatsuba squaring cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_sqr_karatsuba_cutoff();
+
+//! Set the value size, in 64-bit blocks, up to which decimal conversion
+//! divides by 10^19 repeatedly; larger values are split by powers of
+//! ten first. Tuned like set_karatsuba_cutoff(); 16 by default.
+//!
+//! @param blocks the cutoff
+void set_dec_basecase_cutoff(size_t blocks);
+
+//! Get the decimal conversion base case cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_dec_basecase_cutoff();
+
+//! Set the value size, in 64-bit blocks, from which gcd() halves the
+//! values with the subquadratic half-GCD before continuing with
+//! Lehmer's algorithm; xgcd() does so from a quarter of this size.
+//! Tuned like set_karatsuba_cutoff(); 1024 by default.
+//!
+//! @param blocks the cutoff
+void set_hgcd_cutoff(size_t blocks);
+
+//! Get the half-GCD cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_hgcd_cutoff();
+
+//! Free the powers of ten cached by decimal conversion of large values.
+//! The cache only grows otherwise, to fit the largest value converted so
+//! far, and keeps the tables it has outgrown. Safe to call while other
+//! threads convert; if any conversion is running, the memory is only
+//! freed by a later call made when none is. Later conversions rebuild
+//! what they need.
+void clear_decimal_cache();
+
+//! Compute the product of an array of values with a balanced product
+//! tree: the array is split where the operand sizes balance, so both
+//! sides of every multiplication are about the same size. With the
+//! thread pool enabled, independent subtrees are multiplied in parallel.
+//!
+//! @param values pointers to the factors
+//! @param count number of factors
+//! @return the product (1 if `count` is 0)
+BigInt product_of(const BigInt *const *values, size_t count);
+
+//! Compute the sum of an array of values in one pass over each value,
+//! with positive and negative values accumulated separately. With the
+//! thread pool enabled, the array is summed in per-thread chunks.
+//!
+//! @param values pointers to the terms
+//! @param count number of terms
+//! @return the sum (0 if `count` is 0)
+BigInt sum_of(const BigInt *const *values, size_t count);
+
+//! Compute the product of a range of BigInt values (see product_of()).
+//!
+//! @param first iterator to the first factor
+//! @param last iterator past the last factor
+//! @return the product (1 if the range is empty)
+template <class It>
+BigInt product(It first, It last)
+{
+  std::vector<const BigInt *> values;
+  for (; first != last; ++first)
+  {
+    values.push_back(&*first);
+  }
+  return product_of(values.data(), values.size());
+}
+
+//! Compute the sum of a range of BigInt values (see sum_of()).
+//!
+//! @param first iterator to the first term
+//! @param last iterator past the last term
+//! @return the sum (0 if the range is empty)
+template <class It>
+BigInt sum(It first, It last)
+{
+  std::vector<const BigInt *> values;
+  for (; first != last; ++first)
+  {
+    values.push_back(&*first);
+  }
+  return sum_of(values.data(), values.size());
+}
+
 #endif // BIGINT_H
@@ -0,0 +1,210 @@
+#include "bigint_alloc.h"
+#include <algorithm>
+#include <new>
+
+namespace
+{
+  // Size classes are powers of two from 64 bytes (8 limbs) to 64 KiB;
+  // larger buffers bypass the pool
+  const unsigned NUM_CLASSES = 11;
+  const size_t MAX_CACHED_PER_CLASS = 64;
+
+  /* SIZE CLASS - HELPER */
+  unsigned size_class(size_t bytes)
+  {
+    unsigned cls = 0;
+    while (((size_t)LIMB_ALIGNMENT << cls) < bytes)
+    {
+      ++cls;
+    }
+    return cls;
+  }
+
+  /* ALIGNED ALLOCATION - HELPER */
+  void *aligned_new(size_t bytes, size_t alignment)
+  {
+    return ::operator new(bytes, std::align_val_t(std::max(alignment, LIMB_ALIGNMENT)));
+  }
+
+  /* ALIGNED DEALLOCATION - HELPER */
+  void aligned_delete(void *p, size_t alignment)
+  {
+    ::operator delete(p, std::align_val_t(std::max(alignment, LIMB_ALIGNMENT)));
+  }
+
+  // Per-thread free lists. A freed block stores the pointer to the next
+  // free block in its first bytes.
+  struct LimbCache
+  {
+    void *head[NUM_CLASSES] = {};
+    size_t count[NUM_CLASSES] = {};
+
+    ~LimbCache();
+  };
+
+  // Set once the calling thread's cache has been destroyed (e.g., for
+  // static BigInt objects released at exit), after which blocks go
+  // straight back to the system. Trivially destructible on purpose.
+  thread_local bool cacheDestroyed = false;
+  thread_local LimbCache cache;
+
+  LimbCache::~LimbCache()
+  {
+    for (unsigned cls = 0; cls < NUM_CLASSES; ++cls)
+    {
+      while (head[cls])
+      {
+        void *next = *static_cast<void **>(head[cls]);
+        aligned_delete(head[cls], LIMB_ALIGNMENT);
+        head[cls] = next;
+      }
+    }
+    cacheDestroyed = true;
+  }
+
+  // Current resource of the calling thread (null means the pool)
+  thread_local std::pmr::memory_resource *currentResource = nullptr;
+
+  class LimbPool : public std::pmr::memory_resource
+  {
+  private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+      unsigned cls = size_class(bytes);
+      if (cls >= NUM_CLASSES || alignment > LIMB_ALIGNMENT)
+      {
+        return aligned_new(bytes, alignment);
+      }
+      if (!cacheDestroyed && cache.head[cls])
+      {
+        void *block = cache.head[cls];
+        cache.head[cls] = *static_cast<void **>(block);
+        --cache.count[cls];
+        return block;
+      }
+      return aligned_new(LIMB_ALIGNMENT << cls, LIMB_ALIGNMENT);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+      unsigned cls = size_class(bytes);
+      if (cls >= NUM_CLASSES || alignment > LIMB_ALIGNMENT)
+      {
+        aligned_delete(p, alignment);
+        return;
+      }
+      if (cacheDestroyed || cache.count[cls] >= MAX_CACHED_PER_CLASS)
+      {
+        aligned_delete(p, LIMB_ALIGNMENT);
+        return;
+      }
+      *static_cast<void **>(p) = cache.head[cls];
+      cache.head[cls] = p;
+      ++cache.count[cls];
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+      return this == &other;
+    }
+  };
+}
+
+/* POOL RESOURCE */
+std::pmr::memory_resource *limb_pool_resource()
+{
+  // Never destroyed, so buffers can be released during static destruction
+  static LimbPool *pool = new LimbPool;
+  return pool;
+}
+
+/* CURRENT RESOURCE */
+std::pmr::memory_resource *current_limb_resource()
+{
+  return currentResource ? currentResource : limb_pool_resource();
+}
+
+/* RESOURCE SCOPE */
+LimbResourceScope::LimbResourceScope(std::pmr::memory_resource *resource)
+    : previous(currentResource)
+{
+  currentResource = resource;
+}
+
+LimbResourceScope::~LimbResourceScope()
+{
+  currentResource = previous;
+}
+
+/* ARENA */
+LimbArena::LimbArena(size_t initialBytes)
+    : used(0), allocated(0)
+{
+  size_t size = std::max(initialBytes, (size_t)LIMB_ALIGNMENT);
+  chunks.push_back({static_cast<char *>(aligned_new(size, LIMB_ALIGNMENT)), size, LIMB_ALIGNMENT});
+}
+
+LimbArena::~LimbArena()
+{
+  for (const Chunk &chunk : chunks)
+  {
+    aligned_delete(chunk.data, chunk.alignment);
+  }
+}
+
+/* ARENA RESET */
+void LimbArena::reset()
+{
+  // Keep the largest chunk
+  auto largest = std::max_element(chunks.begin(), chunks.end(),
+                                  [](const Chunk &a, const Chunk &b)
+                                  { return a.size < b.size; });
+  Chunk keep = *largest;
+  for (const Chunk &chunk : chunks)
+  {
+    if (chunk.data != keep.data)
+    {
+      aligned_delete(chunk.data, chunk.alignment);
+    }
+  }
+  chunks.assign(1, keep);
+  used = 0;
+  allocated = 0;
+}
+
+/* ARENA BYTES ALLOCATED */
+size_t LimbArena::bytes_allocated() const
+{
+  return allocated;
+}
+
+/* ARENA ALLOCATION */
+void *LimbArena::do_allocate(size_t bytes, size_t alignment)
+{
+  // Align the address itself: a chunk is only aligned to the alignment
+  // it was allocated with, which may be less than what is asked for
+  alignment = std::max(alignment, LIMB_ALIGNMENT);
+  uintptr_t base = reinterpret_cast<uintptr_t>(chunks.back().data);
+  size_t offset = ((base + used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+  if (offset + bytes > chunks.back().size)
+  {
+    // Start a new chunk, growing geometrically
+    size_t size = std::max(chunks.back().size * 2, bytes);
+    chunks.push_back({static_cast<char *>(aligned_new(size, alignment)), size, alignment});
+    offset = 0;
+  }
+  used = offset + bytes;
+  allocated += bytes;
+  return chunks.back().data + offset;
+}
+
+/* ARENA DEALLOCATION */
+void LimbArena::do_deallocate(void *, size_t, size_t)
+{
+  // Memory is reclaimed by reset()
+}
+
+bool LimbArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+  return this == &other;
+}
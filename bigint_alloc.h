@@ -0,0 +1,153 @@
+#ifndef BIGINT_ALLOC_H
+#define BIGINT_ALLOC_H
+
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "bigint_stats.h"
+
+//! @file
+//! Memory management for BigInt limb buffers: an allocator that draws
+//! from a pluggable `std::pmr::memory_resource`, a thread-local
+//! size-class pool (the default) and a bump arena.
+
+//! Alignment of every limb buffer, in bytes (one cache line, and
+//! enough for 512-bit vector loads).
+const size_t LIMB_ALIGNMENT = 64;
+
+//! Return the process-wide limb pool resource. Freed buffers are
+//! cached per thread in power-of-two size classes, so allocation
+//! and deallocation do not contend on a global lock. Buffers may be
+//! freed on a different thread than the one that allocated them.
+//!
+//! @return pointer to the pool resource
+std::pmr::memory_resource *limb_pool_resource();
+
+//! Return the resource new limb buffers are allocated from on the
+//! calling thread: the innermost active LimbResourceScope, or the
+//! limb pool if there is none.
+//!
+//! @return pointer to the current resource
+std::pmr::memory_resource *current_limb_resource();
+
+//! RAII guard that makes a memory resource the current limb resource
+//! of the calling thread for its lifetime. Scopes nest.
+class LimbResourceScope
+{
+private:
+  std::pmr::memory_resource *previous;
+
+public:
+  //! Constructor.
+  //!
+  //! @param resource the resource to allocate limb buffers from
+  explicit LimbResourceScope(std::pmr::memory_resource *resource);
+
+  //! Destructor. Restores the previously current resource.
+  ~LimbResourceScope();
+
+  LimbResourceScope(const LimbResourceScope &) = delete;
+  LimbResourceScope &operator=(const LimbResourceScope &) = delete;
+};
+
+//! Bump-pointer arena for short-lived limb buffers, e.g., the
+//! temporaries of one request. Allocation is a pointer increment and
+//! deallocation is a no-op; `reset()` releases everything at once.
+//! BigInt values allocated from an arena must not be used after the
+//! arena is reset or destroyed.
+class LimbArena : public std::pmr::memory_resource
+{
+private:
+  struct Chunk
+  {
+    char *data;
+    size_t size;
+    size_t alignment;
+  };
+  std::vector<Chunk> chunks;
+  size_t used;      // bytes used in the last chunk
+  size_t allocated; // bytes handed out since the last reset
+
+public:
+  //! Constructor.
+  //!
+  //! @param initialBytes size of the first chunk
+  explicit LimbArena(size_t initialBytes = 1 << 16);
+
+  //! Destructor. Releases all chunks.
+  ~LimbArena();
+
+  LimbArena(const LimbArena &) = delete;
+  LimbArena &operator=(const LimbArena &) = delete;
+
+  //! Invalidate every buffer handed out so far. The largest chunk is
+  //! kept for reuse; the others are released.
+  void reset();
+
+  //! Get the number of bytes handed out since the last reset.
+  //!
+  //! @return number of bytes allocated from this arena
+  size_t bytes_allocated() const;
+
+private:
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+};
+
+//! Standard allocator that forwards to a `std::pmr::memory_resource`.
+//! A default-constructed allocator uses the calling thread's current
+//! limb resource; copies of a container get the current resource of
+//! the copying thread, while moves and swaps carry the resource along.
+template <class T>
+class LimbAllocator
+{
+private:
+  std::pmr::memory_resource *resource;
+
+public:
+  typedef T value_type;
+  typedef std::false_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+  typedef std::false_type is_always_equal;
+
+  LimbAllocator() : resource(current_limb_resource()) {}
+  LimbAllocator(std::pmr::memory_resource *r) : resource(r) {}
+  template <class U>
+  LimbAllocator(const LimbAllocator<U> &other) : resource(other.get_resource()) {}
+
+  T *allocate(size_t n)
+  {
+    BIGINT_STAT_ALLOC(n * sizeof(T));
+    return static_cast<T *>(resource->allocate(n * sizeof(T), LIMB_ALIGNMENT));
+  }
+
+  void deallocate(T *p, size_t n)
+  {
+    resource->deallocate(p, n * sizeof(T), LIMB_ALIGNMENT);
+  }
+
+  LimbAllocator select_on_container_copy_construction() const { return LimbAllocator(); }
+
+  std::pmr::memory_resource *get_resource() const { return resource; }
+};
+
+template <class T, class U>
+bool operator==(const LimbAllocator<T> &lhs, const LimbAllocator<U> &rhs)
+{
+  return lhs.get_resource() == rhs.get_resource() || lhs.get_resource()->is_equal(*rhs.get_resource());
+}
+
+template <class T, class U>
+bool operator!=(const LimbAllocator<T> &lhs, const LimbAllocator<U> &rhs)
+{
+  return !(lhs == rhs);
+}
+
+//! Vector type holding the limbs of a BigInt.
+typedef std::vector<uint64_t, LimbAllocator<uint64_t>> LimbVector;
+
+#endif // BIGINT_ALLOC_H
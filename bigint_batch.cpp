@@ -0,0 +1,397 @@
+#include "bigint_batch.h"
+#include <algorithm>
+#include <stdexcept>
+
+// All kernels walk the blocks of the values in the outer loop and the
+// values themselves in the inner loop. The inner loops are branch-free,
+// with per-value carries kept in arrays, so the compiler can run them
+// on several values per vector instruction.
+
+namespace
+{
+  const uint64_t TEN_19 = 10000000000000000000ULL; // largest power of 10 in a block
+
+  // Reciprocal of 10^19 (whose top bit is set) for Moller-Granlund
+  // division: floor((2^128 - 1) / 10^19) - 2^64
+  const uint64_t TEN_19_RECIPROCAL = (uint64_t)((((unsigned __int128)~TEN_19 << 64) | ~0ULL) / TEN_19);
+
+  /* NEGATE SELECTED VALUES - HELPER */
+  // Two's complement negation of the values whose mask is all ones;
+  // values whose mask is 0 are left unchanged
+  void negate_where(uint64_t *limbs, size_t count, unsigned width, const uint64_t *mask)
+  {
+    std::vector<uint64_t> carry(count);
+    for (size_t v = 0; v < count; ++v)
+    {
+      carry[v] = mask[v] & 1;
+    }
+    for (unsigned j = 0; j < width; ++j)
+    {
+      uint64_t *row = limbs + j * count;
+      for (size_t v = 0; v < count; ++v)
+      {
+        uint64_t x = (row[v] ^ mask[v]) + carry[v];
+        carry[v] = x < carry[v];
+        row[v] = x;
+      }
+    }
+  }
+
+  /* APPEND BLOCK DIGITS - HELPER */
+  // Append `digits` digits of `block` in the given base, most significant
+  // first; with `digits` 0, append only the significant digits
+  void append_digits(std::string &out, uint64_t block, unsigned base, unsigned digits)
+  {
+    char buf[64];
+    unsigned n = 0;
+    do
+    {
+      buf[n++] = "0123456789abcdef"[block % base];
+      block /= base;
+    } while (block != 0 || n < digits);
+    while (n > 0)
+    {
+      out.push_back(buf[--n]);
+    }
+  }
+}
+
+/* CONSTRUCTOR */
+BigIntBatch::BigIntBatch(size_t count, unsigned width)
+    : count(count), width(width)
+{
+  if (width == 0)
+  {
+    throw std::invalid_argument("Batch width must be at least one block");
+  }
+  limbs.assign(count * width, 0);
+}
+
+/* SIZE */
+size_t BigIntBatch::size() const
+{
+  return count;
+}
+
+/* WIDTH */
+unsigned BigIntBatch::get_width() const
+{
+  return width;
+}
+
+/* STORE VALUE */
+void BigIntBatch::set(size_t index, const BigInt &value)
+{
+  const LimbVector &mag = value.magnitude;
+  size_t used = BigInt::used_blocks(mag);
+  bool negative = value.isNeg && used > 0;
+
+  // Two's complement range: [-2^(64 * width - 1), 2^(64 * width - 1))
+  bool fits = used < width;
+  if (used == width)
+  {
+    uint64_t top = mag[width - 1];
+    fits = top < (1ULL << 63);
+    if (negative && top == (1ULL << 63))
+    {
+      fits = true;
+      for (unsigned j = 0; j + 1 < width; ++j)
+      {
+        fits = fits && mag[j] == 0;
+      }
+    }
+  }
+  if (!fits)
+  {
+    throw std::invalid_argument("Value does not fit in the batch width");
+  }
+
+  uint64_t borrow = negative ? 1 : 0;
+  uint64_t mask = negative ? ~0ULL : 0;
+  for (unsigned j = 0; j < width; ++j)
+  {
+    uint64_t block = (j < used ? mag[j] : 0) ^ mask;
+    block += borrow;
+    borrow = block < borrow;
+    limbs[j * count + index] = block;
+  }
+}
+
+/* READ VALUE */
+BigInt BigIntBatch::get(size_t index) const
+{
+  BigInt result;
+  result.magnitude.resize(width);
+  bool negative = limbs[(width - 1) * count + index] >> 63;
+  uint64_t carry = negative ? 1 : 0;
+  uint64_t mask = negative ? ~0ULL : 0;
+  for (unsigned j = 0; j < width; ++j)
+  {
+    uint64_t block = (limbs[j * count + index] ^ mask) + carry;
+    carry = block < carry;
+    result.magnitude[j] = block;
+  }
+  BigInt::remove_zeroes(result.magnitude);
+  result.isNeg = negative;
+  return result;
+}
+
+/* BLOCK ROW */
+const uint64_t *BigIntBatch::block_row(unsigned block) const
+{
+  return limbs.data() + block * count;
+}
+
+/* SHAPE CHECK - HELPER */
+void BigIntBatch::check_same_shape(const BigIntBatch &rhs) const
+{
+  if (count != rhs.count || width != rhs.width)
+  {
+    throw std::invalid_argument("Batches must have the same size and width");
+  }
+}
+
+/* ADDITION */
+BigIntBatch BigIntBatch::operator+(const BigIntBatch &rhs) const
+{
+  check_same_shape(rhs);
+  BigIntBatch result(count, width);
+  std::vector<uint64_t> carry(count, 0);
+  for (unsigned j = 0; j < width; ++j)
+  {
+    const uint64_t *a = block_row(j);
+    const uint64_t *b = rhs.block_row(j);
+    uint64_t *out = result.limbs.data() + j * count;
+    for (size_t v = 0; v < count; ++v)
+    {
+      uint64_t s = a[v] + b[v];
+      uint64_t t = s + carry[v];
+      carry[v] = (s < a[v]) | (t < s);
+      out[v] = t;
+    }
+  }
+  return result;
+}
+
+/* SUBTRACTION */
+BigIntBatch BigIntBatch::operator-(const BigIntBatch &rhs) const
+{
+  check_same_shape(rhs);
+  BigIntBatch result(count, width);
+  std::vector<uint64_t> borrow(count, 0);
+  for (unsigned j = 0; j < width; ++j)
+  {
+    const uint64_t *a = block_row(j);
+    const uint64_t *b = rhs.block_row(j);
+    uint64_t *out = result.limbs.data() + j * count;
+    for (size_t v = 0; v < count; ++v)
+    {
+      uint64_t d = a[v] - b[v];
+      uint64_t t = d - borrow[v];
+      borrow[v] = (a[v] < b[v]) | (d < borrow[v]);
+      out[v] = t;
+    }
+  }
+  return result;
+}
+
+/* MAGNITUDES - HELPER */
+// Absolute values of every value, in the same layout, plus an all-ones
+// mask for each negative value
+LimbVector BigIntBatch::magnitudes(std::vector<uint64_t> &negative) const
+{
+  LimbVector mag(limbs);
+  const uint64_t *top = block_row(width - 1);
+  negative.resize(count);
+  for (size_t v = 0; v < count; ++v)
+  {
+    negative[v] = 0 - (top[v] >> 63);
+  }
+  negate_where(mag.data(), count, width, negative.data());
+  return mag;
+}
+
+/* MULTIPLICATION */
+BigIntBatch BigIntBatch::operator*(const BigIntBatch &rhs) const
+{
+  if (count != rhs.count)
+  {
+    throw std::invalid_argument("Batches must have the same size");
+  }
+
+  // Multiply the magnitudes, then negate the products whose operands
+  // have different signs. The product of two magnitudes of at most
+  // 2^(64 * w - 1) fits the signed range of the combined width.
+  std::vector<uint64_t> leftNeg, rightNeg;
+  LimbVector a = magnitudes(leftNeg);
+  LimbVector b = rhs.magnitudes(rightNeg);
+  unsigned outWidth = width + rhs.width;
+  BigIntBatch result(count, outWidth);
+  uint64_t *out = result.limbs.data();
+
+  std::vector<uint64_t> carry(count);
+  for (unsigned i = 0; i < width; ++i)
+  {
+    const uint64_t *ai = a.data() + i * count;
+    std::fill(carry.begin(), carry.end(), 0);
+    for (unsigned j = 0; j < rhs.width; ++j)
+    {
+      const uint64_t *bj = b.data() + j * count;
+      uint64_t *row = out + (i + j) * count;
+      for (size_t v = 0; v < count; ++v)
+      {
+        unsigned __int128 t = (unsigned __int128)ai[v] * bj[v] + row[v] + carry[v];
+        row[v] = (uint64_t)t;
+        carry[v] = (uint64_t)(t >> 64);
+      }
+    }
+    uint64_t *row = out + (i + rhs.width) * count;
+    for (size_t v = 0; v < count; ++v)
+    {
+      row[v] = carry[v];
+    }
+  }
+
+  for (size_t v = 0; v < count; ++v)
+  {
+    leftNeg[v] ^= rightNeg[v];
+  }
+  negate_where(out, count, outWidth, leftNeg.data());
+  return result;
+}
+
+/* COMPARE */
+std::vector<int> BigIntBatch::compare(const BigIntBatch &rhs) const
+{
+  check_same_shape(rhs);
+  std::vector<int> result(count);
+
+  // The top block holds the sign, so it is compared as signed
+  const uint64_t *a = block_row(width - 1);
+  const uint64_t *b = rhs.block_row(width - 1);
+  for (size_t v = 0; v < count; ++v)
+  {
+    int64_t x = (int64_t)a[v];
+    int64_t y = (int64_t)b[v];
+    result[v] = (x > y) - (x < y);
+  }
+
+  // Lower blocks only decide values that are still tied
+  for (unsigned j = width - 1; j-- > 0;)
+  {
+    a = block_row(j);
+    b = rhs.block_row(j);
+    for (size_t v = 0; v < count; ++v)
+    {
+      int c = (a[v] > b[v]) - (a[v] < b[v]);
+      result[v] = result[v] != 0 ? result[v] : c;
+    }
+  }
+  return result;
+}
+
+/* CONVERT TO HEX */
+std::vector<std::string> BigIntBatch::to_hex() const
+{
+  std::vector<uint64_t> negative;
+  LimbVector mag = magnitudes(negative);
+  std::vector<std::string> result(count);
+
+  for (size_t v = 0; v < count; ++v)
+  {
+    std::string &s = result[v];
+    s.reserve(width * 16 + 1);
+    if (negative[v])
+    {
+      s.push_back('-');
+    }
+
+    // First non-zero block is not padded, the rest are
+    bool found = false;
+    for (unsigned j = width; j-- > 0;)
+    {
+      uint64_t block = mag[j * count + v];
+      if (found)
+      {
+        append_digits(s, block, 16, 16);
+      }
+      else if (block != 0 || j == 0)
+      {
+        append_digits(s, block, 16, 0);
+        found = true;
+      }
+    }
+  }
+  return result;
+}
+
+/* CONVERT TO DECIMAL */
+std::vector<std::string> BigIntBatch::to_dec() const
+{
+  std::vector<uint64_t> negative;
+  LimbVector mag = magnitudes(negative);
+
+  // Peel off 19 decimal digits per round from every value at once; a
+  // round removes at least 63 bits
+  unsigned rounds = (64 * width + 62) / 63;
+  std::vector<uint64_t> chunks(rounds * count);
+  std::vector<uint64_t> rem(count);
+  for (unsigned r = 0; r < rounds; ++r)
+  {
+    std::fill(rem.begin(), rem.end(), 0);
+    for (unsigned j = width; j-- > 0;)
+    {
+      uint64_t *row = mag.data() + j * count;
+      for (size_t v = 0; v < count; ++v)
+      {
+        // Divide (rem, row) by 10^19 with the reciprocal; the two
+        // corrections are masked instead of branched on
+        uint64_t hi = rem[v];
+        uint64_t lo = row[v];
+        unsigned __int128 q = (unsigned __int128)TEN_19_RECIPROCAL * hi + (((unsigned __int128)hi << 64) | lo);
+        uint64_t q1 = (uint64_t)(q >> 64) + 1;
+        uint64_t r = lo - q1 * TEN_19;
+        uint64_t mask = 0 - (uint64_t)(r > (uint64_t)q);
+        q1 += mask;
+        r += mask & TEN_19;
+        mask = 0 - (uint64_t)(r >= TEN_19);
+        q1 -= mask;
+        r -= mask & TEN_19;
+        row[v] = q1;
+        rem[v] = r;
+      }
+    }
+    for (size_t v = 0; v < count; ++v)
+    {
+      chunks[r * count + v] = rem[v];
+    }
+  }
+
+  std::vector<std::string> result(count);
+  for (size_t v = 0; v < count; ++v)
+  {
+    std::string &s = result[v];
+    s.reserve(rounds * 19 + 1);
+    if (negative[v])
+    {
+      s.push_back('-');
+    }
+
+    // First non-zero chunk is not padded, the rest are
+    bool found = false;
+    for (unsigned r = rounds; r-- > 0;)
+    {
+      uint64_t chunk = chunks[r * count + v];
+      if (found)
+      {
+        append_digits(s, chunk, 10, 19);
+      }
+      else if (chunk != 0 || r == 0)
+      {
+        append_digits(s, chunk, 10, 0);
+        found = true;
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,111 @@
+#ifndef BIGINT_BATCH_H
+#define BIGINT_BATCH_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "bigint.h"
+
+//! @file
+//! Batches of fixed-width integers in structure-of-arrays layout.
+
+//! Class representing a batch of signed integers that all have the same
+//! width (a small number of 64-bit blocks), stored in two's complement
+//! in structure-of-arrays order: block `j` of every value is contiguous.
+//! Batch operations process one block of all values per step, so the
+//! inner loops run across values and vectorize, instead of walking the
+//! blocks of one value at a time.
+//!
+//! Addition and subtraction wrap around modulo 2^(64 * width), like
+//! fixed-width machine integers; multiplication produces the exact
+//! product in a batch of width `left width + right width`.
+class BigIntBatch
+{
+private:
+  size_t count;
+  unsigned width;
+  LimbVector limbs; // block j of value i is limbs[j * count + i]
+
+public:
+  //! Constructor. All values are initialized to 0.
+  //!
+  //! @param count number of values in the batch
+  //! @param width number of 64-bit blocks per value (at least 1)
+  //! @throw std::invalid_argument if `width` is 0
+  BigIntBatch(size_t count, unsigned width);
+
+  //! Get the number of values in the batch.
+  //!
+  //! @return number of values
+  size_t size() const;
+
+  //! Get the width of each value.
+  //!
+  //! @return number of 64-bit blocks per value
+  unsigned get_width() const;
+
+  //! Store a value into the batch.
+  //!
+  //! @param index position of the value (0 to size() - 1)
+  //! @param value the value to store
+  //! @throw std::invalid_argument if `value` does not fit in `width`
+  //!        blocks as a two's complement integer
+  void set(size_t index, const BigInt &value);
+
+  //! Read a value from the batch.
+  //!
+  //! @param index position of the value (0 to size() - 1)
+  //! @return the value at `index`
+  BigInt get(size_t index) const;
+
+  //! Get the blocks at one position of every value.
+  //!
+  //! @param block the block index (0 is the least significant)
+  //! @return pointer to `size()` consecutive blocks
+  const uint64_t *block_row(unsigned block) const;
+
+  //! Element-wise addition, modulo 2^(64 * width).
+  //!
+  //! @param rhs a batch with the same size and width
+  //! @return batch of sums
+  //! @throw std::invalid_argument if the sizes or widths differ
+  BigIntBatch operator+(const BigIntBatch &rhs) const;
+
+  //! Element-wise subtraction, modulo 2^(64 * width).
+  //!
+  //! @param rhs a batch with the same size and width
+  //! @return batch of differences
+  //! @throw std::invalid_argument if the sizes or widths differ
+  BigIntBatch operator-(const BigIntBatch &rhs) const;
+
+  //! Element-wise exact multiplication.
+  //!
+  //! @param rhs a batch with the same size (any width)
+  //! @return batch of products, with width `get_width() + rhs.get_width()`
+  //! @throw std::invalid_argument if the sizes differ
+  BigIntBatch operator*(const BigIntBatch &rhs) const;
+
+  //! Element-wise comparison (see BigInt::compare).
+  //!
+  //! @param rhs a batch with the same size and width
+  //! @return for each index, negative if this value is less than the
+  //!         value in `rhs`, 0 if equal, positive if greater
+  //! @throw std::invalid_argument if the sizes or widths differ
+  std::vector<int> compare(const BigIntBatch &rhs) const;
+
+  //! Convert every value to lower-case hexadecimal (see BigInt::to_hex).
+  //!
+  //! @return one string per value
+  std::vector<std::string> to_hex() const;
+
+  //! Convert every value to decimal (see BigInt::to_dec).
+  //!
+  //! @return one string per value
+  std::vector<std::string> to_dec() const;
+
+private:
+  void check_same_shape(const BigIntBatch &rhs) const;
+  LimbVector magnitudes(std::vector<uint64_t> &negative) const;
+};
+
+#endif // BIGINT_BATCH_H
@@ -0,0 +1,421 @@
+// Benchmark harness for BigInt: times each operation over a range of
+// operand sizes, reports the median and 99th percentile per call, and
+// optionally writes the results as JSON or compares them to a baseline
+// written by an earlier run.
+//
+// Usage: bigint_bench [options]
+//   --ops LIST         comma-separated operations (default: all)
+//   --sizes LIST       comma-separated operand sizes in limbs
+//                      (default: 1,10,100,...,1000000)
+//   --reps N           timed samples per operation and size (default 21)
+//   --warmup N         untimed samples before those (default 3)
+//   --time-limit S     time budget per operation and size, in seconds;
+//                      larger sizes of an operation are skipped once a
+//                      single call exceeds it (default 2)
+//   --threads N        threads for parallel operations (default 1)
+//   --json FILE        write the results to FILE
+//   --baseline FILE    compare the medians to a file written by --json
+//   --threshold PCT    slowdown that counts as a regression (default 10);
+//                      a baseline entry with no result in this run (e.g.,
+//                      skipped for the time limit) is also a regression
+//
+// The exit status is 1 if a regression was found. Numbers are only
+// meaningful for an optimized build, e.g.
+//   make clean && make bigint_bench CXXFLAGS="-O2 -std=c++17 -pthread"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bigint.h"
+#include "bigint_parallel.h"
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  // A sample repeats fast operations until it takes at least this long,
+  // so clock resolution does not dominate
+  const double MIN_SAMPLE_NS = 1e5;
+
+  struct Options
+  {
+    std::vector<std::string> ops;
+    std::vector<size_t> sizes;
+    unsigned reps = 21;
+    unsigned warmup = 3;
+    double timeLimit = 2.0;
+    unsigned threads = 1;
+    std::string jsonFile;
+    std::string baselineFile;
+    double threshold = 10.0;
+  };
+
+  struct Result
+  {
+    std::string op;
+    size_t limbs;
+    unsigned reps;
+    double medianNs;
+    double p99Ns;
+  };
+
+  // Operands for one size: a and b have `limbs` limbs, same equals a
+  // (so comparison scans every limb), wide has twice as many limbs (the
+  // dividend for division)
+  struct Operands
+  {
+    BigInt a;
+    BigInt b;
+    BigInt same;
+    BigInt wide;
+    std::vector<uint8_t> bytes;
+  };
+
+  // Operation to time; returns something derived from its result so
+  // the work cannot be optimized away
+  typedef std::function<size_t(const Operands &)> Operation;
+
+  volatile size_t sink;
+
+  /* RANDOM VALUE - HELPER */
+  std::vector<uint8_t> random_bytes(std::mt19937_64 &rng, size_t limbs)
+  {
+    std::vector<uint8_t> bytes(limbs * 8);
+    for (size_t i = 0; i < bytes.size(); i += 8)
+    {
+      uint64_t x = rng();
+      std::memcpy(&bytes[i], &x, 8);
+    }
+    bytes.back() |= 0x80; // full size
+    return bytes;
+  }
+
+  BigInt random_value(std::mt19937_64 &rng, size_t limbs)
+  {
+    std::vector<uint8_t> bytes = random_bytes(rng, limbs);
+    return BigInt::from_bytes(bytes.data(), bytes.size(), BigInt::ByteOrder::LITTLE, false);
+  }
+
+  /* OPERATIONS - HELPER */
+  std::vector<std::pair<std::string, Operation>> all_operations()
+  {
+    return {
+        {"construct", [](const Operands &x)
+         { return BigInt::from_bytes(x.bytes.data(), x.bytes.size(), BigInt::ByteOrder::LITTLE, false).get_bit_vector().size(); }},
+        {"add", [](const Operands &x)
+         { return (x.a + x.b).get_bit_vector().size(); }},
+        {"sub", [](const Operands &x)
+         { return (x.a - x.b).get_bit_vector().size(); }},
+        {"shift", [](const Operands &x)
+         { return (x.a << 37).get_bit_vector().size(); }},
+        {"mul", [](const Operands &x)
+         { return (x.a * x.b).get_bit_vector().size(); }},
+        {"div", [](const Operands &x)
+         { return (x.wide / x.b).get_bit_vector().size(); }},
+        {"compare", [](const Operands &x)
+         { return (size_t)(x.a.compare(x.same) + 1); }},
+        {"to_hex", [](const Operands &x)
+         { return x.a.to_hex().size(); }},
+        {"to_dec", [](const Operands &x)
+         { return x.a.to_dec().size(); }},
+    };
+  }
+
+  /* SPLIT LIST - HELPER */
+  std::vector<std::string> split(const std::string &list)
+  {
+    std::vector<std::string> items;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+      if (!item.empty())
+      {
+        items.push_back(item);
+      }
+    }
+    return items;
+  }
+
+  /* PARSE OPTIONS - HELPER */
+  bool parse_options(int argc, char **argv, Options &opts)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+      {
+        std::cerr << "Missing value for " << arg << "\n";
+        return false;
+      }
+      std::string value = argv[++i];
+      if (arg == "--ops")
+      {
+        opts.ops = split(value);
+      }
+      else if (arg == "--sizes")
+      {
+        opts.sizes.clear();
+        for (const std::string &s : split(value))
+        {
+          opts.sizes.push_back(std::strtoull(s.c_str(), nullptr, 10));
+        }
+      }
+      else if (arg == "--reps")
+      {
+        opts.reps = std::max(1, std::atoi(value.c_str()));
+      }
+      else if (arg == "--warmup")
+      {
+        opts.warmup = std::max(0, std::atoi(value.c_str()));
+      }
+      else if (arg == "--time-limit")
+      {
+        opts.timeLimit = std::atof(value.c_str());
+      }
+      else if (arg == "--threads")
+      {
+        opts.threads = std::max(1, std::atoi(value.c_str()));
+      }
+      else if (arg == "--json")
+      {
+        opts.jsonFile = value;
+      }
+      else if (arg == "--baseline")
+      {
+        opts.baselineFile = value;
+      }
+      else if (arg == "--threshold")
+      {
+        opts.threshold = std::atof(value.c_str());
+      }
+      else
+      {
+        std::cerr << "Unknown option " << arg << "\n";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* TIME CALLS - HELPER */
+  // Nanoseconds per call, averaged over `calls` calls
+  double time_calls(const Operation &op, const Operands &x, size_t calls)
+  {
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < calls; ++i)
+    {
+      sink = op(x);
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / calls;
+  }
+
+  /* PERCENTILE - HELPER */
+  // Nearest-rank percentile of sorted samples
+  double percentile(const std::vector<double> &sorted, double pct)
+  {
+    size_t rank = (size_t)(pct / 100.0 * sorted.size() + 0.999999);
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+  }
+
+  /* MEASURE - HELPER */
+  // Returns false if one call takes longer than the time limit
+  bool measure(const std::string &name, const Operation &op, const Operands &x, size_t limbs,
+               const Options &opts, Result &result)
+  {
+    double firstNs = time_calls(op, x, 1);
+    if (firstNs > opts.timeLimit * 1e9)
+    {
+      return false;
+    }
+
+    // Calls per sample, and fewer samples if they would not fit the budget
+    size_t calls = std::max((size_t)1, (size_t)(MIN_SAMPLE_NS / std::max(firstNs, 1.0)));
+    double sampleNs = std::max(firstNs * calls, 1.0);
+    unsigned budget = (unsigned)std::min(opts.timeLimit * 1e9 / sampleNs, 1e9);
+    unsigned reps = std::max(1U, std::min(opts.reps, budget));
+    unsigned warmup = std::min(opts.warmup, budget > reps ? budget - reps : 0U);
+
+    for (unsigned i = 0; i < warmup; ++i)
+    {
+      time_calls(op, x, calls);
+    }
+    std::vector<double> samples;
+    for (unsigned i = 0; i < reps; ++i)
+    {
+      samples.push_back(time_calls(op, x, calls));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    result.op = name;
+    result.limbs = limbs;
+    result.reps = reps;
+    result.medianNs = percentile(samples, 50);
+    result.p99Ns = percentile(samples, 99);
+    return true;
+  }
+
+  /* WRITE JSON - HELPER */
+  // One result per line, which read_baseline() relies on
+  void write_json(const std::string &filename, const std::vector<Result> &results, const Options &opts)
+  {
+    std::ofstream out(filename);
+    out << "{\n  \"threads\": " << opts.threads << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      const Result &r = results[i];
+      char line[256];
+      std::snprintf(line, sizeof line,
+                    "    {\"op\": \"%s\", \"limbs\": %zu, \"reps\": %u, \"median_ns\": %.1f, \"p99_ns\": %.1f}%s\n",
+                    r.op.c_str(), r.limbs, r.reps, r.medianNs, r.p99Ns, i + 1 < results.size() ? "," : "");
+      out << line;
+    }
+    out << "  ]\n}\n";
+  }
+
+  /* READ BASELINE - HELPER */
+  // Medians by operation and size from a file written by write_json()
+  std::map<std::pair<std::string, size_t>, double> read_baseline(const std::string &filename)
+  {
+    std::map<std::pair<std::string, size_t>, double> medians;
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line))
+    {
+      size_t op = line.find("\"op\": \"");
+      size_t limbs = line.find("\"limbs\": ");
+      size_t median = line.find("\"median_ns\": ");
+      if (op == std::string::npos || limbs == std::string::npos || median == std::string::npos)
+      {
+        continue;
+      }
+      op += 7;
+      std::string name = line.substr(op, line.find('"', op) - op);
+      size_t size = std::strtoull(line.c_str() + limbs + 9, nullptr, 10);
+      medians[{name, size}] = std::strtod(line.c_str() + median + 13, nullptr);
+    }
+    return medians;
+  }
+}
+
+/* MAIN */
+int main(int argc, char **argv)
+{
+  Options opts;
+  for (size_t limbs = 1; limbs <= 1000000; limbs *= 10)
+  {
+    opts.sizes.push_back(limbs);
+  }
+  if (!parse_options(argc, argv, opts))
+  {
+    return 2;
+  }
+
+  std::vector<std::pair<std::string, Operation>> ops;
+  for (const auto &op : all_operations())
+  {
+    if (opts.ops.empty() || std::find(opts.ops.begin(), opts.ops.end(), op.first) != opts.ops.end())
+    {
+      ops.push_back(op);
+    }
+  }
+  set_parallel_threads(opts.threads);
+
+  std::vector<Result> results;
+  std::vector<bool> skipped(ops.size(), false);
+  std::mt19937_64 rng(12345);
+  std::printf("%-10s %9s %6s %14s %14s\n", "op", "limbs", "reps", "median ns", "p99 ns");
+  for (size_t limbs : opts.sizes)
+  {
+    if (limbs == 0)
+    {
+      continue;
+    }
+    Operands x;
+    x.bytes = random_bytes(rng, limbs);
+    x.a = BigInt::from_bytes(x.bytes.data(), x.bytes.size(), BigInt::ByteOrder::LITTLE, false);
+    x.same = BigInt::from_bytes(x.bytes.data(), x.bytes.size(), BigInt::ByteOrder::LITTLE, false);
+    x.b = random_value(rng, limbs);
+    x.wide = random_value(rng, 2 * limbs);
+
+    for (size_t k = 0; k < ops.size(); ++k)
+    {
+      if (skipped[k])
+      {
+        continue;
+      }
+      Result r;
+      if (!measure(ops[k].first, ops[k].second, x, limbs, opts, r))
+      {
+        std::printf("%-10s %9zu  skipped: one call exceeds the time limit\n", ops[k].first.c_str(), limbs);
+        skipped[k] = true;
+        continue;
+      }
+      std::printf("%-10s %9zu %6u %14.1f %14.1f\n", r.op.c_str(), r.limbs, r.reps, r.medianNs, r.p99Ns);
+      std::fflush(stdout);
+      results.push_back(r);
+    }
+  }
+
+  if (!opts.jsonFile.empty())
+  {
+    write_json(opts.jsonFile, results, opts);
+  }
+
+  // Compare medians to the baseline
+  int status = 0;
+  if (!opts.baselineFile.empty())
+  {
+    std::map<std::pair<std::string, size_t>, double> baseline = read_baseline(opts.baselineFile);
+    if (baseline.empty())
+    {
+      std::cerr << "No results in baseline " << opts.baselineFile << "\n";
+      return 2;
+    }
+    std::map<std::pair<std::string, size_t>, double> current;
+    for (const Result &r : results)
+    {
+      current[{r.op, r.limbs}] = r.medianNs;
+    }
+    std::printf("\n%-10s %9s %14s %14s %8s\n", "op", "limbs", "baseline ns", "median ns", "change");
+    for (const auto &entry : baseline)
+    {
+      const std::string &op = entry.first.first;
+      size_t limbs = entry.first.second;
+      bool selected = std::any_of(ops.begin(), ops.end(), [&](const std::pair<std::string, Operation> &o)
+                                  { return o.first == op; }) &&
+                      std::find(opts.sizes.begin(), opts.sizes.end(), limbs) != opts.sizes.end();
+      if (!selected || entry.second <= 0)
+      {
+        continue;
+      }
+      // A size skipped for exceeding the time limit is the worst kind of
+      // slowdown, so a missing result counts as a regression
+      auto it = current.find(entry.first);
+      if (it == current.end())
+      {
+        std::printf("%-10s %9zu %14.1f %14s %8s  REGRESSION (no result)\n", op.c_str(), limbs, entry.second, "-",
+                    "-");
+        status = 1;
+        continue;
+      }
+      double change = (it->second / entry.second - 1) * 100;
+      bool regression = change > opts.threshold;
+      std::printf("%-10s %9zu %14.1f %14.1f %+7.1f%%%s\n", op.c_str(), limbs, entry.second, it->second, change,
+                  regression ? "  REGRESSION" : "");
+      status = regression ? 1 : status;
+    }
+  }
+  return status;
+}
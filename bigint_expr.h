@@ -0,0 +1,232 @@
+#ifndef BIGINT_EXPR_H
+#define BIGINT_EXPR_H
+
+#include <deque>
+#include <vector>
+#include "bigint.h"
+
+//! @file
+//! Opt-in expression templates for BigInt. Wrapping an operand with
+//! `lazy()` makes `+`, `-` and `*` build an expression object instead
+//! of computing intermediate BigInt values:
+//!
+//!     result = lazy(a) * b + c - d;
+//!
+//! Nothing is computed until the expression is assigned to a BigInt.
+//! At that point all added and subtracted values are summed in a
+//! single carry pass and each product is multiplied straight into the
+//! destination's existing buffer. An expression refers to its operands,
+//! so it should be assigned within the statement that creates it.
+
+//! One term of a flattened expression: `left` or `left * right`,
+//! possibly negated.
+struct BigIntTerm
+{
+  const BigInt *left;
+  const BigInt *right; // null for a term without a product
+  bool negate;
+};
+
+//! Flattened form of an expression: a list of terms plus storage for
+//! any sub-expressions that had to be computed up front (e.g., the
+//! factors of `(a + b) * c`).
+class BigIntTermList
+{
+public:
+  std::vector<BigIntTerm> terms;
+  std::deque<BigInt> temporaries;
+
+  //! Store a computed value for the lifetime of the list.
+  //!
+  //! @param value the value to keep
+  //! @return pointer to the stored copy
+  const BigInt *keep(const BigInt &value)
+  {
+    temporaries.push_back(value);
+    return &temporaries.back();
+  }
+};
+
+//! Base class of all expression nodes (curiously recurring template
+//! pattern: `E` is the derived node type).
+template <class E>
+class BigIntExpr
+{
+public:
+  //! Append the terms of this expression to a term list.
+  //!
+  //! @param list the list to append to
+  //! @param negate if true, every appended term is negated
+  void collect(BigIntTermList &list, bool negate) const
+  {
+    static_cast<const E &>(*this).collect_terms(list, negate);
+  }
+
+  //! Evaluate the expression into a new BigInt.
+  operator BigInt() const
+  {
+    BigInt result;
+    result = *this;
+    return result;
+  }
+};
+
+//! Expression node referring to an existing BigInt.
+class BigIntLeaf : public BigIntExpr<BigIntLeaf>
+{
+public:
+  const BigInt &value;
+
+  explicit BigIntLeaf(const BigInt &v) : value(v) {}
+
+  void collect_terms(BigIntTermList &list, bool negate) const
+  {
+    list.terms.push_back({&value, nullptr, negate});
+  }
+};
+
+//! Expression node for a sum (`Sub` false) or difference (`Sub` true).
+template <class L, class R, bool Sub>
+class BigIntSum : public BigIntExpr<BigIntSum<L, R, Sub>>
+{
+public:
+  L left;
+  R right;
+
+  BigIntSum(const L &l, const R &r) : left(l), right(r) {}
+
+  void collect_terms(BigIntTermList &list, bool negate) const
+  {
+    left.collect(list, negate);
+    right.collect(list, negate != Sub);
+  }
+};
+
+//! Expression node for a negation.
+template <class E>
+class BigIntNeg : public BigIntExpr<BigIntNeg<E>>
+{
+public:
+  E operand;
+
+  explicit BigIntNeg(const E &e) : operand(e) {}
+
+  void collect_terms(BigIntTermList &list, bool negate) const
+  {
+    operand.collect(list, !negate);
+  }
+};
+
+//! Get a pointer to the value of a product factor: leaves are used in
+//! place, anything else is computed and kept in the term list.
+inline const BigInt *factor_value(const BigIntLeaf &leaf, BigIntTermList &)
+{
+  return &leaf.value;
+}
+
+template <class E>
+const BigInt *factor_value(const BigIntExpr<E> &expr, BigIntTermList &list)
+{
+  return list.keep(BigInt(expr));
+}
+
+//! Expression node for a product.
+template <class L, class R>
+class BigIntProduct : public BigIntExpr<BigIntProduct<L, R>>
+{
+public:
+  L left;
+  R right;
+
+  BigIntProduct(const L &l, const R &r) : left(l), right(r) {}
+
+  void collect_terms(BigIntTermList &list, bool negate) const
+  {
+    const BigInt *l = factor_value(left, list);
+    const BigInt *r = factor_value(right, list);
+    list.terms.push_back({l, r, negate});
+  }
+};
+
+//! Start an expression from a BigInt value.
+//!
+//! @param value the operand
+//! @return expression node referring to `value`
+inline BigIntLeaf lazy(const BigInt &value)
+{
+  return BigIntLeaf(value);
+}
+
+// Operators combining two expressions, or an expression and a BigInt
+
+template <class L, class R>
+BigIntSum<L, R, false> operator+(const BigIntExpr<L> &l, const BigIntExpr<R> &r)
+{
+  return BigIntSum<L, R, false>(static_cast<const L &>(l), static_cast<const R &>(r));
+}
+
+template <class L>
+BigIntSum<L, BigIntLeaf, false> operator+(const BigIntExpr<L> &l, const BigInt &r)
+{
+  return BigIntSum<L, BigIntLeaf, false>(static_cast<const L &>(l), BigIntLeaf(r));
+}
+
+template <class R>
+BigIntSum<BigIntLeaf, R, false> operator+(const BigInt &l, const BigIntExpr<R> &r)
+{
+  return BigIntSum<BigIntLeaf, R, false>(BigIntLeaf(l), static_cast<const R &>(r));
+}
+
+template <class L, class R>
+BigIntSum<L, R, true> operator-(const BigIntExpr<L> &l, const BigIntExpr<R> &r)
+{
+  return BigIntSum<L, R, true>(static_cast<const L &>(l), static_cast<const R &>(r));
+}
+
+template <class L>
+BigIntSum<L, BigIntLeaf, true> operator-(const BigIntExpr<L> &l, const BigInt &r)
+{
+  return BigIntSum<L, BigIntLeaf, true>(static_cast<const L &>(l), BigIntLeaf(r));
+}
+
+template <class R>
+BigIntSum<BigIntLeaf, R, true> operator-(const BigInt &l, const BigIntExpr<R> &r)
+{
+  return BigIntSum<BigIntLeaf, R, true>(BigIntLeaf(l), static_cast<const R &>(r));
+}
+
+template <class E>
+BigIntNeg<E> operator-(const BigIntExpr<E> &e)
+{
+  return BigIntNeg<E>(static_cast<const E &>(e));
+}
+
+template <class L, class R>
+BigIntProduct<L, R> operator*(const BigIntExpr<L> &l, const BigIntExpr<R> &r)
+{
+  return BigIntProduct<L, R>(static_cast<const L &>(l), static_cast<const R &>(r));
+}
+
+template <class L>
+BigIntProduct<L, BigIntLeaf> operator*(const BigIntExpr<L> &l, const BigInt &r)
+{
+  return BigIntProduct<L, BigIntLeaf>(static_cast<const L &>(l), BigIntLeaf(r));
+}
+
+template <class R>
+BigIntProduct<BigIntLeaf, R> operator*(const BigInt &l, const BigIntExpr<R> &r)
+{
+  return BigIntProduct<BigIntLeaf, R>(BigIntLeaf(l), static_cast<const R &>(r));
+}
+
+/* ASSIGNMENT FROM EXPRESSION */
+template <class E>
+BigInt &BigInt::operator=(const BigIntExpr<E> &expr)
+{
+  BigIntTermList list;
+  expr.collect(list, false);
+  assign_terms(list.terms.data(), list.terms.size());
+  return *this;
+}
+
+#endif // BIGINT_EXPR_H
@@ -0,0 +1,472 @@
+#include "bigint_float.h"
+#include "bigint_rational.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace
+{
+  const double LOG10_2 = 0.30102999566398120;
+
+  // Precision of values constructed without one
+  size_t defaultPrecision = 128;
+
+  /* PRECISION - HELPER */
+  size_t precision_or_default(size_t precision)
+  {
+    return precision ? precision : defaultPrecision;
+  }
+
+  /* CHECK PRECISION - HELPER */
+  void check_precision(size_t precision)
+  {
+    if (precision == 0)
+    {
+      throw std::invalid_argument("Precision must be positive");
+    }
+  }
+
+  /* SHIFT COUNT - HELPER */
+  // BigInt shifts take an unsigned count; a larger one (an exponent
+  // of 2^32 or more) is refused rather than truncated
+  unsigned shift_count(uint64_t bits)
+  {
+    if (bits > std::numeric_limits<unsigned>::max())
+    {
+      throw std::invalid_argument("Exponent out of range");
+    }
+    return (unsigned)bits;
+  }
+
+  /* TRAILING ZEROES - HELPER */
+  // Number of zero bits below the lowest set bit of a nonzero value
+  size_t trailing_zeroes(const BigInt &value)
+  {
+    const LimbVector &limbs = value.get_bit_vector();
+    size_t i = 0;
+    while (limbs[i] == 0)
+    {
+      ++i;
+    }
+    return i * 64 + __builtin_ctzll(limbs[i]);
+  }
+
+  /* LOW BITS - HELPER */
+  // True if any of the lowest n bits is set
+  bool low_bits_set(const BigInt &value, size_t n)
+  {
+    const LimbVector &limbs = value.get_bit_vector();
+    size_t whole = std::min(n / 64, limbs.size());
+    for (size_t i = 0; i < whole; ++i)
+    {
+      if (limbs[i])
+      {
+        return true;
+      }
+    }
+    return whole < limbs.size() && n % 64 && (limbs[whole] << (64 - n % 64)) != 0;
+  }
+
+  /* ROUNDING DECISION - HELPER */
+  // Whether a value truncated in magnitude should be rounded away from
+  // zero, given its last kept bit (odd), the first discarded bit (half),
+  // and whether anything nonzero lies below that (beyond)
+  bool rounds_away(bool negative, Rounding mode, bool odd, bool half, bool beyond)
+  {
+    switch (mode)
+    {
+    case Rounding::NEAREST:
+      return half && (beyond || odd);
+    case Rounding::TOWARD_ZERO:
+      return false;
+    case Rounding::UP:
+      return !negative && (half || beyond);
+    case Rounding::DOWN:
+      return negative && (half || beyond);
+    }
+    return false;
+  }
+}
+
+/* DEFAULT PRECISION */
+void set_float_default_precision(size_t bits)
+{
+  check_precision(bits);
+  defaultPrecision = bits;
+}
+
+size_t get_float_default_precision()
+{
+  return defaultPrecision;
+}
+
+/* DEFAULT CONSTRUCTOR */
+BigFloat::BigFloat() : mantissa(0), exponent(0), negative(false), precision(defaultPrecision)
+{
+}
+
+/* CONSTRUCTOR */
+BigFloat::BigFloat(const BigInt &value, size_t precision, Rounding mode)
+{
+  *this = make(value.is_negative() ? -value : value, 0, value.is_negative(), precision_or_default(precision), mode,
+               false);
+}
+
+BigFloat::BigFloat(double value, size_t precision, Rounding mode)
+{
+  if (!std::isfinite(value))
+  {
+    throw std::invalid_argument("Value is not finite");
+  }
+  // frexp gives |value| = m * 2^e with m in [0.5, 1): 53 bits of m are exact
+  int exp = 0;
+  double m = std::frexp(std::fabs(value), &exp);
+  BigInt mag((uint64_t)std::ldexp(m, 53));
+  *this = make(mag, (int64_t)exp - 53, value < 0, precision_or_default(precision), mode, false);
+}
+
+BigFloat::BigFloat(const BigRational &value, size_t precision, Rounding mode)
+{
+  const BigInt &num = value.get_numerator();
+  *this = quotient(num.is_negative() ? -num : num, value.get_denominator(), 0, num.is_negative(),
+                   precision_or_default(precision), mode);
+}
+
+/* MAKE - HELPER */
+BigFloat BigFloat::make(BigInt mag, int64_t exp, bool neg, size_t precision, Rounding mode, bool sticky)
+{
+  // Round mag * 2^exp to precision bits. If sticky is set, the exact
+  // value lies strictly between mag and mag + 1 (scaled by 2^exp).
+  check_precision(precision);
+  BigFloat result;
+  result.precision = precision;
+  if (mag == 0)
+  {
+    return result;
+  }
+  size_t bits = mag.bit_length();
+  if (sticky && bits < precision + 2)
+  {
+    // Make room for the rounding bit, so that sticky lies below it
+    unsigned pad = shift_count(precision + 2 - bits);
+    mag = mag << pad;
+    exp -= pad;
+    bits += pad;
+  }
+  if (bits > precision)
+  {
+    size_t shift = bits - precision;
+    bool half = mag.is_bit_set(shift_count(shift - 1));
+    bool beyond = sticky || low_bits_set(mag, shift - 1);
+    mag = mag >> shift_count(shift);
+    exp += shift;
+    if (rounds_away(neg, mode, mag.is_bit_set(0), half, beyond))
+    {
+      mag = mag + 1; // a carry out gives 2^precision, trimmed below
+    }
+  }
+  size_t zeroes = trailing_zeroes(mag);
+  if (zeroes)
+  {
+    mag = mag >> shift_count(zeroes);
+    exp += zeroes;
+  }
+  result.mantissa = mag;
+  result.exponent = exp;
+  result.negative = neg;
+  return result;
+}
+
+/* QUOTIENT - HELPER */
+BigFloat BigFloat::quotient(const BigInt &num, const BigInt &den, int64_t exp, bool neg, size_t precision,
+                            Rounding mode)
+{
+  // Scale the dividend so that the quotient has at least precision + 2
+  // bits; a nonzero remainder only matters as a sticky bit
+  check_precision(precision);
+  if (num == 0)
+  {
+    return make(num, 0, false, precision, mode, false);
+  }
+  int64_t shift = (int64_t)(precision + 2 + den.bit_length()) - (int64_t)num.bit_length();
+  shift = std::max(shift, (int64_t)0);
+  BigInt scaled = num << shift_count(shift);
+  BigInt quot = scaled / den;
+  return make(quot, exp - shift, neg, precision, mode, quot * den != scaled);
+}
+
+/* ROUND */
+BigFloat BigFloat::round(size_t precision, Rounding mode) const
+{
+  return make(mantissa, exponent, negative, precision, mode, false);
+}
+
+/* ADDITION */
+BigFloat BigFloat::add(const BigFloat &rhs, size_t precision, Rounding mode) const
+{
+  check_precision(precision);
+  if (rhs.is_zero())
+  {
+    return round(precision, mode);
+  }
+  if (is_zero())
+  {
+    return rhs.round(precision, mode);
+  }
+
+  // An operand lying wholly below the rounding position of the other
+  // only decides the rounding through its sign. Replace it with a
+  // single bit there, rather than aligning, e.g., 1e100 and 1e-100 exactly.
+  int64_t top = exponent + (int64_t)mantissa.bit_length();
+  int64_t rhsTop = rhs.exponent + (int64_t)rhs.mantissa.bit_length();
+  const BigFloat &hi = top >= rhsTop ? *this : rhs;
+  BigFloat lo = top >= rhsTop ? rhs : *this;
+  int64_t limit = std::min(hi.exponent, std::max(top, rhsTop) - (int64_t)precision - 2);
+  if (std::min(top, rhsTop) < limit)
+  {
+    lo.mantissa = 1;
+    lo.exponent = limit - 1;
+  }
+
+  // Exact sum of the aligned mantissas
+  int64_t exp = std::min(hi.exponent, lo.exponent);
+  BigInt a = hi.mantissa << shift_count(hi.exponent - exp);
+  BigInt b = lo.mantissa << shift_count(lo.exponent - exp);
+  if (hi.negative == lo.negative)
+  {
+    return make(a + b, exp, hi.negative, precision, mode, false);
+  }
+  if (a >= b)
+  {
+    return make(a - b, exp, hi.negative, precision, mode, false);
+  }
+  return make(b - a, exp, lo.negative, precision, mode, false);
+}
+
+/* SUBTRACTION */
+BigFloat BigFloat::sub(const BigFloat &rhs, size_t precision, Rounding mode) const
+{
+  return add(-rhs, precision, mode);
+}
+
+/* MULTIPLICATION */
+BigFloat BigFloat::mul(const BigFloat &rhs, size_t precision, Rounding mode) const
+{
+  return make(mantissa * rhs.mantissa, exponent + rhs.exponent, negative != rhs.negative, precision, mode, false);
+}
+
+/* DIVISION */
+BigFloat BigFloat::div(const BigFloat &rhs, size_t precision, Rounding mode) const
+{
+  if (rhs.is_zero())
+  {
+    throw std::invalid_argument("Division by zero");
+  }
+  return quotient(mantissa, rhs.mantissa, exponent - rhs.exponent, negative != rhs.negative, precision, mode);
+}
+
+/* SQUARE ROOT */
+BigFloat BigFloat::sqrt(size_t precision, Rounding mode) const
+{
+  check_precision(precision);
+  if (negative)
+  {
+    throw std::invalid_argument("Square root of a negative value");
+  }
+  if (is_zero())
+  {
+    return round(precision, mode);
+  }
+  // Scale the mantissa to at least 2 * (precision + 2) bits, and to an
+  // even exponent, so that its integer root has precision + 2 bits
+  int64_t shift = 2 * (int64_t)(precision + 2) - (int64_t)mantissa.bit_length();
+  shift = std::max(shift, (int64_t)0);
+  if ((exponent - shift) & 1)
+  {
+    ++shift;
+  }
+  BigInt scaled = mantissa << shift_count(shift);
+  BigInt root = isqrt(scaled);
+  return make(root, (exponent - shift) / 2, false, precision, mode, root * root != scaled);
+}
+
+/* OPERATORS */
+BigFloat BigFloat::operator+(const BigFloat &rhs) const
+{
+  return add(rhs, std::max(precision, rhs.precision));
+}
+
+BigFloat BigFloat::operator-(const BigFloat &rhs) const
+{
+  return sub(rhs, std::max(precision, rhs.precision));
+}
+
+BigFloat BigFloat::operator*(const BigFloat &rhs) const
+{
+  return mul(rhs, std::max(precision, rhs.precision));
+}
+
+BigFloat BigFloat::operator/(const BigFloat &rhs) const
+{
+  return div(rhs, std::max(precision, rhs.precision));
+}
+
+/* UNARY MINUS */
+BigFloat BigFloat::operator-() const
+{
+  BigFloat negated(*this);
+  negated.negative = !is_zero() && !negative;
+  return negated;
+}
+
+/* COMPARISON */
+int BigFloat::compare(const BigFloat &rhs) const
+{
+  int sign = is_zero() ? 0 : (negative ? -1 : 1);
+  int rhsSign = rhs.is_zero() ? 0 : (rhs.negative ? -1 : 1);
+  if (sign != rhsSign || sign == 0)
+  {
+    return sign < rhsSign ? -1 : (sign > rhsSign ? 1 : 0);
+  }
+  // Same sign: compare magnitudes, by the position of the top bit first
+  int64_t top = exponent + (int64_t)mantissa.bit_length();
+  int64_t rhsTop = rhs.exponent + (int64_t)rhs.mantissa.bit_length();
+  int cmp;
+  if (top != rhsTop)
+  {
+    cmp = top < rhsTop ? -1 : 1;
+  }
+  else
+  {
+    int64_t exp = std::min(exponent, rhs.exponent);
+    cmp = (mantissa << shift_count(exponent - exp)).compare(rhs.mantissa << shift_count(rhs.exponent - exp));
+  }
+  return negative ? -cmp : cmp;
+}
+
+/* ROUNDED QUOTIENT - HELPER */
+BigInt BigFloat::round_quotient(const BigInt &num, const BigInt &den, bool neg, Rounding mode)
+{
+  // num / den for positive den, rounded to an integer
+  BigInt quot = num / den;
+  BigInt rem = num - quot * den;
+  if (rem == 0)
+  {
+    return quot;
+  }
+  int cmp = (rem << 1).compare(den);
+  bool half = cmp >= 0;
+  bool beyond = cmp != 0;
+  if (rounds_away(neg, mode, quot.is_bit_set(0), half, beyond))
+  {
+    quot = quot + 1;
+  }
+  return quot;
+}
+
+/* SCALED DECIMAL - HELPER */
+BigInt BigFloat::scaled_decimal(int64_t power, Rounding mode) const
+{
+  // |value| * 10^power, rounded to an integer
+  BigInt num = mantissa;
+  BigInt den(1);
+  if (exponent >= 0)
+  {
+    num = num << shift_count(exponent);
+  }
+  else
+  {
+    den = den << shift_count(-(uint64_t)exponent);
+  }
+  if (power >= 0)
+  {
+    num = num * pow(BigInt(10), (uint64_t)power);
+  }
+  else
+  {
+    den = den * pow(BigInt(10), (uint64_t)-power);
+  }
+  return round_quotient(num, den, negative, mode);
+}
+
+/* CONVERT TO DECIMAL */
+std::string BigFloat::to_dec(size_t digits, Rounding mode) const
+{
+  if (digits == 0)
+  {
+    throw std::invalid_argument("At least one digit is needed");
+  }
+  if (is_zero())
+  {
+    return "0";
+  }
+
+  // Estimate the decimal exponent from the top bit, then correct it
+  // until the rounded digits fill exactly the requested width
+  int64_t top = exponent + (int64_t)mantissa.bit_length();
+  int64_t decExp = (int64_t)std::floor((double)(top - 1) * LOG10_2);
+  BigInt low = pow(BigInt(10), digits - 1);
+  BigInt high = low * 10;
+  BigInt digitValue;
+  while (true)
+  {
+    digitValue = scaled_decimal((int64_t)digits - 1 - decExp, mode);
+    if (digitValue >= high)
+    {
+      ++decExp;
+    }
+    else if (digitValue < low)
+    {
+      --decExp;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  std::string text = digitValue.to_dec();
+  std::string result = negative ? "-" : "";
+  result += text[0];
+  if (digits > 1)
+  {
+    result += '.';
+    result.append(text, 1, std::string::npos);
+  }
+  result += decExp < 0 ? "e-" : "e+";
+  result += std::to_string(decExp < 0 ? -decExp : decExp);
+  return result;
+}
+
+std::string BigFloat::to_dec() const
+{
+  // ceil(p * log10(2)) + 1 digits identify a p-bit value
+  return to_dec((size_t)std::ceil((double)precision * LOG10_2) + 1);
+}
+
+/* CONVERT TO FIXED POINT */
+std::string BigFloat::to_fixed(size_t fractionDigits, Rounding mode) const
+{
+  BigInt digitValue = is_zero() ? BigInt(0) : scaled_decimal((int64_t)fractionDigits, mode);
+  std::string text = digitValue.to_dec();
+  if (text.size() <= fractionDigits)
+  {
+    text.insert(0, fractionDigits + 1 - text.size(), '0');
+  }
+  std::string result = negative && digitValue != 0 ? "-" : "";
+  result.append(text, 0, text.size() - fractionDigits);
+  if (fractionDigits)
+  {
+    result += '.';
+    result.append(text, text.size() - fractionDigits, std::string::npos);
+  }
+  return result;
+}
+
+/* STREAM OUTPUT */
+std::ostream &operator<<(std::ostream &os, const BigFloat &value)
+{
+  return os << value.to_dec();
+}
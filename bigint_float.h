@@ -0,0 +1,215 @@
+#ifndef BIGINT_FLOAT_H
+#define BIGINT_FLOAT_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include "bigint.h"
+
+class BigRational;
+
+//! @file
+//! Arbitrary-precision binary floating point on top of BigInt.
+
+//! Direction in which an inexact result is rounded.
+enum class Rounding
+{
+  NEAREST,       //!< to the nearest value, ties to an even last bit (or digit)
+  TOWARD_ZERO,   //!< to the value of smaller magnitude
+  UP,            //!< toward positive infinity
+  DOWN           //!< toward negative infinity
+};
+
+//! Class representing a binary floating-point value
+//! `(-1)^sign * mantissa * 2^exponent`, where the mantissa is a
+//! non-negative BigInt of at most `precision` bits. Every operation
+//! computes the exact result (or enough bits of it to decide the
+//! rounding) and rounds once, so results are correctly rounded in each
+//! of the Rounding modes, as in IEEE 754 and MPFR. Trailing zero bits
+//! of the mantissa are dropped, so exact small values such as 3 or 0.5
+//! stay one block long whatever the precision.
+//!
+//! The arithmetic operators round to nearest at the larger of the two
+//! operands' precisions; add(), sub(), mul(), div() and sqrt() take the
+//! precision and rounding mode of the result explicitly. There are no
+//! infinities or NaNs: invalid operations throw, and the exponent is an
+//! `int64_t`, which no value that fits in memory can overflow. Decimal
+//! conversion of a value whose exponent is 2^32 or more in magnitude,
+//! and operations that would align mantissas that far apart, throw
+//! std::invalid_argument instead.
+class BigFloat
+{
+private:
+  BigInt mantissa; // non-negative, odd unless 0
+  int64_t exponent;
+  bool negative;
+  size_t precision;
+
+public:
+  //! Default constructor. The value is 0, with the default precision
+  //! (see set_float_default_precision()).
+  BigFloat();
+
+  //! Constructor from an integer, rounded to the given precision.
+  //!
+  //! @param value the value
+  //! @param precision the precision in bits (0 for the default)
+  //! @param mode the rounding mode
+  BigFloat(const BigInt &value, size_t precision = 0, Rounding mode = Rounding::NEAREST);
+
+  //! Constructor from a `double`, which is converted exactly if the
+  //! precision is at least 53 bits.
+  //!
+  //! @param value the value
+  //! @param precision the precision in bits (0 for the default)
+  //! @param mode the rounding mode
+  //! @throw std::invalid_argument if `value` is infinite or NaN
+  BigFloat(double value, size_t precision = 0, Rounding mode = Rounding::NEAREST);
+
+  //! Constructor from a fraction, e.g., an exact decimal such as
+  //! `BigRational(5, 100)`, correctly rounded to the given precision.
+  //!
+  //! @param value the value
+  //! @param precision the precision in bits (0 for the default)
+  //! @param mode the rounding mode
+  BigFloat(const BigRational &value, size_t precision = 0, Rounding mode = Rounding::NEAREST);
+
+  //! Get the precision of this value.
+  //!
+  //! @return the maximum number of mantissa bits
+  size_t get_precision() const { return precision; }
+
+  //! Get the mantissa, without the sign.
+  //!
+  //! @return the mantissa (odd, or 0 if the value is 0)
+  const BigInt &get_mantissa() const { return mantissa; }
+
+  //! Get the binary exponent.
+  //!
+  //! @return the power of two the mantissa is scaled by
+  int64_t get_exponent() const { return exponent; }
+
+  //! Check whether the value is negative.
+  //!
+  //! @return true if the value is less than 0
+  bool is_negative() const { return negative; }
+
+  //! Check whether the value is 0.
+  //!
+  //! @return true if the value is 0
+  bool is_zero() const { return mantissa == 0; }
+
+  //! Round to a new precision.
+  //!
+  //! @param precision the precision in bits
+  //! @param mode the rounding mode
+  //! @return the rounded value
+  //! @throw std::invalid_argument if `precision` is 0
+  BigFloat round(size_t precision, Rounding mode = Rounding::NEAREST) const;
+
+  //! Correctly rounded sum.
+  //!
+  //! @param rhs the right-hand side value
+  //! @param precision the precision of the result in bits
+  //! @param mode the rounding mode
+  //! @return the rounded sum
+  //! @throw std::invalid_argument if `precision` is 0
+  BigFloat add(const BigFloat &rhs, size_t precision, Rounding mode = Rounding::NEAREST) const;
+
+  //! Correctly rounded difference (see add()).
+  BigFloat sub(const BigFloat &rhs, size_t precision, Rounding mode = Rounding::NEAREST) const;
+
+  //! Correctly rounded product (see add()).
+  BigFloat mul(const BigFloat &rhs, size_t precision, Rounding mode = Rounding::NEAREST) const;
+
+  //! Correctly rounded quotient (see add()).
+  //!
+  //! @throw std::invalid_argument if `rhs` is 0 or `precision` is 0
+  BigFloat div(const BigFloat &rhs, size_t precision, Rounding mode = Rounding::NEAREST) const;
+
+  //! Correctly rounded square root.
+  //!
+  //! @param precision the precision of the result in bits
+  //! @param mode the rounding mode
+  //! @return the rounded square root
+  //! @throw std::invalid_argument if the value is negative or
+  //!        `precision` is 0
+  BigFloat sqrt(size_t precision, Rounding mode = Rounding::NEAREST) const;
+
+  //! Square root rounded to nearest at this value's precision.
+  BigFloat sqrt() const { return sqrt(precision); }
+
+  BigFloat operator+(const BigFloat &rhs) const;
+  BigFloat operator-(const BigFloat &rhs) const;
+  BigFloat operator*(const BigFloat &rhs) const;
+  BigFloat operator/(const BigFloat &rhs) const;
+  BigFloat operator-() const;
+
+  //! Compare two values exactly.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return negative if less than `rhs`, 0 if equal, positive if greater
+  int compare(const BigFloat &rhs) const;
+
+  bool operator==(const BigFloat &rhs) const { return compare(rhs) == 0; }
+  bool operator!=(const BigFloat &rhs) const { return compare(rhs) != 0; }
+  bool operator<(const BigFloat &rhs) const { return compare(rhs) < 0; }
+  bool operator<=(const BigFloat &rhs) const { return compare(rhs) <= 0; }
+  bool operator>(const BigFloat &rhs) const { return compare(rhs) > 0; }
+  bool operator>=(const BigFloat &rhs) const { return compare(rhs) >= 0; }
+
+  //! Convert to decimal scientific notation, e.g., `-1.2345e-7`,
+  //! correctly rounded to the given number of significant digits.
+  //!
+  //! @param digits the number of significant digits
+  //! @param mode the rounding mode
+  //! @return the value as a string (`0` for 0)
+  //! @throw std::invalid_argument if `digits` is 0, or if the exponent
+  //!        is 2^32 or more in magnitude
+  std::string to_dec(size_t digits, Rounding mode = Rounding::NEAREST) const;
+
+  //! Convert to decimal scientific notation with enough significant
+  //! digits to tell this value apart from its neighbours at its
+  //! precision.
+  //!
+  //! @return the value as a string
+  std::string to_dec() const;
+
+  //! Convert to fixed-point decimal notation, e.g., `1234.50`, correctly
+  //! rounded to the given number of digits after the point.
+  //!
+  //! @param fractionDigits the number of digits after the point
+  //! @param mode the rounding mode
+  //! @return the value as a string
+  //! @throw std::invalid_argument if the exponent is 2^32 or more in
+  //!        magnitude
+  std::string to_fixed(size_t fractionDigits, Rounding mode = Rounding::NEAREST) const;
+
+private:
+  static BigFloat make(BigInt mag, int64_t exp, bool neg, size_t precision, Rounding mode, bool sticky);
+  static BigFloat quotient(const BigInt &num, const BigInt &den, int64_t exp, bool neg, size_t precision,
+                           Rounding mode);
+  static BigInt round_quotient(const BigInt &num, const BigInt &den, bool neg, Rounding mode);
+  BigInt scaled_decimal(int64_t power, Rounding mode) const;
+};
+
+//! Write a value to a stream (see BigFloat::to_dec()).
+//!
+//! @param os the stream
+//! @param value the value to write
+//! @return the stream
+std::ostream &operator<<(std::ostream &os, const BigFloat &value);
+
+//! Set the precision, in bits, of values constructed without one.
+//! 128 by default.
+//!
+//! @param bits the precision
+//! @throw std::invalid_argument if `bits` is 0
+void set_float_default_precision(size_t bits);
+
+//! Get the default precision.
+//!
+//! @return the precision in bits
+size_t get_float_default_precision();
+
+#endif // BIGINT_FLOAT_H
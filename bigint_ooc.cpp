@@ -0,0 +1,280 @@
+#include "bigint_ooc.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  // Additions stream through this many limbs (1 MiB) at a time
+  const size_t STREAM_LIMBS = 1 << 17;
+
+  /* SYSTEM ERROR - HELPER */
+  std::runtime_error system_error(const std::string &what, const std::string &path)
+  {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+  }
+
+  /* ADD INTO - HELPER */
+  // r[0..rn) += a[0..an), an <= rn; returns the carry out of r
+  uint64_t add_into(uint64_t *r, size_t rn, const uint64_t *a, size_t an)
+  {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < an; ++i)
+    {
+      unsigned __int128 t = (unsigned __int128)r[i] + a[i] + carry;
+      r[i] = (uint64_t)t;
+      carry = (uint64_t)(t >> 64);
+    }
+    for (; carry != 0 && i < rn; ++i)
+    {
+      carry = ++r[i] == 0;
+    }
+    return carry;
+  }
+
+  /* TRIM - HELPER */
+  // Shrink a file to its significant limbs (at least one)
+  void trim(LimbFile &file)
+  {
+    size_t n = file.size();
+    while (n > 1 && file.data()[n - 1] == 0)
+    {
+      --n;
+    }
+    file.resize(n);
+  }
+}
+
+/* CREATE */
+LimbFile::LimbFile(const std::string &filename, size_t size)
+    : path(filename), fd(-1), limbs(nullptr), count(0)
+{
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    throw system_error("Cannot create", path);
+  }
+  try
+  {
+    resize(size);
+  }
+  catch (...)
+  {
+    ::close(fd);
+    throw;
+  }
+}
+
+/* OPEN */
+LimbFile::LimbFile(const std::string &filename)
+    : path(filename), fd(-1), limbs(nullptr), count(0)
+{
+  fd = ::open(path.c_str(), O_RDWR);
+  if (fd < 0)
+  {
+    throw system_error("Cannot open", path);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    throw system_error("Cannot stat", path);
+  }
+  count = st.st_size / sizeof(uint64_t);
+  try
+  {
+    map();
+  }
+  catch (...)
+  {
+    ::close(fd);
+    throw;
+  }
+}
+
+/* DESTRUCTOR */
+LimbFile::~LimbFile()
+{
+  unmap();
+  ::close(fd);
+}
+
+/* MAP - HELPER */
+void LimbFile::map()
+{
+  if (count == 0)
+  {
+    return;
+  }
+  void *p = ::mmap(nullptr, count * sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED)
+  {
+    throw system_error("Cannot map", path);
+  }
+  ::madvise(p, count * sizeof(uint64_t), MADV_SEQUENTIAL);
+  limbs = static_cast<uint64_t *>(p);
+}
+
+/* UNMAP - HELPER */
+void LimbFile::unmap()
+{
+  if (limbs)
+  {
+    ::munmap(limbs, count * sizeof(uint64_t));
+    limbs = nullptr;
+  }
+}
+
+/* DATA */
+uint64_t *LimbFile::data()
+{
+  return limbs;
+}
+
+const uint64_t *LimbFile::data() const
+{
+  return limbs;
+}
+
+/* SIZE */
+size_t LimbFile::size() const
+{
+  return count;
+}
+
+/* RESIZE */
+void LimbFile::resize(size_t size)
+{
+  unmap();
+  if (::ftruncate(fd, size * sizeof(uint64_t)) != 0)
+  {
+    throw system_error("Cannot resize", path);
+  }
+  count = size;
+  map();
+}
+
+/* ASSIGN */
+void LimbFile::assign(const BigIntView &value)
+{
+  resize(std::max(value.size(), (size_t)1));
+  limbs[0] = 0;
+  std::copy(value.data(), value.data() + value.size(), limbs);
+}
+
+/* VIEW */
+BigIntView LimbFile::view(bool negative) const
+{
+  return BigIntView(limbs, count, negative);
+}
+
+/* FLUSH */
+void LimbFile::flush()
+{
+  if (limbs)
+  {
+    ::msync(limbs, count * sizeof(uint64_t), MS_SYNC);
+  }
+}
+
+/* RELEASE */
+void LimbFile::release(size_t from, size_t to)
+{
+  // Only whole pages inside the range can be dropped
+  size_t page = ::sysconf(_SC_PAGESIZE);
+  size_t begin = (from * sizeof(uint64_t) + page - 1) / page * page;
+  size_t end = std::min(to, count) * sizeof(uint64_t) / page * page;
+  if (limbs && begin < end)
+  {
+    char *base = reinterpret_cast<char *>(limbs);
+    ::msync(base + begin, end - begin, MS_ASYNC);
+    ::madvise(base + begin, end - begin, MADV_DONTNEED);
+  }
+}
+
+/* OUT-OF-CORE ADDITION */
+bool ooc_add(const BigIntView &lhs, const BigIntView &rhs, LimbFile &out)
+{
+  // Put the larger magnitude first, so a difference cannot go negative
+  BigIntView a(lhs.data(), lhs.size());
+  BigIntView b(rhs.data(), rhs.size());
+  bool subtract = lhs.is_negative() != rhs.is_negative();
+  bool negative = lhs.is_negative();
+  if (a < b)
+  {
+    std::swap(a, b);
+    negative = rhs.is_negative();
+  }
+
+  size_t n = a.size();
+  size_t m = b.size();
+  out.resize(n + 1);
+  uint64_t *r = out.data();
+
+  // Stream through the operands one chunk at a time
+  uint64_t carry = 0;
+  for (size_t start = 0; start < n; start += STREAM_LIMBS)
+  {
+    size_t end = std::min(n, start + STREAM_LIMBS);
+    for (size_t i = start; i < end; ++i)
+    {
+      uint64_t y = i < m ? b.data()[i] : 0;
+      unsigned __int128 t;
+      if (subtract)
+      {
+        t = (unsigned __int128)a.data()[i] - y - carry;
+        carry = (t >> 64) != 0;
+      }
+      else
+      {
+        t = (unsigned __int128)a.data()[i] + y + carry;
+        carry = (uint64_t)(t >> 64);
+      }
+      r[i] = (uint64_t)t;
+    }
+    out.release(start, end);
+  }
+  r[n] = subtract ? 0 : carry;
+
+  trim(out);
+  return negative && !(out.size() == 1 && out.data()[0] == 0);
+}
+
+/* OUT-OF-CORE MULTIPLICATION */
+bool ooc_multiply(const BigIntView &lhs, const BigIntView &rhs, LimbFile &out, size_t blockLimbs)
+{
+  if (blockLimbs == 0)
+  {
+    throw std::invalid_argument("Block size must be positive");
+  }
+  size_t n = lhs.size();
+  size_t m = rhs.size();
+  out.resize(0);
+  out.resize(std::max(n + m, (size_t)1));
+  uint64_t *r = out.data();
+
+  // Block i of lhs times every block of rhs lands in out from limb
+  // i * blockLimbs up, so everything below that is final afterwards
+  for (size_t i = 0; i < n; i += blockLimbs)
+  {
+    BigIntView left(lhs.data() + i, std::min(blockLimbs, n - i));
+    for (size_t j = 0; j < m; j += blockLimbs)
+    {
+      BigIntView right(rhs.data() + j, std::min(blockLimbs, m - j));
+      BigInt partial = left * right;
+      const LimbVector &p = partial.get_bit_vector();
+      add_into(r + i + j, n + m - i - j, p.data(), p.size());
+    }
+    out.release(0, i + blockLimbs);
+  }
+
+  trim(out);
+  bool zero = out.size() == 1 && out.data()[0] == 0;
+  return lhs.is_negative() != rhs.is_negative() && !zero;
+}
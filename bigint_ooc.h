@@ -0,0 +1,115 @@
+#ifndef BIGINT_OOC_H
+#define BIGINT_OOC_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "bigint_view.h"
+
+//! @file
+//! Out-of-core arithmetic: magnitudes stored in memory-mapped files,
+//! so values are limited by disk space rather than RAM. Inputs are
+//! BigIntView objects, so they can be files, BigInts or any other limb
+//! buffer; results are written to a LimbFile.
+
+//! Magnitude (limbs only, no sign) stored in a file and mapped into
+//! memory. Pages are loaded on demand and written back by the kernel,
+//! so only the parts being worked on need to be resident.
+class LimbFile
+{
+private:
+  std::string path;
+  int fd;
+  uint64_t *limbs;
+  size_t count;
+
+public:
+  //! Create a file holding `size` zero limbs. An existing file is
+  //! truncated.
+  //!
+  //! @param filename path of the file
+  //! @param size number of limbs
+  //! @throw std::runtime_error if the file cannot be created or mapped
+  LimbFile(const std::string &filename, size_t size);
+
+  //! Open an existing file of limbs.
+  //!
+  //! @param filename path of the file
+  //! @throw std::runtime_error if the file cannot be opened or mapped
+  explicit LimbFile(const std::string &filename);
+
+  //! Destructor. Unmaps and closes the file (the file is kept).
+  ~LimbFile();
+
+  LimbFile(const LimbFile &) = delete;
+  LimbFile &operator=(const LimbFile &) = delete;
+
+  //! Get the limbs.
+  //!
+  //! @return pointer to the mapped limbs (null if the file is empty)
+  uint64_t *data();
+  const uint64_t *data() const;
+
+  //! Get the number of limbs.
+  //!
+  //! @return number of limbs in the file
+  size_t size() const;
+
+  //! Change the number of limbs. New limbs are zero. Pointers and views
+  //! into the file are invalidated.
+  //!
+  //! @param size the new number of limbs
+  //! @throw std::runtime_error if the file cannot be resized or remapped
+  void resize(size_t size);
+
+  //! Replace the contents with the magnitude of a value.
+  //!
+  //! @param value the value to store (its sign is not stored)
+  void assign(const BigIntView &value);
+
+  //! Get a view of the stored magnitude.
+  //!
+  //! @param negative sign to give the view
+  //! @return view of the limbs
+  BigIntView view(bool negative = false) const;
+
+  //! Write modified pages back to the file.
+  void flush();
+
+  //! Drop the pages of limbs [from, to) from memory; their contents stay
+  //! in the file and are reloaded on the next access.
+  //!
+  //! @param from first limb
+  //! @param to limb past the last one
+  void release(size_t from, size_t to);
+
+private:
+  void map();
+  void unmap();
+};
+
+//! Add two values out of core, streaming through the inputs and the
+//! output in order.
+//!
+//! @param lhs the left operand
+//! @param rhs the right operand
+//! @param out receives the magnitude of the sum (must not hold either
+//!            operand)
+//! @return true if the sum is negative
+bool ooc_add(const BigIntView &lhs, const BigIntView &rhs, LimbFile &out);
+
+//! Multiply two values out of core. The operands are split into blocks
+//! of `blockLimbs` limbs; each pair of blocks is multiplied in memory
+//! and added into the output, which is written in order from one block
+//! of the left operand to the next. Finished output pages are released.
+//!
+//! @param lhs the left operand
+//! @param rhs the right operand
+//! @param out receives the magnitude of the product (must not hold
+//!            either operand)
+//! @param blockLimbs limbs per block (memory use is a small multiple)
+//! @return true if the product is negative
+bool ooc_multiply(const BigIntView &lhs, const BigIntView &rhs, LimbFile &out,
+                  size_t blockLimbs = 1 << 20);
+
+#endif // BIGINT_OOC_H
@@ -0,0 +1,321 @@
+#include "bigint_parallel.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Cutoffs measured on this host by bigint_tune, if it has been run
+#if __has_include("bigint_tuning.h")
+#include "bigint_tuning.h"
+#endif
+#ifndef BIGINT_PARALLEL_MULTIPLY_CUTOFF
+#define BIGINT_PARALLEL_MULTIPLY_CUTOFF 2048
+#endif
+#ifndef BIGINT_PARALLEL_CONVERT_CUTOFF
+#define BIGINT_PARALLEL_CONVERT_CUTOFF 512
+#endif
+
+namespace
+{
+  struct Task
+  {
+    std::function<void()> work;
+    TaskGroup *group;
+  };
+
+  // Each thread has its own deque: the owner pushes and pops at the
+  // back, idle threads steal from the front of the others
+  struct WorkQueue
+  {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  // Index of the calling thread's queue in the current pool (the queue
+  // after the workers' belongs to threads outside the pool)
+  thread_local size_t queueIndex = ~(size_t)0;
+
+  // Read by pool threads while another thread may set them
+  std::atomic<size_t> multiplyCutoff(BIGINT_PARALLEL_MULTIPLY_CUTOFF);
+  std::atomic<size_t> convertCutoff(BIGINT_PARALLEL_CONVERT_CUTOFF);
+  std::atomic<size_t> sumCutoff(1 << 16);
+  std::atomic<unsigned> threadCount(1);
+}
+
+class WorkStealingPool
+{
+private:
+  std::vector<std::unique_ptr<WorkQueue>> queues; // one per worker, plus one shared
+  std::vector<std::thread> workers;
+  size_t numWorkers;
+  std::mutex sleepLock;
+  std::condition_variable wake;
+  std::atomic<size_t> queued;
+  bool stopping;
+
+public:
+  explicit WorkStealingPool(unsigned threads)
+      : numWorkers(threads - 1), queued(0), stopping(false)
+  {
+    // The calling thread is one of the threads, so start one fewer
+    for (unsigned i = 0; i < threads; ++i)
+    {
+      queues.emplace_back(new WorkQueue);
+    }
+    for (unsigned i = 0; i < numWorkers; ++i)
+    {
+      workers.emplace_back([this, i]
+                           { worker_loop(i); });
+    }
+  }
+
+  ~WorkStealingPool()
+  {
+    {
+      std::lock_guard<std::mutex> guard(sleepLock);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : workers)
+    {
+      t.join();
+    }
+  }
+
+  unsigned threads() const
+  {
+    return (unsigned)numWorkers + 1;
+  }
+
+  void push(Task task)
+  {
+    size_t index = queueIndex < numWorkers ? queueIndex : numWorkers;
+    {
+      std::lock_guard<std::mutex> guard(queues[index]->lock);
+      queues[index]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_one();
+  }
+
+  // Block until the group has no pending tasks or a task is queued that
+  // the caller could run instead
+  void wait_for(const TaskGroup &group)
+  {
+    std::unique_lock<std::mutex> guard(sleepLock);
+    wake.wait(guard, [this, &group]
+              { return group.pending.load() == 0 || queued.load() > 0; });
+  }
+
+  // Wake the threads waiting for a group; called when it completes
+  void group_done()
+  {
+    {
+      std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_all();
+  }
+
+  // Run one pending task, preferring the calling thread's own queue.
+  // Returns false if there was nothing to run.
+  bool run_one()
+  {
+    size_t own = queueIndex < numWorkers ? queueIndex : numWorkers;
+    Task task;
+    bool found = pop_back(own, task);
+    for (size_t k = 1; !found && k < queues.size(); ++k)
+    {
+      found = steal_front((own + k) % queues.size(), task);
+    }
+    if (!found)
+    {
+      return false;
+    }
+    queued.fetch_sub(1);
+
+    std::exception_ptr taskError;
+    try
+    {
+      task.work();
+    }
+    catch (...)
+    {
+      taskError = std::current_exception();
+    }
+    if (task.group->finish(taskError))
+    {
+      group_done();
+    }
+    return true;
+  }
+
+private:
+  bool pop_back(size_t index, Task &task)
+  {
+    std::lock_guard<std::mutex> guard(queues[index]->lock);
+    if (queues[index]->tasks.empty())
+    {
+      return false;
+    }
+    task = std::move(queues[index]->tasks.back());
+    queues[index]->tasks.pop_back();
+    return true;
+  }
+
+  bool steal_front(size_t index, Task &task)
+  {
+    std::lock_guard<std::mutex> guard(queues[index]->lock);
+    if (queues[index]->tasks.empty())
+    {
+      return false;
+    }
+    task = std::move(queues[index]->tasks.front());
+    queues[index]->tasks.pop_front();
+    return true;
+  }
+
+  void worker_loop(size_t index)
+  {
+    queueIndex = index;
+    for (;;)
+    {
+      if (run_one())
+      {
+        continue;
+      }
+      std::unique_lock<std::mutex> guard(sleepLock);
+      wake.wait(guard, [this]
+                { return stopping || queued.load() > 0; });
+      if (stopping)
+      {
+        return;
+      }
+    }
+  }
+};
+
+namespace
+{
+  std::unique_ptr<WorkStealingPool> pool;
+}
+
+/* THREAD COUNT */
+void set_parallel_threads(unsigned threads)
+{
+  threadCount.store(1, std::memory_order_relaxed);
+  pool.reset();
+  if (threads > 1)
+  {
+    pool.reset(new WorkStealingPool(threads));
+    threadCount.store(pool->threads(), std::memory_order_relaxed);
+  }
+}
+
+unsigned get_parallel_threads()
+{
+  return threadCount.load(std::memory_order_relaxed);
+}
+
+/* MULTIPLICATION CUTOFF */
+void set_parallel_multiply_cutoff(size_t blocks)
+{
+  multiplyCutoff.store(blocks, std::memory_order_relaxed);
+}
+
+size_t get_parallel_multiply_cutoff()
+{
+  return multiplyCutoff.load(std::memory_order_relaxed);
+}
+
+/* CONVERSION CUTOFF */
+void set_parallel_convert_cutoff(size_t blocks)
+{
+  convertCutoff.store(blocks, std::memory_order_relaxed);
+}
+
+size_t get_parallel_convert_cutoff()
+{
+  return convertCutoff.load(std::memory_order_relaxed);
+}
+
+/* SUM CUTOFF */
+void set_parallel_sum_cutoff(size_t blocks)
+{
+  sumCutoff.store(blocks, std::memory_order_relaxed);
+}
+
+size_t get_parallel_sum_cutoff()
+{
+  return sumCutoff.load(std::memory_order_relaxed);
+}
+
+/* TASK GROUP */
+TaskGroup::TaskGroup()
+    : pending(0)
+{
+  // No code needed
+}
+
+TaskGroup::~TaskGroup()
+{
+  try
+  {
+    wait();
+  }
+  catch (...)
+  {
+  }
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+  if (!pool)
+  {
+    task();
+    return;
+  }
+  pending.fetch_add(1);
+  pool->push({std::move(task), this});
+}
+
+void TaskGroup::wait()
+{
+  // Help with pending work; with none to run, sleep until the last
+  // task finishes or more work is queued
+  while (pending.load() > 0)
+  {
+    if (pool && !pool->run_one())
+    {
+      pool->wait_for(*this);
+    }
+  }
+
+  std::exception_ptr taskError;
+  {
+    std::lock_guard<std::mutex> guard(errorLock);
+    std::swap(taskError, error);
+  }
+  if (taskError)
+  {
+    std::rethrow_exception(taskError);
+  }
+}
+
+bool TaskGroup::finish(std::exception_ptr taskError)
+{
+  if (taskError)
+  {
+    std::lock_guard<std::mutex> guard(errorLock);
+    if (!error)
+    {
+      error = taskError;
+    }
+  }
+  // The waiter may destroy the group, and then the pool, as soon as
+  // pending reaches 0: the caller wakes it through its own pool pointer
+  return pending.fetch_sub(1) == 1;
+}
@@ -0,0 +1,99 @@
+#ifndef BIGINT_PARALLEL_H
+#define BIGINT_PARALLEL_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <cstddef>
+
+//! @file
+//! Work-stealing thread pool used to spread large BigInt operations
+//! over several cores. Parallelism is off by default: operations only
+//! use the pool after `set_parallel_threads()` is called with a count
+//! greater than 1, and only for operands above the operation's cutoff.
+
+//! Set the number of threads used by parallel BigInt operations,
+//! including the calling thread. Must not be called while a parallel
+//! operation is running.
+//!
+//! @param threads number of threads; 0 or 1 makes every operation serial
+void set_parallel_threads(unsigned threads);
+
+//! Get the number of threads used by parallel BigInt operations.
+//!
+//! @return number of threads (1 if parallelism is off)
+unsigned get_parallel_threads();
+
+//! Set the operand size, in 64-bit blocks, from which multiplication
+//! runs its recursive subproducts in parallel. Smaller subproducts
+//! stay on the thread that reached them.
+//!
+//! @param blocks the cutoff
+void set_parallel_multiply_cutoff(size_t blocks);
+
+//! Get the parallel multiplication cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_parallel_multiply_cutoff();
+
+//! Set the value size, in 64-bit blocks, from which decimal conversion
+//! converts the two halves of each split in parallel.
+//!
+//! @param blocks the cutoff
+void set_parallel_convert_cutoff(size_t blocks);
+
+//! Get the parallel decimal conversion cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_parallel_convert_cutoff();
+
+//! Set the total size, in 64-bit blocks over all terms, from which
+//! `sum()` adds the terms in parallel chunks.
+//!
+//! @param blocks the cutoff
+void set_parallel_sum_cutoff(size_t blocks);
+
+//! Get the parallel sum cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_parallel_sum_cutoff();
+
+//! Group of tasks that run on the pool and are joined together.
+//! Tasks may start groups of their own. A thread waiting for a group
+//! runs other pending tasks in the meantime, so nested groups cannot
+//! deadlock the pool, and sleeps when there are none. With parallelism off, `run()` executes the task
+//! immediately.
+class TaskGroup
+{
+private:
+  std::atomic<size_t> pending;
+  std::mutex errorLock;
+  std::exception_ptr error;
+
+public:
+  TaskGroup();
+
+  //! Destructor. Waits for the remaining tasks (errors are dropped).
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  //! Schedule a task. It may run on any pool thread, or on the thread
+  //! that calls `wait()`.
+  //!
+  //! @param task the task; it must stay valid until `wait()` returns
+  void run(std::function<void()> task);
+
+  //! Wait until every task of the group has finished.
+  //!
+  //! @throw the first exception thrown by a task, if any
+  void wait();
+
+private:
+  bool finish(std::exception_ptr taskError);
+  friend class WorkStealingPool;
+};
+
+#endif // BIGINT_PARALLEL_H
@@ -0,0 +1,247 @@
+#include "bigint_rational.h"
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+namespace
+{
+  // Larger denominators are reduced as soon as they have doubled
+  size_t reduceCutoff = 16;
+}
+
+/* REDUCTION CUTOFF */
+void set_rational_reduce_cutoff(size_t blocks)
+{
+  reduceCutoff = blocks;
+}
+
+size_t get_rational_reduce_cutoff()
+{
+  return reduceCutoff;
+}
+
+/* DEFAULT CONSTRUCTOR */
+BigRational::BigRational() : num(0), den(1), reduced(true), reducedSize(1)
+{
+}
+
+/* CONSTRUCTOR */
+BigRational::BigRational(const BigInt &value) : num(value), den(1), reduced(true), reducedSize(1)
+{
+}
+
+BigRational::BigRational(const BigInt &numerator, const BigInt &denominator)
+    : num(numerator), den(denominator), reduced(false), reducedSize(0)
+{
+  if (den == 0)
+  {
+    throw std::invalid_argument("Division by zero");
+  }
+  if (den.is_negative())
+  {
+    num = -num;
+    den = -den;
+  }
+  reduced = den == 1;
+  finish();
+}
+
+/* FINISH - HELPER */
+void BigRational::finish()
+{
+  // Keep zero as 0/1, and stop unreduced denominators from growing
+  // without bound. Waiting for the size to double since the last
+  // reduction keeps a large value from being reduced at every step.
+  if (num == 0)
+  {
+    den = 1;
+    reduced = true;
+  }
+  size_t size = den.get_bit_vector().size();
+  if (reduced)
+  {
+    reducedSize = size;
+  }
+  else if (size > reduceCutoff && size > 2 * reducedSize)
+  {
+    reduce();
+  }
+}
+
+/* REDUCE */
+void BigRational::reduce() const
+{
+  if (reduced)
+  {
+    return;
+  }
+  BigInt g = gcd(num, den);
+  if (g != 1)
+  {
+    num = divexact(num, g);
+    den = divexact(den, g);
+  }
+  reduced = true;
+  reducedSize = den.get_bit_vector().size();
+}
+
+/* NUMERATOR */
+const BigInt &BigRational::get_numerator() const
+{
+  reduce();
+  return num;
+}
+
+/* DENOMINATOR */
+const BigInt &BigRational::get_denominator() const
+{
+  reduce();
+  return den;
+}
+
+/* GET NEGATIVITY */
+bool BigRational::is_negative() const
+{
+  return num.is_negative();
+}
+
+/* IS REDUCED */
+bool BigRational::is_reduced() const
+{
+  return reduced;
+}
+
+/* ADDITION */
+BigRational BigRational::operator+(const BigRational &rhs) const
+{
+  return add(rhs, false);
+}
+
+/* SUBTRACTION */
+BigRational BigRational::operator-(const BigRational &rhs) const
+{
+  return add(rhs, true);
+}
+
+/* ADDITION - HELPER */
+BigRational BigRational::add(const BigRational &rhs, bool subtract) const
+{
+  BigInt rhsNum = subtract ? -rhs.num : rhs.num;
+  BigRational sum;
+  sum.reducedSize = std::max(reducedSize, rhs.reducedSize);
+  if (den == rhs.den)
+  {
+    sum.num = num + rhsNum;
+    sum.den = den;
+    sum.reduced = den == 1;
+  }
+  else if (rhs.den == 1)
+  {
+    // gcd(a + c * b, b) = gcd(a, b): adding an integer keeps the terms
+    sum.num = num + rhsNum * den;
+    sum.den = den;
+    sum.reduced = reduced;
+  }
+  else if (den == 1)
+  {
+    sum.num = num * rhs.den + rhsNum;
+    sum.den = rhs.den;
+    sum.reduced = rhs.reduced;
+  }
+  else
+  {
+    sum.num = num * rhs.den + rhsNum * den;
+    sum.den = den * rhs.den;
+    sum.reduced = false;
+  }
+  sum.finish();
+  return sum;
+}
+
+/* UNARY MINUS */
+BigRational BigRational::operator-() const
+{
+  BigRational negated(*this);
+  negated.num = -num;
+  return negated;
+}
+
+/* MULTIPLICATION */
+BigRational BigRational::operator*(const BigRational &rhs) const
+{
+  return multiply(num, den, rhs.num, rhs.den, reduced && rhs.reduced, reducedSize + rhs.reducedSize);
+}
+
+/* DIVISION */
+BigRational BigRational::operator/(const BigRational &rhs) const
+{
+  if (rhs.num == 0)
+  {
+    throw std::invalid_argument("Division by zero");
+  }
+  // Multiply by the reciprocal, with its sign moved to the numerator
+  if (rhs.num.is_negative())
+  {
+    return multiply(num, den, -rhs.den, -rhs.num, reduced && rhs.reduced, reducedSize + rhs.reducedSize);
+  }
+  return multiply(num, den, rhs.den, rhs.num, reduced && rhs.reduced, reducedSize + rhs.reducedSize);
+}
+
+/* MULTIPLICATION - HELPER */
+BigRational BigRational::multiply(const BigInt &a, const BigInt &b, const BigInt &c, const BigInt &d, bool reduced,
+                                  size_t reducedSize)
+{
+  // (a / b) * (c / d): cancel gcd(a, d) and gcd(c, b) before
+  // multiplying, so the products are no larger than the result. If both
+  // operands are in lowest terms, so is the result.
+  BigRational product;
+  BigInt g1 = d == 1 ? BigInt(1) : gcd(a, d);
+  BigInt g2 = b == 1 ? BigInt(1) : gcd(c, b);
+  if (g1 == 1 && g2 == 1)
+  {
+    product.num = a * c;
+    product.den = b * d;
+  }
+  else
+  {
+    product.num = divexact(a, g1) * divexact(c, g2);
+    product.den = divexact(b, g2) * divexact(d, g1);
+  }
+  product.reduced = reduced;
+  product.reducedSize = reducedSize;
+  product.finish();
+  return product;
+}
+
+/* COMPARISON */
+int BigRational::compare(const BigRational &rhs) const
+{
+  reduce();
+  rhs.reduce();
+  if (num.is_negative() != rhs.num.is_negative())
+  {
+    return num.is_negative() ? -1 : 1;
+  }
+  if (den == rhs.den)
+  {
+    return num.compare(rhs.num);
+  }
+  return (num * rhs.den).compare(rhs.num * den);
+}
+
+/* CONVERT TO STRING */
+std::string BigRational::to_string() const
+{
+  reduce();
+  if (den == 1)
+  {
+    return num.to_dec();
+  }
+  return num.to_dec() + "/" + den.to_dec();
+}
+
+/* STREAM OUTPUT */
+std::ostream &operator<<(std::ostream &os, const BigRational &value)
+{
+  return os << value.to_string();
+}
@@ -0,0 +1,133 @@
+#ifndef BIGINT_RATIONAL_H
+#define BIGINT_RATIONAL_H
+
+#include <iosfwd>
+#include <string>
+#include "bigint.h"
+
+//! @file
+//! Exact rational numbers on top of BigInt.
+
+//! Class representing an exact fraction `numerator / denominator` of two
+//! BigInt values. The sign is kept on the numerator; the denominator is
+//! always positive.
+//!
+//! Fractions are reduced lazily. Sums and differences stay unreduced
+//! until they are compared or printed, or until their parts are read.
+//! They are also reduced once the denominator is past the reduction
+//! cutoff (see set_rational_reduce_cutoff()) and twice the size it had
+//! in lowest terms. A chain of additions therefore costs a few gcds
+//! rather than one per step. Products and quotients cancel common
+//! factors crosswise before multiplying (each numerator against the
+//! other operand's denominator). This keeps reduced operands reduced
+//! and the intermediate values small.
+//!
+//! Const member functions may reduce the stored fraction, so a
+//! BigRational must not be used from several threads at once.
+class BigRational
+{
+private:
+  mutable BigInt num;
+  mutable BigInt den;
+  mutable bool reduced;       // true if gcd(num, den) is known to be 1
+  mutable size_t reducedSize; // blocks in den when last in lowest terms
+
+public:
+  //! Default constructor. The value is 0.
+  BigRational();
+
+  //! Constructor from an integer.
+  //!
+  //! @param value the value
+  BigRational(const BigInt &value);
+
+  //! Constructor from a numerator and a denominator, which need not be
+  //! in lowest terms.
+  //!
+  //! @param numerator the numerator
+  //! @param denominator the denominator
+  //! @throw std::invalid_argument if `denominator` is 0
+  BigRational(const BigInt &numerator, const BigInt &denominator);
+
+  //! Get the numerator of the fraction in lowest terms.
+  //!
+  //! @return the numerator (negative if the value is negative)
+  const BigInt &get_numerator() const;
+
+  //! Get the denominator of the fraction in lowest terms.
+  //!
+  //! @return the denominator (always positive)
+  const BigInt &get_denominator() const;
+
+  //! Check whether the value is negative.
+  //!
+  //! @return true if the value is less than 0
+  bool is_negative() const;
+
+  //! Check whether the stored fraction is known to be in lowest terms.
+  //!
+  //! @return true if no reduction is pending
+  bool is_reduced() const;
+
+  //! Bring the stored fraction to lowest terms now.
+  void reduce() const;
+
+  BigRational operator+(const BigRational &rhs) const;
+  BigRational operator-(const BigRational &rhs) const;
+  BigRational operator-() const;
+  BigRational operator*(const BigRational &rhs) const;
+
+  //! Division operator.
+  //!
+  //! @param rhs the divisor
+  //! @return the exact quotient
+  //! @throw std::invalid_argument if `rhs` is 0
+  BigRational operator/(const BigRational &rhs) const;
+
+  //! Compare two values (see BigInt::compare). Both are reduced first.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return negative if less than `rhs`, 0 if equal, positive if greater
+  int compare(const BigRational &rhs) const;
+
+  bool operator==(const BigRational &rhs) const { return compare(rhs) == 0; }
+  bool operator!=(const BigRational &rhs) const { return compare(rhs) != 0; }
+  bool operator<(const BigRational &rhs) const { return compare(rhs) < 0; }
+  bool operator<=(const BigRational &rhs) const { return compare(rhs) <= 0; }
+  bool operator>(const BigRational &rhs) const { return compare(rhs) > 0; }
+  bool operator>=(const BigRational &rhs) const { return compare(rhs) >= 0; }
+
+  //! Return the value in lowest terms, as `numerator/denominator` in
+  //! decimal, or just the numerator if the denominator is 1.
+  //!
+  //! @return the value as a string
+  std::string to_string() const;
+
+private:
+  BigRational add(const BigRational &rhs, bool subtract) const;
+  static BigRational multiply(const BigInt &a, const BigInt &b, const BigInt &c, const BigInt &d, bool reduced,
+                              size_t reducedSize);
+  void finish();
+};
+
+//! Write a value to a stream (see BigRational::to_string()).
+//!
+//! @param os the stream
+//! @param value the value to write
+//! @return the stream
+std::ostream &operator<<(std::ostream &os, const BigRational &value);
+
+//! Set the denominator size, in 64-bit blocks, above which the result
+//! of an operation is reduced right away instead of on demand, provided
+//! the denominator has also doubled since it was last in lowest terms.
+//! 16 by default.
+//!
+//! @param blocks the cutoff
+void set_rational_reduce_cutoff(size_t blocks);
+
+//! Get the reduction cutoff.
+//!
+//! @return the cutoff, in 64-bit blocks
+size_t get_rational_reduce_cutoff();
+
+#endif // BIGINT_RATIONAL_H
@@ -0,0 +1,229 @@
+#include "bigint_shared.h"
+#include <utility>
+
+/* ZERO VALUE - HELPER */
+const BigInt &SharedBigInt::zero_value()
+{
+  // Read by every handle without a block, so it lives in the pool and
+  // is never destroyed
+  static const BigInt *zero = []
+  {
+    LimbResourceScope scope(limb_pool_resource());
+    return new BigInt();
+  }();
+  return *zero;
+}
+
+/* NEW BLOCK - HELPER */
+SharedBigInt::Block *SharedBigInt::new_block(const BigInt &value)
+{
+  // Copy into the pool: handles may outlive the caller's resource scope
+  LimbResourceScope scope(limb_pool_resource());
+  return new Block{{1}, value};
+}
+
+/* ACQUIRE - HELPER */
+SharedBigInt::Block *SharedBigInt::acquire(Block *b)
+{
+  // A new reference is taken from an existing one, so no ordering is needed
+  if (b)
+  {
+    b->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  return b;
+}
+
+/* RELEASE - HELPER */
+void SharedBigInt::release(Block *b)
+{
+  // The last owner must see every other owner's accesses before freeing
+  if (b && b->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    delete b;
+  }
+}
+
+/* DEFAULT CONSTRUCTOR */
+SharedBigInt::SharedBigInt() : block(nullptr)
+{
+}
+
+/* CONSTRUCTOR */
+SharedBigInt::SharedBigInt(const BigInt &value) : block(new_block(value))
+{
+}
+
+/* COPY CONSTRUCTOR */
+SharedBigInt::SharedBigInt(const SharedBigInt &other) noexcept : block(acquire(other.block))
+{
+}
+
+/* MOVE CONSTRUCTOR */
+SharedBigInt::SharedBigInt(SharedBigInt &&other) noexcept : block(other.block)
+{
+  other.block = nullptr;
+}
+
+/* DESTRUCTOR */
+SharedBigInt::~SharedBigInt()
+{
+  release(block);
+}
+
+/* ASSIGNMENT */
+SharedBigInt &SharedBigInt::operator=(const SharedBigInt &rhs) noexcept
+{
+  // Acquire first, so that self-assignment cannot free the value
+  Block *b = acquire(rhs.block);
+  release(block);
+  block = b;
+  return *this;
+}
+
+/* MOVE ASSIGNMENT */
+SharedBigInt &SharedBigInt::operator=(SharedBigInt &&rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    release(block);
+    block = rhs.block;
+    rhs.block = nullptr;
+  }
+  return *this;
+}
+
+/* USE COUNT */
+size_t SharedBigInt::use_count() const
+{
+  return block ? block->refs.load(std::memory_order_relaxed) : 0;
+}
+
+/* MUTATE */
+BigInt &SharedBigInt::mutate()
+{
+  // With a count of 1 no other handle can appear, since copies are only
+  // made from this one; acquire pairs with the release of former owners
+  if (!block || block->refs.load(std::memory_order_acquire) != 1)
+  {
+    Block *copy = new_block(get());
+    release(block);
+    block = copy;
+  }
+  return block->value;
+}
+
+/* REPLACE - HELPER */
+void SharedBigInt::replace(const BigInt &value)
+{
+  // A shared value is left to the other handles rather than copied
+  // first. Assignment keeps the block's pool allocator.
+  if (block && block->refs.load(std::memory_order_acquire) == 1)
+  {
+    block->value = value;
+  }
+  else
+  {
+    Block *b = new_block(value);
+    release(block);
+    block = b;
+  }
+}
+
+/* COMPOUND OPERATIONS */
+SharedBigInt &SharedBigInt::operator+=(const BigInt &rhs)
+{
+  replace(get() + rhs);
+  return *this;
+}
+
+SharedBigInt &SharedBigInt::operator-=(const BigInt &rhs)
+{
+  replace(get() - rhs);
+  return *this;
+}
+
+SharedBigInt &SharedBigInt::operator*=(const BigInt &rhs)
+{
+  replace(get() * rhs);
+  return *this;
+}
+
+SharedBigInt &SharedBigInt::operator/=(const BigInt &rhs)
+{
+  replace(get() / rhs);
+  return *this;
+}
+
+SharedBigInt &SharedBigInt::operator%=(const BigInt &rhs)
+{
+  replace(get() % rhs);
+  return *this;
+}
+
+/* INTERN TABLE CONSTRUCTOR */
+BigIntInternTable::BigIntInternTable(size_t shards)
+    : shards(new Shard[shards ? shards : 1]), shardCount(shards ? shards : 1)
+{
+}
+
+/* SHARD - HELPER */
+BigIntInternTable::Shard &BigIntInternTable::shard_for(uint64_t hash) const
+{
+  // The low bits select the bucket within the shard, so use the high ones
+  return shards[(hash >> 32) % shardCount];
+}
+
+/* INTERN */
+SharedBigInt BigIntInternTable::intern(const BigInt &value)
+{
+  uint64_t hash = value.hash();
+  Shard &shard = shard_for(hash);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto range = shard.entries.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second.get() == value)
+    {
+      return it->second;
+    }
+  }
+  return shard.entries.emplace(hash, SharedBigInt(value))->second;
+}
+
+/* SIZE */
+size_t BigIntInternTable::size() const
+{
+  size_t total = 0;
+  for (size_t i = 0; i < shardCount; ++i)
+  {
+    std::lock_guard<std::mutex> guard(shards[i].lock);
+    total += shards[i].entries.size();
+  }
+  return total;
+}
+
+/* PURGE */
+size_t BigIntInternTable::purge()
+{
+  // New handles to an entry are only made under its shard's lock, so a
+  // count of 1 cannot grow while the lock is held
+  size_t removed = 0;
+  for (size_t i = 0; i < shardCount; ++i)
+  {
+    std::lock_guard<std::mutex> guard(shards[i].lock);
+    auto &entries = shards[i].entries;
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+      if (it->second.use_count() == 1)
+      {
+        it = entries.erase(it);
+        ++removed;
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+  return removed;
+}
@@ -0,0 +1,155 @@
+#ifndef BIGINT_SHARED_H
+#define BIGINT_SHARED_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "bigint.h"
+
+//! @file
+//! Copy-on-write BigInt storage for values that are copied far more
+//! often than they are modified, e.g., entries of caches or messages
+//! fanned out to several queues, and an interning table that keeps one
+//! shared copy of each distinct value.
+
+//! Handle to an immutable BigInt shared by reference counting. Copying
+//! a handle increments an atomic count instead of copying the limbs;
+//! the first mutation through a handle whose value is shared copies it
+//! (detaches), so other handles never see the change. Handles may be
+//! copied and destroyed concurrently from any thread; a single handle
+//! is not safe to mutate from several threads at once.
+//!
+//! Shared values are stored in the limb pool (see bigint_alloc.h) rather
+//! than the caller's current resource, so handles may outlive a
+//! LimbResourceScope. Default and moved-from handles hold 0 without any
+//! storage or reference count.
+class SharedBigInt
+{
+private:
+  struct Block
+  {
+    std::atomic<size_t> refs;
+    BigInt value;
+  };
+  Block *block; // null for the value 0
+
+public:
+  //! Default constructor. The value is 0; nothing is allocated or counted.
+  SharedBigInt();
+
+  //! Constructor from a BigInt, which is copied once.
+  //!
+  //! @param value the value to share
+  SharedBigInt(const BigInt &value);
+
+  //! Copy constructor: shares the other handle's value in O(1).
+  //!
+  //! @param other the handle to share with
+  SharedBigInt(const SharedBigInt &other) noexcept;
+
+  //! Move constructor. Leaves `other` holding 0.
+  //!
+  //! @param other the handle to take the value from
+  SharedBigInt(SharedBigInt &&other) noexcept;
+
+  //! Destructor. The value is freed with its last handle.
+  ~SharedBigInt();
+
+  //! Assignment operator: shares the other handle's value in O(1).
+  //!
+  //! @param rhs the handle to share with
+  SharedBigInt &operator=(const SharedBigInt &rhs) noexcept;
+
+  //! Move assignment operator. Leaves `rhs` holding 0.
+  //!
+  //! @param rhs the handle to take the value from
+  SharedBigInt &operator=(SharedBigInt &&rhs) noexcept;
+
+  //! Get the value. The reference is valid until this handle is
+  //! modified or destroyed.
+  //!
+  //! @return the shared value
+  const BigInt &get() const { return block ? block->value : zero_value(); }
+
+  operator const BigInt &() const { return get(); }
+  const BigInt &operator*() const { return get(); }
+  const BigInt *operator->() const { return &get(); }
+
+  //! Get the number of handles sharing the value (a snapshot, which
+  //! other threads may change at any time).
+  //!
+  //! @return the reference count (0 for a default or moved-from handle)
+  size_t use_count() const;
+
+  //! Get the value for modification, first copying it if other handles
+  //! share it. The reference is valid until this handle is copied,
+  //! assigned or destroyed; changes made through it after this handle
+  //! has been copied would be seen by the copies.
+  //!
+  //! @return the value, owned by this handle alone
+  BigInt &mutate();
+
+  // In-place compound operations, which detach a shared value
+  SharedBigInt &operator+=(const BigInt &rhs);
+  SharedBigInt &operator-=(const BigInt &rhs);
+  SharedBigInt &operator*=(const BigInt &rhs);
+  SharedBigInt &operator/=(const BigInt &rhs);
+  SharedBigInt &operator%=(const BigInt &rhs);
+
+private:
+  static const BigInt &zero_value();
+  static Block *new_block(const BigInt &value);
+  static Block *acquire(Block *b);
+  static void release(Block *b);
+  void replace(const BigInt &value);
+};
+
+//! Thread-safe interning (hash-consing) table: maps each distinct value
+//! to one canonical SharedBigInt, so that a value seen many times is
+//! stored once. Values are found by BigInt::hash(). The table is split
+//! into independently locked shards, so threads interning different
+//! values rarely wait for each other.
+class BigIntInternTable
+{
+private:
+  struct Shard
+  {
+    std::mutex lock;
+    std::unordered_multimap<uint64_t, SharedBigInt> entries; // by hash
+  };
+  std::unique_ptr<Shard[]> shards;
+  size_t shardCount;
+
+public:
+  //! Constructor.
+  //!
+  //! @param shards number of independently locked parts (at least 1)
+  explicit BigIntInternTable(size_t shards = 16);
+
+  BigIntInternTable(const BigIntInternTable &) = delete;
+  BigIntInternTable &operator=(const BigIntInternTable &) = delete;
+
+  //! Get the canonical instance of a value, adding the value to the
+  //! table if it is not there yet.
+  //!
+  //! @param value the value to look up
+  //! @return a handle sharing the one stored copy of `value`
+  SharedBigInt intern(const BigInt &value);
+
+  //! Get the number of distinct values in the table.
+  //!
+  //! @return the number of entries
+  size_t size() const;
+
+  //! Remove the values that no handle outside the table refers to.
+  //!
+  //! @return the number of entries removed
+  size_t purge();
+
+private:
+  Shard &shard_for(uint64_t hash) const;
+};
+
+#endif // BIGINT_SHARED_H
@@ -0,0 +1,227 @@
+#include "bigint_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+  const size_t NUM_OPS = (size_t)StatOp::COUNT;
+  const size_t NUM_TIERS = (size_t)StatTier::COUNT;
+
+  // Counters of one thread. Only the owning thread writes them; the
+  // atomics let snapshots read them at the same time.
+  struct Counters
+  {
+    std::atomic<uint64_t> calls[NUM_OPS] = {};
+    std::atomic<uint64_t> limbs[NUM_OPS] = {};
+    std::atomic<uint64_t> latency[NUM_OPS][STAT_LATENCY_BUCKETS] = {};
+    std::atomic<uint64_t> tierCalls[NUM_TIERS] = {};
+    std::atomic<uint64_t> tierLimbs[NUM_TIERS] = {};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocatedBytes{0};
+  };
+
+  struct Registry
+  {
+    std::mutex lock;
+    std::vector<Counters *> live;
+    BigIntStats retired; // totals of threads that have exited
+    BigIntStats offset;  // totals at the last reset
+  };
+
+  /* REGISTRY - HELPER */
+  Registry &registry()
+  {
+    // Never destroyed, so threads can still exit during static destruction
+    static Registry *reg = []
+    {
+      Registry *r = new Registry;
+      std::memset(&r->retired, 0, sizeof r->retired);
+      std::memset(&r->offset, 0, sizeof r->offset);
+      return r;
+    }();
+    return *reg;
+  }
+
+  /* BUMP - HELPER */
+  // Single-writer increment: no read-modify-write needed
+  void bump(std::atomic<uint64_t> &counter, uint64_t amount)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  /* ADD COUNTERS - HELPER */
+  void add_counters(BigIntStats &total, const Counters &c)
+  {
+    for (size_t op = 0; op < NUM_OPS; ++op)
+    {
+      total.calls[op] += c.calls[op].load(std::memory_order_relaxed);
+      total.limbs[op] += c.limbs[op].load(std::memory_order_relaxed);
+      for (unsigned b = 0; b < STAT_LATENCY_BUCKETS; ++b)
+      {
+        total.latency[op][b] += c.latency[op][b].load(std::memory_order_relaxed);
+      }
+    }
+    for (size_t tier = 0; tier < NUM_TIERS; ++tier)
+    {
+      total.tierCalls[tier] += c.tierCalls[tier].load(std::memory_order_relaxed);
+      total.tierLimbs[tier] += c.tierLimbs[tier].load(std::memory_order_relaxed);
+    }
+    total.allocations += c.allocations.load(std::memory_order_relaxed);
+    total.allocatedBytes += c.allocatedBytes.load(std::memory_order_relaxed);
+  }
+
+  /* TOTALS - HELPER */
+  // Sum over all threads; the registry lock must be held
+  BigIntStats totals(Registry &reg)
+  {
+    BigIntStats total = reg.retired;
+    for (const Counters *c : reg.live)
+    {
+      add_counters(total, *c);
+    }
+    return total;
+  }
+
+  // Folds the thread's counters into the retired totals when it exits
+  struct Registration
+  {
+    Counters *counters = nullptr;
+    ~Registration();
+  };
+
+  // Set once the calling thread's counters have been retired; trivially
+  // destructible, so it stays usable during thread exit
+  thread_local bool retiredThread = false;
+  thread_local Counters *localCounters = nullptr;
+  thread_local Registration registration;
+
+  Registration::~Registration()
+  {
+    if (!counters)
+    {
+      return;
+    }
+    Registry &reg = registry();
+    {
+      std::lock_guard<std::mutex> guard(reg.lock);
+      add_counters(reg.retired, *counters);
+      reg.live.erase(std::find(reg.live.begin(), reg.live.end(), counters));
+    }
+    delete counters;
+    localCounters = nullptr;
+    retiredThread = true;
+  }
+
+  /* LOCAL COUNTERS - HELPER */
+  // The calling thread's counters, or null once it is exiting
+  Counters *local_counters()
+  {
+    if (localCounters || retiredThread)
+    {
+      return localCounters;
+    }
+    Counters *c = new Counters;
+    {
+      Registry &reg = registry();
+      std::lock_guard<std::mutex> guard(reg.lock);
+      reg.live.push_back(c);
+    }
+    registration.counters = c;
+    localCounters = c;
+    return c;
+  }
+
+  /* LATENCY BUCKET - HELPER */
+  unsigned latency_bucket(uint64_t nanoseconds)
+  {
+    unsigned b = nanoseconds == 0 ? 0 : 64 - __builtin_clzll(nanoseconds);
+    return std::min(b, STAT_LATENCY_BUCKETS - 1);
+  }
+}
+
+/* ENABLED */
+bool stats_enabled()
+{
+#ifdef BIGINT_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* SNAPSHOT */
+BigIntStats stats_snapshot()
+{
+  Registry &reg = registry();
+  std::lock_guard<std::mutex> guard(reg.lock);
+  BigIntStats total = totals(reg);
+
+  // Report only what was counted since the last reset
+  uint64_t *t = reinterpret_cast<uint64_t *>(&total);
+  const uint64_t *o = reinterpret_cast<const uint64_t *>(&reg.offset);
+  for (size_t i = 0; i < sizeof(BigIntStats) / sizeof(uint64_t); ++i)
+  {
+    t[i] -= o[i];
+  }
+  return total;
+}
+
+/* RESET */
+void stats_reset()
+{
+  // Owners keep writing their counters, so reset by moving the offset
+  Registry &reg = registry();
+  std::lock_guard<std::mutex> guard(reg.lock);
+  reg.offset = totals(reg);
+}
+
+/* NAMES */
+const char *stat_op_name(StatOp op)
+{
+  static const char *const names[NUM_OPS] = {"add", "sub", "mul", "div", "mod",
+                                             "shift", "compare", "to_hex", "to_dec"};
+  return (size_t)op < NUM_OPS ? names[(size_t)op] : "unknown";
+}
+
+const char *stat_tier_name(StatTier tier)
+{
+  static const char *const names[NUM_TIERS] = {"mul_schoolbook", "mul_karatsuba", "sqr_schoolbook",
+                                               "sqr_karatsuba", "div_single_limb", "div_schoolbook",
+                                               "div_barrett"};
+  return (size_t)tier < NUM_TIERS ? names[(size_t)tier] : "unknown";
+}
+
+/* RECORDING */
+void stats_record_op(StatOp op, size_t limbs, uint64_t nanoseconds)
+{
+  Counters *c = local_counters();
+  if (c)
+  {
+    bump(c->calls[(size_t)op], 1);
+    bump(c->limbs[(size_t)op], limbs);
+    bump(c->latency[(size_t)op][latency_bucket(nanoseconds)], 1);
+  }
+}
+
+void stats_record_tier(StatTier tier, size_t limbs)
+{
+  Counters *c = local_counters();
+  if (c)
+  {
+    bump(c->tierCalls[(size_t)tier], 1);
+    bump(c->tierLimbs[(size_t)tier], limbs);
+  }
+}
+
+void stats_record_alloc(size_t bytes)
+{
+  Counters *c = local_counters();
+  if (c)
+  {
+    bump(c->allocations, 1);
+    bump(c->allocatedBytes, bytes);
+  }
+}
@@ -0,0 +1,132 @@
+#ifndef BIGINT_STATS_H
+#define BIGINT_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+//! @file
+//! Optional instrumentation of BigInt hot paths: calls, limbs processed
+//! and latency histograms per operation, calls per algorithm tier, and
+//! limb buffer allocations. It is compiled in only when the library is
+//! built with `-DBIGINT_STATS`; otherwise the recording macros expand to
+//! nothing and every snapshot is zero.
+//!
+//! Each thread counts into its own block with plain (relaxed) stores,
+//! so recording takes no locks and no atomic read-modify-writes. A
+//! snapshot sums the blocks of all live threads and those of threads
+//! that have exited. Everything that includes bigint.h must be compiled
+//! with the same setting.
+
+//! Instrumented operations.
+enum class StatOp
+{
+  ADD,     //!< operator+
+  SUB,     //!< operator-
+  MUL,     //!< operator*
+  DIV,     //!< operator/
+  MOD,     //!< operator%
+  SHIFT,   //!< operator<< and operator>>
+  COMPARE, //!< compare() and the comparison operators
+  TO_HEX,  //!< to_hex() and write_hex()
+  TO_DEC,  //!< to_dec() and write_dec()
+  COUNT
+};
+
+//! Algorithm tiers. Karatsuba counts one call per split, schoolbook
+//! one call per base case (including the leaves of Karatsuba).
+enum class StatTier
+{
+  MUL_SCHOOLBOOK,
+  MUL_KARATSUBA,
+  SQR_SCHOOLBOOK,
+  SQR_KARATSUBA,
+  DIV_SINGLE_LIMB, //!< division by a one-limb divisor
+  DIV_SCHOOLBOOK,  //!< long division (Knuth algorithm D)
+  DIV_BARRETT,     //!< Barrett division by a precomputed Divisor
+  COUNT
+};
+
+//! Number of latency buckets: bucket `b` counts calls that took from
+//! 2^(b-1) to 2^b - 1 nanoseconds (bucket 0: under 1 ns); the last
+//! bucket also holds everything slower.
+const unsigned STAT_LATENCY_BUCKETS = 40;
+
+//! Counter totals at one point in time.
+struct BigIntStats
+{
+  uint64_t calls[(size_t)StatOp::COUNT]; //!< calls per operation
+  uint64_t limbs[(size_t)StatOp::COUNT]; //!< operand limbs per operation
+  uint64_t latency[(size_t)StatOp::COUNT][STAT_LATENCY_BUCKETS]; //!< latency histogram per operation
+  uint64_t tierCalls[(size_t)StatTier::COUNT]; //!< calls per algorithm tier
+  uint64_t tierLimbs[(size_t)StatTier::COUNT]; //!< operand limbs per algorithm tier
+  uint64_t allocations; //!< limb buffers allocated
+  uint64_t allocatedBytes; //!< bytes of limb buffers allocated
+};
+
+//! Check whether instrumentation is compiled in.
+//!
+//! @return true if the library was built with `BIGINT_STATS`
+bool stats_enabled();
+
+//! Get the counts recorded by all threads since the last reset.
+//!
+//! @return the counter totals
+BigIntStats stats_snapshot();
+
+//! Start counting from zero again (for every thread).
+void stats_reset();
+
+//! Get the name of an operation, e.g., "mul".
+//!
+//! @param op the operation
+//! @return its name
+const char *stat_op_name(StatOp op);
+
+//! Get the name of an algorithm tier, e.g., "mul_karatsuba".
+//!
+//! @param tier the tier
+//! @return its name
+const char *stat_tier_name(StatTier tier);
+
+// Recording functions; use the macros below instead
+void stats_record_op(StatOp op, size_t limbs, uint64_t nanoseconds);
+void stats_record_tier(StatTier tier, size_t limbs);
+void stats_record_alloc(size_t bytes);
+
+#ifdef BIGINT_STATS
+
+// Times an operation from construction to destruction
+class StatScope
+{
+private:
+  StatOp op;
+  size_t limbs;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  StatScope(StatOp o, size_t l) : op(o), limbs(l), start(std::chrono::steady_clock::now()) {}
+
+  ~StatScope()
+  {
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    stats_record_op(op, limbs, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+  StatScope(const StatScope &) = delete;
+  StatScope &operator=(const StatScope &) = delete;
+};
+
+#define BIGINT_STAT_OP(op, limbs) StatScope statScope(StatOp::op, (limbs))
+#define BIGINT_STAT_TIER(tier, limbs) stats_record_tier(StatTier::tier, (limbs))
+#define BIGINT_STAT_ALLOC(bytes) stats_record_alloc(bytes)
+
+#else
+
+#define BIGINT_STAT_OP(op, limbs) ((void)0)
+#define BIGINT_STAT_TIER(tier, limbs) ((void)0)
+#define BIGINT_STAT_ALLOC(bytes) ((void)0)
+
+#endif // BIGINT_STATS
+
+#endif // BIGINT_STATS_H
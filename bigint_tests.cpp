@@ -1,7 +1,21 @@
 #include <stdexcept>
 #include <sstream>
+#include <iomanip>
 #include <iostream>
+#include <cstdio>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include "bigint.h"
+#include "bigint_expr.h"
+#include "bigint_batch.h"
+#include "bigint_parallel.h"
+#include "bigint_view.h"
+#include "bigint_ooc.h"
+#include "bigint_stats.h"
+#include "bigint_shared.h"
+#include "bigint_rational.h"
+#include "bigint_float.h"
 #include "tctest.h"
 
 struct TestObjs
@@ -130,6 +144,70 @@ void test_large_divisor_small_dividend(TestObjs *objs);
 void test_division_by_negative_one(TestObjs *objs);
 void test_division_by_one(TestObjs *objs);
 void test_division_of_zero_by_nonzero(TestObjs *objs);
+void test_remainder_signs(TestObjs *objs);
+void test_remainder_by_zero(TestObjs *objs);
+void test_divmod_large_numbers(TestObjs *objs);
+void test_gcd_small(TestObjs *objs);
+void test_gcd_large(TestObjs *objs);
+void test_lcm(TestObjs *objs);
+void test_xgcd(TestObjs *objs);
+void test_mod_inverse(TestObjs *objs);
+void test_pow_small(TestObjs *objs);
+void test_pow_powers_of_two(TestObjs *objs);
+void test_pow_large(TestObjs *objs);
+void test_factorial(TestObjs *objs);
+void test_binomial(TestObjs *objs);
+void test_fibonacci_lucas(TestObjs *objs);
+void test_pow_mod(TestObjs *objs);
+void test_is_probable_prime_small(TestObjs *objs);
+void test_is_probable_prime_pseudoprimes(TestObjs *objs);
+void test_is_probable_prime_large(TestObjs *objs);
+void test_next_prime(TestObjs *objs);
+void test_limb_alignment(TestObjs *objs);
+void test_limb_arena(TestObjs *objs);
+void test_limb_pool_reuse(TestObjs *objs);
+void test_add_carry_into_all_ones_block(TestObjs *objs);
+void test_sub_borrow_from_all_ones_block(TestObjs *objs);
+void test_expr_addmul(TestObjs *objs);
+void test_expr_matches_eager(TestObjs *objs);
+void test_expr_aliasing_and_reuse(TestObjs *objs);
+void test_batch_add_sub(TestObjs *objs);
+void test_batch_mul_compare(TestObjs *objs);
+void test_batch_to_hex_dec(TestObjs *objs);
+void test_mul_karatsuba(TestObjs *objs);
+void test_mul_parallel(TestObjs *objs);
+void test_to_dec_large(TestObjs *objs);
+void test_to_dec_parallel(TestObjs *objs);
+void test_product_range(TestObjs *objs);
+void test_sum_range(TestObjs *objs);
+void test_to_from_bytes(TestObjs *objs);
+void test_binary_records(TestObjs *objs);
+void test_bigint_view(TestObjs *objs);
+void test_limb_file(TestObjs *objs);
+void test_ooc_add_multiply(TestObjs *objs);
+void test_stream_output(TestObjs *objs);
+void test_write_dec_blocks(TestObjs *objs);
+void test_stats(TestObjs *objs);
+void test_tuning_cutoffs(TestObjs *objs);
+void test_divmod_u64(TestObjs *objs);
+void test_divexact(TestObjs *objs);
+void test_divisor(TestObjs *objs);
+void test_native_operands(TestObjs *objs);
+void test_native_conversions(TestObjs *objs);
+void test_shared_value(TestObjs *objs);
+void test_hash(TestObjs *objs);
+void test_intern_table(TestObjs *objs);
+void test_power_cache(TestObjs *objs);
+void test_rational(TestObjs *objs);
+void test_isqrt(TestObjs *objs);
+void test_float(TestObjs *objs);
+void test_prime_tables_arena(TestObjs *objs);
+void test_shared_arena(TestObjs *objs);
+void test_hash_mixing(TestObjs *objs);
+void test_clear_decimal_cache(TestObjs *objs);
+void test_float_huge_exponent(TestObjs *objs);
+void test_half_gcd(TestObjs *objs);
+
 
 int main(int argc, char **argv)
 {
@@ -240,6 +318,69 @@ int main(int argc, char **argv)
   TEST(test_large_divisor_small_dividend);
   TEST(test_division_resulting_in_fraction);
   TEST(test_to_dec_sequence);
+  TEST(test_remainder_signs);
+  TEST(test_remainder_by_zero);
+  TEST(test_divmod_large_numbers);
+  TEST(test_gcd_small);
+  TEST(test_gcd_large);
+  TEST(test_lcm);
+  TEST(test_xgcd);
+  TEST(test_mod_inverse);
+  TEST(test_pow_small);
+  TEST(test_pow_powers_of_two);
+  TEST(test_pow_large);
+  TEST(test_factorial);
+  TEST(test_binomial);
+  TEST(test_fibonacci_lucas);
+  TEST(test_pow_mod);
+  TEST(test_is_probable_prime_small);
+  TEST(test_is_probable_prime_pseudoprimes);
+  TEST(test_is_probable_prime_large);
+  TEST(test_next_prime);
+  TEST(test_limb_alignment);
+  TEST(test_limb_arena);
+  TEST(test_limb_pool_reuse);
+  TEST(test_add_carry_into_all_ones_block);
+  TEST(test_sub_borrow_from_all_ones_block);
+  TEST(test_expr_addmul);
+  TEST(test_expr_matches_eager);
+  TEST(test_expr_aliasing_and_reuse);
+  TEST(test_batch_add_sub);
+  TEST(test_batch_mul_compare);
+  TEST(test_batch_to_hex_dec);
+  TEST(test_mul_karatsuba);
+  TEST(test_mul_parallel);
+  TEST(test_to_dec_large);
+  TEST(test_to_dec_parallel);
+  TEST(test_product_range);
+  TEST(test_sum_range);
+  TEST(test_to_from_bytes);
+  TEST(test_binary_records);
+  TEST(test_bigint_view);
+  TEST(test_limb_file);
+  TEST(test_ooc_add_multiply);
+  TEST(test_stream_output);
+  TEST(test_write_dec_blocks);
+  TEST(test_stats);
+  TEST(test_tuning_cutoffs);
+  TEST(test_divmod_u64);
+  TEST(test_divexact);
+  TEST(test_divisor);
+  TEST(test_native_operands);
+  TEST(test_native_conversions);
+  TEST(test_shared_value);
+  TEST(test_hash);
+  TEST(test_intern_table);
+  TEST(test_power_cache);
+  TEST(test_rational);
+  TEST(test_isqrt);
+  TEST(test_float);
+  TEST(test_prime_tables_arena);
+  TEST(test_shared_arena);
+  TEST(test_hash_mixing);
+  TEST(test_clear_decimal_cache);
+  TEST(test_float_huge_exponent);
+  TEST(test_half_gcd);
   TEST_FINI();
 }
 
@@ -262,7 +403,7 @@ void cleanup(TestObjs *objs)
 
 void check_contents(const BigInt &bigint, std::initializer_list<uint64_t> expected_vals)
 {
-  const std::vector<uint64_t> &actual_vals = bigint.get_bit_vector();
+  const LimbVector &actual_vals = bigint.get_bit_vector();
   auto i = actual_vals.begin();
   auto j = expected_vals.begin();
 
@@ -1322,4 +1463,1594 @@ void test_to_dec_sequence(TestObjs *objs) {
     ASSERT(number.to_dec() == expected);
     number = number + objs->one;
   }
-}
\ No newline at end of file
+}
+
+/* REMAINDER */
+/* TEST - REMAINDER SIGNS */
+void test_remainder_signs(TestObjs *objs) {
+  BigInt five(5UL);
+  BigInt negativeFive(5UL, true);
+  ASSERT((five % objs->two) == objs->one);
+  ASSERT((negativeFive % objs->two) == objs->negative_one);
+  ASSERT((five % BigInt(2UL, true)) == objs->one);
+  ASSERT((objs->nine % objs->three) == objs->zero);
+  ASSERT(!(objs->negative_nine % objs->three).is_negative());
+}
+
+/* TEST - REMAINDER BY ZERO */
+void test_remainder_by_zero(TestObjs *objs) {
+  try {
+    auto result = objs->nine % objs->zero;
+    FAIL("Expected remainder by zero to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  } catch (...) {
+    FAIL("Caught unexpected exception type");
+  }
+}
+
+/* TEST - MULTI-BLOCK DIVISION AND REMAINDER */
+void test_divmod_large_numbers(TestObjs *) {
+  BigInt dividend({0x38e7741bdaae3beaUL, 0x21211a7324ea816aUL, 0x98f2ffd2376c1fdfUL, 0xd6bf76fe7bb1ae69UL, 0xcUL});
+  BigInt divisor({0x63808ad7f4e89322UL, 0x3e5f8d205d415f26UL, 0x3UL});
+  check_contents(dividend / divisor, {0x61c6f762d1227344UL, 0xf549cb91a3d5a3e5UL, 0x3UL});
+  check_contents(dividend % divisor, {0x777907b4064ae0e2UL, 0xb96564d78768114UL});
+}
+
+/* GCD */
+/* TEST - GCD SMALL VALUES */
+void test_gcd_small(TestObjs *objs) {
+  ASSERT(gcd(BigInt(12UL), BigInt(18UL)) == BigInt(6UL));
+  ASSERT(gcd(objs->negative_nine, objs->three) == objs->three);
+  ASSERT(gcd(objs->zero, objs->negative_nine) == objs->nine);
+  ASSERT(gcd(objs->nine, objs->zero) == objs->nine);
+  ASSERT(gcd(objs->zero, objs->zero) == objs->zero);
+  ASSERT(gcd(objs->two_pow_64, BigInt(48UL)) == BigInt(16UL));
+}
+
+/* TEST - GCD LARGE VALUES */
+void test_gcd_large(TestObjs *) {
+  BigInt left({0x4825c724789467c6UL, 0x22d390f3feec1fcbUL, 0xf1c207f26462d59fUL, 0x34fce6879714569fUL, 0xfe65ea8f43c4a058UL, 0xb1dafb1a58bc8b47UL, 0x8be646df2a30564UL});
+  BigInt right({0x2de2656afcaaa8d1UL, 0x425946dcbef0b4f2UL, 0xa4cd69d32173fd28UL, 0xe812ab72bc537630UL, 0x51c8659746262758UL, 0x7075aa139ecbde22UL, 0x32ef38014b4UL});
+  BigInt result = gcd(left, right);
+  check_contents(result, {0xe81f9b0cbf4e7af7UL, 0xa8d4293433e798a0UL, 0xd2151UL});
+  ASSERT(!result.is_negative());
+  ASSERT(gcd(right, -left) == result);
+}
+
+/* TEST - LCM */
+void test_lcm(TestObjs *objs) {
+  ASSERT(lcm(BigInt(4UL), BigInt(6UL, true)) == BigInt(12UL));
+  ASSERT(lcm(objs->zero, objs->nine) == objs->zero);
+
+  BigInt left({0x4825c724789467c6UL, 0x22d390f3feec1fcbUL, 0xf1c207f26462d59fUL, 0x34fce6879714569fUL, 0xfe65ea8f43c4a058UL, 0xb1dafb1a58bc8b47UL, 0x8be646df2a30564UL});
+  BigInt right({0x2de2656afcaaa8d1UL, 0x425946dcbef0b4f2UL, 0xa4cd69d32173fd28UL, 0xe812ab72bc537630UL, 0x51c8659746262758UL, 0x7075aa139ecbde22UL, 0x32ef38014b4UL});
+  check_contents(lcm(left, right), {0xf4108b2fc7673d0aUL, 0x59baa9aedb733612UL, 0xb6f8100ac50bc91eUL, 0x39f51444b5e20561UL, 0xdfe29cf960192bc8UL, 0xa246362f07851e97UL, 0xfc3e8edcb17a07ccUL, 0xb7f4f95fe7a79ccfUL, 0x1cbcf6b76d46aa72UL, 0x4c3f0fd420d892f5UL, 0xa355b9224d8a46f8UL, 0x21eb2UL});
+}
+
+/* TEST - EXTENDED GCD */
+void test_xgcd(TestObjs *objs) {
+  BigInt x, y;
+  BigInt g = xgcd(BigInt(240UL), BigInt(46UL, true), x, y);
+  ASSERT(g == objs->two);
+  ASSERT(BigInt(240UL) * x + BigInt(46UL, true) * y == g);
+
+  BigInt left({0x4825c724789467c6UL, 0x22d390f3feec1fcbUL, 0xf1c207f26462d59fUL, 0x34fce6879714569fUL, 0xfe65ea8f43c4a058UL, 0xb1dafb1a58bc8b47UL, 0x8be646df2a30564UL});
+  BigInt right({0x2de2656afcaaa8d1UL, 0x425946dcbef0b4f2UL, 0xa4cd69d32173fd28UL, 0xe812ab72bc537630UL, 0x51c8659746262758UL, 0x7075aa139ecbde22UL, 0x32ef38014b4UL});
+  g = xgcd(left, right, x, y);
+  check_contents(g, {0xe81f9b0cbf4e7af7UL, 0xa8d4293433e798a0UL, 0xd2151UL});
+  ASSERT(left * x + right * y == g);
+
+  g = xgcd(objs->zero, objs->negative_nine, x, y);
+  ASSERT(g == objs->nine);
+  ASSERT(objs->negative_nine * y == g);
+}
+
+/* TEST - MODULAR INVERSE */
+void test_mod_inverse(TestObjs *objs) {
+  ASSERT(mod_inverse(objs->three, BigInt(7UL)) == BigInt(5UL));
+  ASSERT(mod_inverse(objs->negative_three, BigInt(7UL)) == objs->two);
+
+  BigInt modulus({0xbf6bbb58fc9c2429UL, 0xb79bcd2368bd7159UL, 0x33b29589d819c90fUL, 0xc9UL});
+  BigInt val({0xf8c4efb3b1479939UL, 0x75ee326db1e799dUL, 0x3c0676bbaaaa3bc8UL});
+  check_contents(mod_inverse(val, modulus), {0xc14db491aa7d04b7UL, 0xfd1a8eddd1ef12bUL, 0x72ae7e5423ca5948UL, 0xb9UL});
+
+  try {
+    mod_inverse(objs->three, objs->nine);
+    FAIL("Expected non-invertible value to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+  try {
+    mod_inverse(objs->three, objs->zero);
+    FAIL("Expected zero modulus to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* POWER */
+/* TEST - POWER SMALL VALUES */
+void test_pow_small(TestObjs *objs) {
+  ASSERT(pow(objs->three, 2) == objs->nine);
+  ASSERT(pow(objs->negative_three, 3) == BigInt(27UL, true));
+  ASSERT(pow(objs->negative_three, 4) == BigInt(81UL));
+  ASSERT(pow(objs->nine, 1) == objs->nine);
+  ASSERT(pow(objs->nine, 0) == objs->one);
+  ASSERT(pow(objs->zero, 0) == objs->one);
+  ASSERT(pow(objs->zero, 5) == objs->zero);
+  ASSERT(pow(BigInt(10UL), 30).to_dec() == "1000000000000000000000000000000");
+}
+
+/* TEST - POWER OF TWO BASES */
+void test_pow_powers_of_two(TestObjs *objs) {
+  check_contents(pow(objs->two, 64), {0UL, 1UL});
+  check_contents(pow(objs->two_pow_64, 2), {0UL, 0UL, 1UL});
+  BigInt result = pow(objs->negative_two_pow_64, 3);
+  check_contents(result, {0UL, 0UL, 0UL, 1UL});
+  ASSERT(result.is_negative());
+  check_contents(pow(BigInt(8UL), 22), {0UL, 4UL});
+
+  // the bit count of the result overflows, rather than wrapping to 1
+  try {
+    BigInt huge = pow(BigInt(4UL), 1ULL << 63);
+    FAIL("power overflowing the bit count should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    BigInt huge = pow(objs->three, 1ULL << 63);
+    FAIL("power overflowing the bit count should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  check_contents(pow(objs->negative_one, 1ULL << 63), {1UL});
+}
+
+/* TEST - POWER LARGE VALUES */
+void test_pow_large(TestObjs *objs) {
+  BigInt base({0xe81f9b0cbf4e7af7UL, 0xa8d4293433e798a0UL, 0xd2151UL});
+  check_contents(pow(base, 5), {0xb62f72da33ece057UL, 0x3faea12082b0214UL, 0x266ecdd50a47866eUL, 0xd7eb0414275c52UL, 0xe5b85713226b2bb9UL, 0xf00ddb75e50ae802UL, 0xaf7aef152672a5e0UL, 0x2efa113a1d6f3b08UL, 0x296fa2c76c8c6ae5UL, 0x1a2948e8e8de7b19UL, 0xd06a6337c518c0a3UL, 0x5f46f4dbaUL});
+  check_contents(pow(objs->u64_max, 3), {0xffffffffffffffffUL, 0x2UL, 0xfffffffffffffffdUL});
+}
+
+/* COMBINATORICS */
+/* TEST - FACTORIAL */
+void test_factorial(TestObjs *objs) {
+  ASSERT(factorial(0) == objs->one);
+  ASSERT(factorial(1) == objs->one);
+  ASSERT(factorial(20) == BigInt(2432902008176640000UL));
+  check_contents(factorial(25), {0x619fb0907bc00000UL, 0xcd4a0UL});
+  ASSERT(factorial(100).to_dec() == "93326215443944152681699238856266700490715968264381621468592963895217599993229915608941463976156518286253697920827223758251185210916864000000000000000000000000");
+}
+
+/* TEST - BINOMIAL COEFFICIENT */
+void test_binomial(TestObjs *objs) {
+  ASSERT(binomial(5, 7) == objs->zero);
+  ASSERT(binomial(9, 0) == objs->one);
+  ASSERT(binomial(9, 9) == objs->one);
+  ASSERT(binomial(9, 2) == BigInt(36UL));
+  ASSERT(binomial(60, 30) == BigInt(118264581564861424UL));
+  ASSERT(binomial(100, 50).to_dec() == "100891344545564193334812497256");
+  ASSERT(binomial(1000000, 2) == BigInt(499999500000UL));
+}
+
+/* TEST - FIBONACCI AND LUCAS */
+void test_fibonacci_lucas(TestObjs *objs) {
+  ASSERT(fibonacci(0) == objs->zero);
+  ASSERT(fibonacci(1) == objs->one);
+  ASSERT(fibonacci(2) == objs->one);
+  ASSERT(fibonacci(93) == BigInt(12200160415121876738UL));
+  ASSERT(fibonacci(100).to_dec() == "354224848179261915075");
+  ASSERT(lucas(0) == objs->two);
+  ASSERT(lucas(1) == objs->one);
+  ASSERT(lucas(5) == BigInt(11UL));
+  ASSERT(lucas(100).to_dec() == "792070839848372253127");
+}
+
+/* PRIMALITY */
+/* TEST - MODULAR EXPONENTIATION */
+void test_pow_mod(TestObjs *objs) {
+  ASSERT(pow_mod(objs->three, BigInt(4UL), BigInt(7UL)) == BigInt(4UL));
+  ASSERT(pow_mod(objs->negative_three, objs->three, BigInt(7UL)) == BigInt(1UL));
+  ASSERT(pow_mod(objs->three, objs->negative_one, BigInt(7UL)) == BigInt(5UL));
+  ASSERT(pow_mod(objs->nine, objs->zero, objs->one) == objs->zero);
+
+  BigInt base({0x22d390f3feec1fcbUL, 0x4825c724789467c6UL});
+  BigInt exp({0x34fce6879714569fUL, 0xf1c207f26462d59fUL});
+  check_contents(pow_mod(base, exp, BigInt({0xffffffffffffffffUL, 0x1ffffffUL})), {0x30742a0f85f555e1UL, 0x14818f9UL});
+  check_contents(pow_mod(base, exp, BigInt({0UL, 0x1000000000UL})), {0x3b90869b537ea063UL, 0xc1c2e44c6UL});
+
+  try {
+    pow_mod(objs->three, objs->negative_one, objs->nine);
+    FAIL("Expected non-invertible base to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - PROBABLE PRIME SMALL VALUES */
+void test_is_probable_prime_small(TestObjs *objs) {
+  ASSERT(!is_probable_prime(objs->zero));
+  ASSERT(!is_probable_prime(objs->one));
+  ASSERT(is_probable_prime(objs->two));
+  ASSERT(is_probable_prime(objs->three));
+  ASSERT(!is_probable_prime(objs->nine));
+  ASSERT(!is_probable_prime(objs->negative_three));
+  ASSERT(is_probable_prime(BigInt(997UL)));
+  ASSERT(is_probable_prime(BigInt(1009UL)));
+  ASSERT(!is_probable_prime(BigInt(1009UL * 1013UL)));
+}
+
+/* TEST - PROBABLE PRIME PSEUDOPRIMES */
+void test_is_probable_prime_pseudoprimes(TestObjs *) {
+  // Carmichael number and strong pseudoprimes to base 2
+  ASSERT(!is_probable_prime(BigInt(561UL)));
+  ASSERT(!is_probable_prime(BigInt(3215031751UL)));
+  ASSERT(!is_probable_prime(BigInt(3375041UL)));
+  ASSERT(!is_probable_prime(BigInt(3825123056546413051UL)));
+  // square of a prime
+  ASSERT(!is_probable_prime(BigInt(1093UL * 1093UL)));
+}
+
+/* TEST - PROBABLE PRIME LARGE VALUES */
+void test_is_probable_prime_large(TestObjs *objs) {
+  BigInt mersenne127({0xffffffffffffffffUL, 0x7fffffffffffffffUL});
+  ASSERT(is_probable_prime(mersenne127));
+  ASSERT(!is_probable_prime(mersenne127 + objs->two));
+  ASSERT(!is_probable_prime(objs->two_pow_64 + objs->one));
+}
+
+/* TEST - NEXT PRIME */
+void test_next_prime(TestObjs *objs) {
+  ASSERT(next_prime(objs->negative_nine) == objs->two);
+  ASSERT(next_prime(objs->one) == objs->two);
+  ASSERT(next_prime(objs->two) == objs->three);
+  ASSERT(next_prime(objs->nine) == BigInt(11UL));
+  ASSERT(next_prime(BigInt(1000UL)) == BigInt(1009UL));
+  check_contents(next_prime(objs->two_pow_64), {0xdUL, 0x1UL});
+  check_contents(next_prime(BigInt({0xffffffffffffffffUL, 0x7fffffffffffffffUL})), {0x1dUL, 0x8000000000000000UL});
+}
+
+/* ALLOCATION */
+/* TEST - LIMB BUFFER ALIGNMENT */
+void test_limb_alignment(TestObjs *objs) {
+  ASSERT((uintptr_t)objs->one.get_bit_vector().data() % LIMB_ALIGNMENT == 0);
+  BigInt large = pow(objs->three, 5000);
+  ASSERT((uintptr_t)large.get_bit_vector().data() % LIMB_ALIGNMENT == 0);
+
+  LimbArena arena;
+  LimbResourceScope scope(&arena);
+  BigInt small(7UL);
+  BigInt product = large * objs->nine;
+  ASSERT((uintptr_t)small.get_bit_vector().data() % LIMB_ALIGNMENT == 0);
+  ASSERT((uintptr_t)product.get_bit_vector().data() % LIMB_ALIGNMENT == 0);
+}
+
+/* TEST - LIMB ARENA SCOPE AND RESET */
+void test_limb_arena(TestObjs *objs) {
+  LimbArena arena(256);
+  BigInt copy;
+  {
+    LimbResourceScope scope(&arena);
+    BigInt value = pow(objs->three, 300);
+    ASSERT(value.get_bit_vector().get_allocator().get_resource() == &arena);
+    ASSERT(arena.bytes_allocated() > 0);
+    ASSERT(value % objs->nine == objs->zero);
+    copy = value;
+  }
+
+  // values assigned or created outside the scope keep using the pool
+  ASSERT(copy.get_bit_vector().get_allocator().get_resource() == limb_pool_resource());
+  ASSERT(BigInt(1UL).get_bit_vector().get_allocator().get_resource() == limb_pool_resource());
+  ASSERT(copy == pow(objs->three, 300));
+
+  arena.reset();
+  ASSERT(arena.bytes_allocated() == 0);
+
+  // alignments above the limb alignment are honoured, in the current
+  // chunk and in new ones
+  std::pmr::memory_resource &resource = arena;
+  for (size_t alignment : {128UL, 4096UL, 64UL, 8192UL}) {
+    for (int i = 0; i < 3; ++i) {
+      void *p = resource.allocate(100, alignment);
+      ASSERT(reinterpret_cast<uintptr_t>(p) % alignment == 0);
+    }
+  }
+  void *big = resource.allocate(1 << 20, 4096);
+  ASSERT(reinterpret_cast<uintptr_t>(big) % 4096 == 0);
+  arena.reset();
+  ASSERT(reinterpret_cast<uintptr_t>(resource.allocate(8, 2048)) % 2048 == 0);
+}
+
+/* TEST - LIMB POOL REUSE */
+void test_limb_pool_reuse(TestObjs *objs) {
+  BigInt original = pow(objs->three, 100);
+  const uint64_t *first;
+  {
+    BigInt copy(original);
+    first = copy.get_bit_vector().data();
+  }
+  // a buffer of the same size class comes back from the thread's free list
+  BigInt copy(original);
+  ASSERT(copy.get_bit_vector().data() == first);
+  ASSERT(copy == original);
+}
+
+/* TEST - ADDITION CARRY INTO ALL-ONES BLOCK */
+void test_add_carry_into_all_ones_block(TestObjs *) {
+  BigInt left({0xFFFFFFFFFFFFFFFFUL, 0xFFFFFFFFFFFFFFFFUL, 0x5UL});
+  BigInt right({0xFFFFFFFFFFFFFFFFUL, 0xFFFFFFFFFFFFFFFFUL});
+  check_contents(left + right, {0xFFFFFFFFFFFFFFFEUL, 0xFFFFFFFFFFFFFFFFUL, 0x6UL});
+}
+
+/* TEST - SUBTRACTION BORROW FROM ALL-ONES BLOCK */
+void test_sub_borrow_from_all_ones_block(TestObjs *) {
+  BigInt left({0x0UL, 0x0UL, 0x5UL});
+  BigInt right({0x1UL, 0xFFFFFFFFFFFFFFFFUL});
+  check_contents(left - right, {0xFFFFFFFFFFFFFFFFUL, 0x0UL, 0x4UL});
+}
+
+/* DEFERRED EXPRESSIONS */
+/* TEST - EXPRESSION WITH PRODUCT AND SUMS */
+void test_expr_addmul(TestObjs *objs) {
+  BigInt result;
+  result = lazy(objs->three) * objs->nine + objs->one - objs->two;
+  ASSERT(result == BigInt(26UL));
+  result = objs->one - lazy(objs->three) * objs->nine;
+  ASSERT(result == BigInt(26UL, true));
+  result = lazy(objs->negative_three) * objs->negative_nine - objs->nine - objs->nine - objs->nine;
+  ASSERT(result == objs->zero);
+  ASSERT(!result.is_negative());
+
+  BigInt left({0xe3b5045c414ab854UL, 0x7b9239a6aaf769b8UL, 0x39ceed6f124bc026UL, 0xb7b86209df603734UL, 0x8def62024UL});
+  BigInt right({0x185f893b56768ae7UL, 0xf1e2d0262ce54869UL, 0xff7b9c1026b8b063UL, 0xffffffffffffffffUL, 0x12cUL});
+  BigInt small({0x22d390f3feec1fcbUL, 0x4825c724789467c6UL});
+  result = lazy(left) * right - small;
+  check_contents(result, {0x3a5bbb3661957c01UL, 0x40ec6236c06b4460UL, 0x22709d66ccac1e01UL, 0x915799fd2d426854UL, 0x47588ee5e11d22d1UL, 0x84b23185d7c04f26UL, 0x87b10179c9e6dc9aUL, 0x3cb459b9f8a7af6UL, 0xa6e2763cb2cUL});
+  ASSERT(!result.is_negative());
+  result = right - lazy(left) * small + left;
+  check_contents(result, {0x24a99ef980411361UL, 0x2c568171e9022e96UL, 0xbbbd662cdac544f5UL, 0x68e62f7057ae8619UL, 0xbf7de0f46efd6c5cUL, 0xd43b572195f99054UL, 0x280045931UL});
+  ASSERT(result.is_negative());
+}
+
+/* TEST - EXPRESSION MATCHES EAGER EVALUATION */
+void test_expr_matches_eager(TestObjs *objs) {
+  BigInt a({0x9f33ca9e0290d102UL, 0xd331662e19562498UL, 0x2UL});
+  BigInt b({0x3efacbd8f95c7bbUL, 0x974f58eddfc56dfeUL}, true);
+  BigInt c = objs->u64_max;
+  BigInt d = objs->negative_two_pow_64;
+
+  BigInt lazyResult = (lazy(a) + b) * (lazy(c) - d) - a * b;
+  ASSERT(lazyResult == (a + b) * (c - d) - a * b);
+  lazyResult = -(lazy(a) - b) + c + d;
+  ASSERT(lazyResult == -(a - b) + c + d);
+}
+
+/* TEST - EXPRESSION ALIASING AND BUFFER REUSE */
+void test_expr_aliasing_and_reuse(TestObjs *objs) {
+  // the destination may also appear in the expression
+  BigInt x(5UL);
+  x = lazy(x) * x + x;
+  ASSERT(x == BigInt(30UL));
+
+  // a destination with enough capacity is evaluated in place
+  BigInt dest = pow(objs->three, 400);
+  const uint64_t *buffer = dest.get_bit_vector().data();
+  dest = lazy(objs->nine) * objs->nine + objs->three;
+  ASSERT(dest == BigInt(84UL));
+  ASSERT(dest.get_bit_vector().data() == buffer);
+}
+
+/* TEST - BATCH ADDITION AND SUBTRACTION */
+void test_batch_add_sub(TestObjs *objs) {
+  BigInt max({0xffffffffffffffffUL, 0x7fffffffffffffffUL});
+  BigIntBatch a(4, 2), b(4, 2);
+  a.set(0, objs->u64_max);
+  b.set(0, objs->one);
+  a.set(1, objs->negative_one);
+  b.set(1, objs->negative_one);
+  a.set(2, max);
+  b.set(2, objs->one);
+  a.set(3, objs->three);
+  b.set(3, objs->negative_nine);
+
+  BigIntBatch sum = a + b;
+  check_contents(sum.get(0), {0UL, 1UL});
+  ASSERT(sum.get(1) == BigInt(2UL, true));
+  // wraps around to the most negative value
+  BigInt wrapped = sum.get(2);
+  ASSERT(wrapped.is_negative());
+  check_contents(wrapped, {0UL, 0x8000000000000000UL});
+  ASSERT(sum.get(3) == BigInt(6UL, true));
+
+  BigIntBatch diff = a - b;
+  check_contents(diff.get(0), {0xfffffffffffffffeUL});
+  ASSERT(diff.get(1) == objs->zero);
+  check_contents(diff.get(2), {0xfffffffffffffffeUL, 0x7fffffffffffffffUL});
+  ASSERT(diff.get(3) == BigInt(12UL));
+
+  // operands must have the same shape
+  try {
+    BigIntBatch c(4, 3);
+    BigIntBatch bad = a + c;
+    FAIL("adding batches of different widths should throw");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - BATCH MULTIPLICATION AND COMPARISON */
+void test_batch_mul_compare(TestObjs *objs) {
+  BigIntBatch a(3, 2), c(3, 1);
+  a.set(0, BigInt({0xffffffffffffffffUL, 0x7fffffffffffffffUL}));
+  c.set(0, BigInt(0x8000000000000000UL, true));
+  a.set(1, objs->negative_three);
+  c.set(1, objs->nine);
+  a.set(2, objs->two_pow_64);
+  c.set(2, objs->negative_one);
+
+  BigIntBatch prod = a * c;
+  ASSERT(prod.get_width() == 3U);
+  BigInt p0 = prod.get(0);
+  ASSERT(p0.is_negative());
+  check_contents(p0, {0x8000000000000000UL, 0xffffffffffffffffUL, 0x3fffffffffffffffUL});
+  ASSERT(prod.get(1) == BigInt(27UL, true));
+  ASSERT(prod.get(2) == objs->negative_two_pow_64);
+
+  BigIntBatch b(3, 2);
+  b.set(0, objs->two_pow_64);
+  b.set(1, objs->negative_three);
+  b.set(2, objs->negative_two_pow_64);
+  std::vector<int> cmp = a.compare(b);
+  ASSERT(cmp[0] > 0);
+  ASSERT(cmp[1] == 0);
+  ASSERT(cmp[2] > 0);
+  cmp = b.compare(a);
+  ASSERT(cmp[0] < 0);
+  ASSERT(cmp[2] < 0);
+}
+
+/* TEST - BATCH CONVERSION */
+void test_batch_to_hex_dec(TestObjs *objs) {
+  BigIntBatch a(4, 2);
+  a.set(0, objs->zero);
+  a.set(1, objs->negative_two_pow_64);
+  a.set(2, BigInt({0xffffffffffffffffUL, 0x7fffffffffffffffUL}));
+  a.set(3, BigInt({0UL, 0x8000000000000000UL}, true));
+
+  std::vector<std::string> hex = a.to_hex();
+  ASSERT(hex[0] == "0");
+  ASSERT(hex[1] == "-10000000000000000");
+  ASSERT(hex[2] == "7fffffffffffffffffffffffffffffff");
+  ASSERT(hex[3] == "-80000000000000000000000000000000");
+
+  std::vector<std::string> dec = a.to_dec();
+  ASSERT(dec[0] == "0");
+  ASSERT(dec[1] == "-18446744073709551616");
+  ASSERT(dec[2] == "170141183460469231731687303715884105727");
+  ASSERT(dec[3] == "-170141183460469231731687303715884105728");
+
+  // values outside the two's complement range are rejected
+  try {
+    a.set(0, BigInt({0UL, 0x8000000000000000UL}));
+    FAIL("storing a value too wide for the batch should throw");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - KARATSUBA MULTIPLICATION */
+void test_mul_karatsuba(TestObjs *objs) {
+  // (2^6400 - 1)(2^4480 - 1) = 2^10880 - 2^6400 - 2^4480 + 1
+  BigInt a = (objs->one << 6400) - objs->one;
+  BigInt b = (objs->one << 4480) - objs->one;
+  ASSERT(a * b == (objs->one << 10880) - (objs->one << 6400) - (objs->one << 4480) + objs->one);
+  ASSERT(b * a == a * b);
+
+  // (2^6400 - 1)^2 = 2^12800 - 2^6401 + 1
+  ASSERT(a * a == (objs->one << 12800) - (objs->one << 6401) + objs->one);
+
+  // unbalanced operands, and a sign
+  BigInt c = -((objs->one << 2000) + objs->three);
+  ASSERT(a * c == -((objs->one << 8400) + (objs->three << 6400) - (objs->one << 2000) - objs->three));
+}
+
+/* TEST - PARALLEL MULTIPLICATION */
+void test_mul_parallel(TestObjs *objs) {
+  BigInt a = pow(objs->three, 9000);
+  BigInt b = pow(BigInt(7UL), 7000);
+  BigInt serialProduct = a * b;
+  BigInt serialSquare = a * a;
+
+  set_parallel_threads(4);
+  set_parallel_multiply_cutoff(64);
+  ASSERT(get_parallel_threads() == 4U);
+  BigInt parallelProduct = a * b;
+  BigInt parallelSquare = a * a;
+  set_parallel_threads(1);
+  set_parallel_multiply_cutoff(2048);
+
+  ASSERT(get_parallel_threads() == 1U);
+  ASSERT(parallelProduct == serialProduct);
+  ASSERT(parallelSquare == serialSquare);
+  ASSERT(parallelProduct / b == a);
+}
+
+/* TEST - LARGE DECIMAL CONVERSION */
+void test_to_dec_large(TestObjs *objs) {
+  BigInt ten(10UL);
+  ASSERT(pow(ten, 500).to_dec() == "1" + std::string(500, '0'));
+  ASSERT((pow(ten, 500) - objs->one).to_dec() == std::string(500, '9'));
+  ASSERT((-pow(ten, 1000) - objs->one).to_dec() == "-1" + std::string(999, '0') + "1");
+
+  // digit count is right at chunk boundaries
+  ASSERT(pow(ten, 19).to_dec() == "1" + std::string(19, '0'));
+  ASSERT((pow(ten, 38) - objs->one).to_dec() == std::string(38, '9'));
+}
+
+/* TEST - PARALLEL DECIMAL CONVERSION */
+void test_to_dec_parallel(TestObjs *objs) {
+  BigInt value = -pow(objs->three, 20000) + objs->nine;
+  std::string serial = value.to_dec();
+
+  set_parallel_threads(4);
+  set_parallel_convert_cutoff(8);
+  std::string parallel = value.to_dec();
+  set_parallel_threads(1);
+  set_parallel_convert_cutoff(512);
+
+  ASSERT(parallel == serial);
+  ASSERT(serial.size() == 9544U); // minus sign and 9543 digits
+  ASSERT(serial.substr(serial.size() - 4) == "9992");
+}
+
+/* TEST - PRODUCT OF A RANGE */
+void test_product_range(TestObjs *objs) {
+  std::vector<BigInt> values;
+  ASSERT(product(values.begin(), values.end()) == objs->one);
+
+  for (uint64_t i = 1; i <= 300; ++i) {
+    values.push_back(BigInt(i));
+  }
+  ASSERT(product(values.begin(), values.end()) == factorial(300));
+
+  // same result with parallel subtrees
+  set_parallel_threads(4);
+  set_parallel_multiply_cutoff(4);
+  BigInt parallel = product(values.begin(), values.end());
+  set_parallel_threads(1);
+  set_parallel_multiply_cutoff(2048);
+  ASSERT(parallel == factorial(300));
+
+  // signs and mixed sizes
+  BigInt mixed[] = {objs->negative_three, objs->two_pow_64, objs->negative_nine, objs->two};
+  check_contents(product(mixed, mixed + 4), {0UL, 54UL});
+  ASSERT(!product(mixed, mixed + 4).is_negative());
+  ASSERT(product(mixed, mixed + 2).is_negative());
+}
+
+/* TEST - SUM OF A RANGE */
+void test_sum_range(TestObjs *objs) {
+  std::vector<BigInt> values;
+  ASSERT(sum(values.begin(), values.end()) == objs->zero);
+
+  // carries out of the widest value
+  for (int i = 0; i < 5; ++i) {
+    values.push_back(objs->u64_max);
+  }
+  check_contents(sum(values.begin(), values.end()), {0xfffffffffffffffbUL, 4UL});
+
+  // negative terms, and a negative result
+  values.push_back(objs->negative_two_pow_64);
+  values.push_back(objs->negative_two_pow_64);
+  values.push_back(objs->negative_two_pow_64);
+  values.push_back(objs->negative_two_pow_64);
+  values.push_back(objs->negative_two_pow_64);
+  values.push_back(objs->negative_one);
+  ASSERT(sum(values.begin(), values.end()) == BigInt(6UL, true));
+
+  // same result with parallel chunks
+  set_parallel_threads(4);
+  set_parallel_sum_cutoff(1);
+  BigInt parallel = sum(values.begin(), values.end());
+  set_parallel_threads(1);
+  set_parallel_sum_cutoff(1 << 16);
+  ASSERT(parallel == BigInt(6UL, true));
+}
+
+/* TEST - BYTE CONVERSION */
+void test_to_from_bytes(TestObjs *objs) {
+  BigInt x({0x0807060504030201UL, 0x0aUL});
+  std::vector<uint8_t> le = x.to_bytes(BigInt::ByteOrder::LITTLE, false);
+  std::vector<uint8_t> be = x.to_bytes(BigInt::ByteOrder::BIG, false);
+  ASSERT(le == std::vector<uint8_t>({1, 2, 3, 4, 5, 6, 7, 8, 0x0a}));
+  ASSERT(be == std::vector<uint8_t>({0x0a, 8, 7, 6, 5, 4, 3, 2, 1}));
+  ASSERT(BigInt::from_bytes(le.data(), le.size(), BigInt::ByteOrder::LITTLE, false) == x);
+  ASSERT(BigInt::from_bytes(be.data(), be.size(), BigInt::ByteOrder::BIG, false) == x);
+
+  // two's complement uses the fewest bytes that keep the sign
+  ASSERT(BigInt(128UL, true).to_bytes(BigInt::ByteOrder::LITTLE, true) == std::vector<uint8_t>({0x80}));
+  ASSERT(BigInt(129UL, true).to_bytes(BigInt::ByteOrder::LITTLE, true) == std::vector<uint8_t>({0x7f, 0xff}));
+  ASSERT(BigInt(128UL).to_bytes(BigInt::ByteOrder::BIG, true) == std::vector<uint8_t>({0x00, 0x80}));
+  ASSERT(objs->zero.to_bytes(BigInt::ByteOrder::BIG, true) == std::vector<uint8_t>({0x00}));
+  uint8_t minus129[] = {0xff, 0x7f};
+  ASSERT(BigInt::from_bytes(minus129, 2, BigInt::ByteOrder::BIG, true) == BigInt(129UL, true));
+  ASSERT(BigInt::from_bytes(minus129, 2, BigInt::ByteOrder::BIG, false) == BigInt(0xff7fUL));
+
+  // padding to a fixed width
+  uint8_t padded[12];
+  objs->negative_two_pow_64.to_bytes(padded, 12, BigInt::ByteOrder::LITTLE, true);
+  ASSERT(padded[7] == 0 && padded[8] == 0xff && padded[11] == 0xff);
+  ASSERT(BigInt::from_bytes(padded, 12, BigInt::ByteOrder::LITTLE, true) == objs->negative_two_pow_64);
+
+  try {
+    objs->negative_one.to_bytes(BigInt::ByteOrder::LITTLE, false);
+    FAIL("unsigned bytes of a negative value should throw");
+  } catch (const std::invalid_argument &e) {
+  }
+  try {
+    x.to_bytes(padded, 8, BigInt::ByteOrder::LITTLE, false);
+    FAIL("a buffer that is too small should throw");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - BINARY RECORDS */
+void test_binary_records(TestObjs *objs) {
+  std::vector<uint8_t> buf;
+  ASSERT(objs->zero.write_record(buf) == 1U);
+  ASSERT(objs->negative_two_pow_64.write_record(buf) == 10U);
+  ASSERT(objs->u64_max.write_record(buf) == 9U);
+  ASSERT(buf[0] == 0x00);
+  ASSERT(buf[1] == 0x13); // 9 bytes, negative
+  ASSERT(buf[10] == 0x01);
+
+  size_t pos = 0, consumed = 0;
+  ASSERT(BigInt::read_record(buf.data(), buf.size(), consumed) == objs->zero);
+  pos += consumed;
+  ASSERT(BigInt::read_record(buf.data() + pos, buf.size() - pos, consumed) == objs->negative_two_pow_64);
+  pos += consumed;
+  ASSERT(BigInt::read_record(buf.data() + pos, buf.size() - pos, consumed) == objs->u64_max);
+  pos += consumed;
+  ASSERT(pos == buf.size());
+
+  try {
+    BigInt::read_record(buf.data() + 1, 5, consumed);
+    FAIL("a truncated record should throw");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - VIEWS OVER EXTERNAL LIMBS */
+void test_bigint_view(TestObjs *objs) {
+  const uint64_t limbs[] = {5UL, 0UL, 0UL, 0xffffffffffffffffUL, 1UL};
+  BigIntView small(limbs, 3, true);
+  BigIntView large(limbs, 5);
+  ASSERT(small.size() == 1U);
+  ASSERT(small.is_negative());
+  ASSERT(small.to_hex() == "-5");
+  ASSERT(large.to_hex() == "1ffffffffffffffff" + std::string(32, '0') + "0000000000000005");
+
+  // views compare and hash like the values they hold
+  BigInt minusFive(5UL, true);
+  ASSERT(small == BigIntView(minusFive));
+  ASSERT(small.hash() == BigIntView(minusFive).hash());
+  ASSERT(small.hash() != BigIntView(objs->nine).hash());
+  ASSERT(small < large);
+  ASSERT(BigIntView(limbs + 1, 2, true) == BigIntView(objs->zero));
+
+  // arithmetic reads the limbs in place
+  ASSERT(large + small == large.to_bigint() - BigInt(5UL));
+  ASSERT(small - objs->nine == BigInt(14UL, true));
+  ASSERT(small * small == BigInt(25UL));
+  ASSERT(large * BigIntView(objs->zero) == objs->zero);
+
+  // a zero with a sign flag and leading zero blocks is still zero
+  ASSERT(BigInt({0UL, 0UL}, true) == objs->zero);
+  ASSERT(objs->negative_three * BigInt({0UL, 0UL}) == objs->zero);
+}
+
+/* TEST - FILE-BACKED LIMB STORE */
+void test_limb_file(TestObjs *objs) {
+  {
+    LimbFile file("test_limb_file.limbs", 3);
+    ASSERT(file.size() == 3U);
+    ASSERT(file.data()[2] == 0);
+    file.assign(BigIntView(objs->two_pow_64));
+    ASSERT(file.size() == 2U);
+    file.flush();
+  }
+
+  // the limbs persist and can be reopened
+  {
+    LimbFile file("test_limb_file.limbs");
+    ASSERT(file.size() == 2U);
+    ASSERT(file.view(true).to_bigint() == objs->negative_two_pow_64);
+    file.resize(4);
+    ASSERT(file.data()[3] == 0);
+    ASSERT(file.view() == BigIntView(objs->two_pow_64));
+  }
+  std::remove("test_limb_file.limbs");
+
+  try {
+    LimbFile missing("no_such_dir/missing.limbs");
+    FAIL("opening a missing file should throw");
+  } catch (const std::runtime_error &e) {
+  }
+}
+
+/* TEST - OUT-OF-CORE ARITHMETIC */
+void test_ooc_add_multiply(TestObjs *objs) {
+  BigInt a = pow(objs->three, 5000) - objs->nine;
+  BigInt b = -pow(objs->nine, 1500);
+  LimbFile left("test_ooc_left.limbs", 0);
+  LimbFile out("test_ooc_out.limbs", 0);
+  left.assign(BigIntView(a));
+
+  bool negative = ooc_add(left.view(), BigIntView(b), out);
+  ASSERT(!negative);
+  ASSERT(out.view().to_bigint() == a + b);
+  negative = ooc_add(BigIntView(b), BigIntView(objs->one), out);
+  ASSERT(negative);
+  ASSERT(out.view(negative).to_bigint() == b + objs->one);
+  ASSERT(!ooc_add(BigIntView(b), BigIntView(-b), out));
+  ASSERT(out.view() == BigIntView(objs->zero));
+
+  // blocks smaller than the operands
+  negative = ooc_multiply(left.view(), BigIntView(b), out, 16);
+  ASSERT(negative);
+  ASSERT(out.view(negative).to_bigint() == a * b);
+  negative = ooc_multiply(left.view(), left.view(), out, 7);
+  ASSERT(!negative);
+  ASSERT(out.view().to_bigint() == a * a);
+
+  std::remove("test_ooc_left.limbs");
+  std::remove("test_ooc_out.limbs");
+}
+
+/* TEST - STREAM OUTPUT */
+void test_stream_output(TestObjs *objs) {
+  std::ostringstream dec;
+  dec << objs->negative_nine << " " << objs->two_pow_64 << " " << objs->zero;
+  ASSERT(dec.str() == "-9 18446744073709551616 0");
+
+  std::ostringstream hex;
+  hex << std::hex << std::showbase << objs->two_pow_64 << " " << objs->negative_nine << " " << objs->zero;
+  ASSERT(hex.str() == "0x10000000000000000 -0x9 0");
+
+  std::ostringstream upper;
+  upper << std::hex << std::uppercase << std::showbase << BigInt(255UL);
+  ASSERT(upper.str() == "0XFF");
+
+  std::ostringstream oct;
+  oct << std::oct << std::showbase << BigInt(8UL);
+  ASSERT(oct.str() == "010");
+
+  // width and fill, with each adjustment
+  std::ostringstream padded;
+  padded << std::setfill('*') << std::setw(6) << objs->negative_nine << "|"
+         << std::left << std::setw(6) << objs->negative_nine << "|"
+         << std::internal << std::setw(6) << objs->negative_nine << "|"
+         << std::setw(6) << objs->two_pow_64;
+  ASSERT(padded.str() == "****-9|-9****|-****9|18446744073709551616");
+}
+
+/* TEST - WRITE DECIMAL IN BLOCKS */
+void test_write_dec_blocks(TestObjs *objs) {
+  BigInt value = -pow(objs->three, 5000) + objs->two;
+  std::string text;
+  size_t calls = 0;
+  bool bounded = true;
+  value.write_dec([&](const char *chars, size_t length) {
+    bounded = bounded && length <= 100;
+    text.append(chars, length);
+    ++calls;
+  }, 100);
+  ASSERT(bounded);
+  ASSERT(calls > 20);
+  ASSERT(text == value.to_dec());
+
+  std::string hex;
+  objs->two_pow_64.write_hex([&](const char *chars, size_t length) {
+    hex.append(chars, length);
+  }, 4, true);
+  ASSERT(hex == "10000000000000000");
+  ASSERT(objs->two_pow_64.to_hex() == "10000000000000000");
+}
+
+/* TEST - INSTRUMENTATION */
+void test_stats(TestObjs *objs) {
+  BigInt a = pow(objs->three, 3000);
+  BigInt b = pow(objs->three, 2900) + objs->one;
+
+  stats_reset();
+  BigInt product = a * b;
+  BigInt quotient = product / b;
+  ASSERT(quotient == a);
+  BigIntStats stats = stats_snapshot();
+
+  if (!stats_enabled()) {
+    ASSERT(stats.calls[(size_t)StatOp::MUL] == 0U);
+    ASSERT(stats.allocations == 0U);
+    return;
+  }
+  ASSERT(stats.calls[(size_t)StatOp::MUL] == 1U);
+  ASSERT(stats.calls[(size_t)StatOp::DIV] == 1U);
+  ASSERT(stats.limbs[(size_t)StatOp::MUL] == a.get_bit_vector().size() + b.get_bit_vector().size());
+  ASSERT(stats.tierCalls[(size_t)StatTier::MUL_KARATSUBA] > 0U);
+  ASSERT(stats.tierCalls[(size_t)StatTier::MUL_SCHOOLBOOK] > 0U);
+  ASSERT(stats.tierCalls[(size_t)StatTier::DIV_SCHOOLBOOK] == 1U);
+  ASSERT(stats.allocations > 0U);
+  ASSERT(stats.allocatedBytes >= 8 * product.get_bit_vector().size());
+
+  uint64_t histogram = 0;
+  for (unsigned bucket = 0; bucket < STAT_LATENCY_BUCKETS; ++bucket) {
+    histogram += stats.latency[(size_t)StatOp::MUL][bucket];
+  }
+  ASSERT(histogram == 1U);
+  ASSERT(std::string(stat_op_name(StatOp::TO_DEC)) == "to_dec");
+  ASSERT(std::string(stat_tier_name(StatTier::MUL_KARATSUBA)) == "mul_karatsuba");
+
+  // counts from other threads are included, and reset clears them
+  set_parallel_threads(4);
+  set_parallel_multiply_cutoff(32);
+  product = a * b;
+  set_parallel_threads(1);
+  set_parallel_multiply_cutoff(2048);
+  ASSERT(stats_snapshot().tierCalls[(size_t)StatTier::MUL_KARATSUBA] >= 2 * stats.tierCalls[(size_t)StatTier::MUL_KARATSUBA]);
+  stats_reset();
+  ASSERT(stats_snapshot().calls[(size_t)StatOp::MUL] == 0U);
+}
+
+/* TEST - TUNABLE CUTOFFS */
+void test_tuning_cutoffs(TestObjs *objs) {
+  size_t mulCutoff = get_karatsuba_cutoff();
+  size_t sqrCutoff = get_sqr_karatsuba_cutoff();
+  size_t decCutoff = get_dec_basecase_cutoff();
+  BigInt a = pow(objs->three, 4000) + objs->two;
+  BigInt b = pow(objs->nine, 1900) - objs->one;
+  BigInt product = a * b;
+  BigInt square = a * a;
+  std::string dec = product.to_dec();
+
+  // any cutoff gives the same results
+  set_karatsuba_cutoff(1);
+  set_sqr_karatsuba_cutoff(0);
+  set_dec_basecase_cutoff(0);
+  ASSERT(get_karatsuba_cutoff() == 4U);
+  ASSERT(get_sqr_karatsuba_cutoff() == 4U);
+  ASSERT(get_dec_basecase_cutoff() == 0U);
+  ASSERT(a * b == product);
+  ASSERT(a * a == square);
+  ASSERT(product.to_dec() == dec);
+
+  set_karatsuba_cutoff(1000);
+  set_sqr_karatsuba_cutoff(1000);
+  set_dec_basecase_cutoff(1000);
+  ASSERT(a * b == product);
+  ASSERT(a * a == square);
+  ASSERT(product.to_dec() == dec);
+
+  set_karatsuba_cutoff(mulCutoff);
+  set_sqr_karatsuba_cutoff(sqrCutoff);
+  set_dec_basecase_cutoff(decCutoff);
+}
+
+/* TEST - DIVIDE BY 64-BIT VALUE */
+void test_divmod_u64(TestObjs *objs) {
+  std::pair<BigInt, uint64_t> result = divmod_u64(objs->two_pow_64, 10);
+  ASSERT(result.first.to_dec() == "1844674407370955161");
+  ASSERT(result.second == 6U);
+
+  // truncated like operator/ and operator%
+  result = divmod_u64(objs->negative_nine, 2);
+  ASSERT(result.first.to_dec() == "-4");
+  ASSERT(result.second == 1U);
+  result = divmod_u64(objs->negative_three, 9);
+  ASSERT(result.first.to_dec() == "0");
+  ASSERT(!result.first.is_negative());
+  ASSERT(result.second == 3U);
+
+  // divisors with the top bit set, and without
+  BigInt big = pow(objs->three, 500) + objs->two;
+  uint64_t divisors[] = {1, 3, 10, 0x8000000000000000UL, 0xffffffffffffffffUL, 10000000000000000000UL, 0x1234567UL};
+  for (uint64_t d : divisors) {
+    result = divmod_u64(big, d);
+    ASSERT(result.first == big / BigInt(d));
+    ASSERT(result.second == (big % BigInt(d)).get_bits(0));
+  }
+
+  // in place
+  BigInt value = -pow(objs->three, 100);
+  ASSERT(value.div_1(3) == 0U);
+  ASSERT(value == -pow(objs->three, 99));
+  try {
+    value.div_1(0);
+    FAIL("Expected division by zero to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - EXACT DIVISION */
+void test_divexact(TestObjs *objs) {
+  BigInt a = pow(objs->three, 2000) + objs->two;
+  BigInt b = pow(objs->nine, 700) - objs->one;
+  BigInt product = a * b;
+  ASSERT(divexact(product, b) == a);
+  ASSERT(divexact(product, a) == b);
+  ASSERT(divexact(-product, b) == -a);
+  ASSERT(divexact(product, -a) == -b);
+
+  // even divisors, and small values
+  BigInt even = b << 130;
+  ASSERT(divexact(a * even, even) == a);
+  ASSERT(divexact(objs->negative_nine, objs->three).to_dec() == "-3");
+  ASSERT(divexact(objs->two_pow_64, objs->two) == (objs->one << 63));
+  ASSERT(divexact(objs->zero, objs->nine) == objs->zero);
+  ASSERT(!divexact(objs->zero, objs->negative_three).is_negative());
+
+  // the divide and conquer path agrees with long division
+  BigInt big = pow(objs->three, 40000);
+  BigInt divisor = pow(objs->three, 15000);
+  ASSERT(divexact(big, divisor) == big / divisor);
+
+  try {
+    divexact(objs->nine, objs->zero);
+    FAIL("Expected division by zero to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - PRECOMPUTED DIVISOR */
+void test_divisor(TestObjs *objs) {
+  // one-block divisor
+  Divisor nine(objs->nine);
+  ASSERT(nine.get_value() == objs->nine);
+  BigInt a = pow(objs->three, 500) + objs->two;
+  ASSERT(nine.divide(a) == a / objs->nine);
+  ASSERT(nine.mod(a).to_dec() == "2");
+  ASSERT(nine.mod(-a).to_dec() == "-2");
+  ASSERT(nine.divide(objs->three) == objs->zero);
+
+  // multi-block divisor, with signs as for operator/ and operator%
+  BigInt d = pow(objs->three, 200) - objs->one;
+  Divisor small(d);
+  Divisor negative(-d);
+  BigInt q, r;
+  small.divmod(a, q, r);
+  ASSERT(q == a / d);
+  ASSERT(r == a % d);
+  negative.divmod(-a, q, r);
+  ASSERT(q == (-a) / (-d));
+  ASSERT(r == (-a) % (-d));
+  ASSERT(negative.divide(a) == a / (-d));
+  ASSERT(small.mod(d * objs->nine) == objs->zero);
+  ASSERT(!small.divide(-d + objs->one).is_negative());
+
+  // a divisor large enough for Barrett division
+  BigInt big = pow(objs->three, 20000) + objs->one;
+  Divisor large(big);
+  BigInt dividend = pow(objs->nine, 23000) - objs->two;
+  large.divmod(dividend, q, r);
+  ASSERT(q == dividend / big);
+  ASSERT(r == dividend % big);
+  ASSERT(large.mod(big * big) == objs->zero);
+  ASSERT(large.divide(big * big - objs->one) == big - objs->one);
+  ASSERT(large.divide(d) == objs->zero);
+
+  try {
+    Divisor zero(objs->zero);
+    FAIL("Expected division by zero to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - MIXED-TYPE ARITHMETIC */
+void test_native_operands(TestObjs *objs) {
+  BigInt a = pow(objs->three, 100);
+  ASSERT(a + 1 == a + objs->one);
+  ASSERT(a - 2 == a - objs->two);
+  ASSERT(a * 10 == a * BigInt(10));
+  ASSERT(a / 10 == a / BigInt(10));
+  ASSERT((a % 10).to_dec() == "1");
+  ASSERT((-a % 10).to_dec() == "-1");
+  ASSERT((-a / 10) == -(a / 10));
+
+  // signed operands keep their sign
+  ASSERT(objs->three + (-5) == BigInt(2, true));
+  ASSERT(objs->three * (int64_t)-3 == objs->negative_nine);
+  ASSERT(objs->negative_nine / -3 == objs->three);
+  ASSERT(objs->nine - 9 == objs->zero);
+  ASSERT(!(objs->negative_nine + 9).is_negative());
+  ASSERT(objs->zero * -4 == objs->zero);
+  ASSERT(!(objs->zero * -4).is_negative());
+  ASSERT(objs->one - INT64_MIN == (objs->one << 63) + 1);
+
+  // 128-bit operands
+  unsigned __int128 big = ((unsigned __int128)1 << 100) + 7;
+  BigInt bigValue = (objs->one << 100) + 7;
+  ASSERT(a + big == a + bigValue);
+  ASSERT(a * big == a * bigValue);
+  ASSERT(a / big == a / bigValue);
+  ASSERT(a % big == a % bigValue);
+  ASSERT(bigValue == big);
+
+  // native integer on the left
+  ASSERT(1 + objs->nine == BigInt(10));
+  ASSERT(1 - objs->nine == BigInt(8, true));
+  ASSERT(3 * objs->negative_three == objs->negative_nine);
+  ASSERT(9 == objs->nine);
+
+  // comparison
+  ASSERT(objs->negative_nine < 0);
+  ASSERT(objs->negative_nine < -8);
+  ASSERT(objs->negative_nine > -10);
+  ASSERT(objs->two_pow_64 > UINT64_MAX);
+  ASSERT(objs->zero == 0);
+  ASSERT(-objs->zero >= 0);
+  ASSERT(objs->nine.compare(9U) == 0);
+  ASSERT(0 < objs->nine);
+
+  try {
+    objs->nine / 0;
+    FAIL("Expected division by zero to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+  try {
+    objs->nine % (unsigned __int128)0;
+    FAIL("Expected division by zero to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - NATIVE CONVERSIONS */
+void test_native_conversions(TestObjs *objs) {
+  ASSERT(objs->nine.fits_u64());
+  ASSERT(objs->zero.fits_u64());
+  ASSERT(!objs->negative_nine.fits_u64());
+  ASSERT(!objs->two_pow_64.fits_u64());
+  ASSERT(objs->nine.to_u64() == 9U);
+  ASSERT(objs->negative_nine.to_i64() == -9);
+  ASSERT((objs->two_pow_64 - 1).to_u64() == UINT64_MAX);
+  ASSERT((-(objs->one << 63)).to_i64() == INT64_MIN);
+  ASSERT(((objs->one << 63) - 1).to_i64() == INT64_MAX);
+  ASSERT(objs->two_pow_64.to_i128() == (__int128)1 << 64);
+  ASSERT((-(objs->one << 127)).to_i128() == (__int128)((unsigned __int128)1 << 127));
+
+  try {
+    objs->negative_nine.to_u64();
+    FAIL("Expected out of range value to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+  try {
+    (objs->one << 63).to_i64();
+    FAIL("Expected out of range value to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+  try {
+    (objs->one << 127).to_i128();
+    FAIL("Expected out of range value to throw an exception");
+  } catch (const std::invalid_argument &e) {
+  }
+}
+
+/* TEST - SHARED VALUES */
+void test_shared_value(TestObjs *objs) {
+  SharedBigInt empty;
+  ASSERT(empty.get() == objs->zero);
+
+  BigInt big = pow(objs->three, 5000);
+  SharedBigInt a(big);
+  SharedBigInt b = a;
+  SharedBigInt c;
+  c = b;
+  ASSERT(a.use_count() == 3U);
+  ASSERT(&a.get() == &c.get());
+  ASSERT(*c == big);
+
+  // mutating a shared value detaches it
+  b += objs->one;
+  ASSERT(a.use_count() == 2U);
+  ASSERT(b.use_count() == 1U);
+  ASSERT(b.get() == big + 1);
+  ASSERT(a.get() == big);
+  const BigInt *before = &b.get();
+  b *= objs->two;
+  ASSERT(&b.get() == before);
+  ASSERT(b.get() == (big + 1) * 2);
+  c.mutate() = objs->nine;
+  ASSERT(c->to_dec() == "9");
+  ASSERT(a.get() == big);
+  ASSERT(a.use_count() == 1U);
+
+  SharedBigInt moved(std::move(a));
+  ASSERT(moved.get() == big);
+  ASSERT(a.get() == objs->zero);
+
+  // handles copied and destroyed concurrently
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&moved] {
+      for (int i = 0; i < 1000; ++i) {
+        SharedBigInt copy = moved;
+        SharedBigInt other(copy);
+        other -= copy;
+      }
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  ASSERT(moved.use_count() == 1U);
+  ASSERT(moved.get() == big);
+}
+
+/* TEST - HASHING */
+void test_hash(TestObjs *objs) {
+  // equal values hash equally, whatever their representation
+  ASSERT(BigInt({9UL, 0UL, 0UL}).hash() == objs->nine.hash());
+  ASSERT(BigInt(0, true).hash() == objs->zero.hash());
+  ASSERT(objs->nine.hash() != objs->negative_nine.hash());
+  ASSERT(objs->two_pow_64.hash() != objs->negative_two_pow_64.hash());
+  ASSERT(objs->one.hash() != objs->two.hash());
+  BigInt big = pow(objs->three, 3000);
+  ASSERT(BigIntView(big).hash() == big.hash());
+  ASSERT((big + 1).hash() != big.hash());
+  ASSERT(std::hash<BigInt>()(big) == big.hash());
+
+  std::unordered_map<BigInt, int> map;
+  for (int i = -50; i < 50; ++i) {
+    map[big + i] = i;
+  }
+  ASSERT(map.size() == 100U);
+  ASSERT(map[big - 7] == -7);
+  ASSERT(map.count(big + 50) == 0U);
+}
+
+/* TEST - INTERNING */
+void test_intern_table(TestObjs *objs) {
+  BigIntInternTable table(4);
+  BigInt big = pow(objs->three, 3000);
+  SharedBigInt a = table.intern(big);
+  SharedBigInt b = table.intern(pow(objs->three, 3000));
+  SharedBigInt c = table.intern(big + 1);
+  ASSERT(&a.get() == &b.get());
+  ASSERT(&a.get() != &c.get());
+  ASSERT(a.get() == big);
+  ASSERT(table.size() == 2U);
+
+  // values no longer used outside the table are purged
+  c = SharedBigInt();
+  ASSERT(table.purge() == 1U);
+  ASSERT(table.size() == 1U);
+  ASSERT(&table.intern(big).get() == &a.get());
+
+  // threads interning the same values share one copy of each
+  std::vector<std::thread> threads;
+  std::vector<SharedBigInt> seen(4 * 100);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&table, &seen, &objs, t] {
+      for (int i = 0; i < 100; ++i) {
+        seen[t * 100 + i] = table.intern(objs->two_pow_64 + i);
+      }
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  ASSERT(table.size() == 101U);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT(&seen[i].get() == &seen[300 + i].get());
+    ASSERT(seen[i].get() == objs->two_pow_64 + i);
+  }
+}
+
+/* TEST - DECIMAL POWER CACHE */
+void test_power_cache(TestObjs *objs) {
+  BigInt ten(10);
+
+  // cached powers must survive the arena that was current when they
+  // were computed
+  {
+    LimbArena arena;
+    LimbResourceScope scope(&arena);
+    ASSERT((pow(ten, 5000) - 1).to_dec() == std::string(5000, '9'));
+    arena.reset();
+  }
+  ASSERT((pow(ten, 5000) - 1).to_dec() == std::string(5000, '9'));
+
+  // threads converting values of different sizes grow the table concurrently
+  std::vector<std::thread> threads;
+  std::vector<int> ok(4, 0);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&ok, &ten, t] {
+      for (int i = 0; i < 6; ++i) {
+        size_t digits = (size_t)(t + 1) * 1000 * (i + 1) + 1;
+        std::string expected = "1" + std::string(digits - 1, '0');
+        if (pow(ten, digits - 1).to_dec() == expected && (-pow(ten, digits)).to_dec() == "-" + expected + "0") {
+          ++ok[t];
+        }
+      }
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  for (int t = 0; t < 4; ++t) {
+    ASSERT(ok[t] == 6);
+  }
+  ASSERT(objs->u64_max.to_dec() == "18446744073709551615");
+}
+
+/* TEST - RATIONAL ARITHMETIC */
+void test_rational(TestObjs *objs) {
+  BigRational third(objs->one, objs->three);
+  BigRational sixth(1, 6);
+  BigRational half = third + sixth;
+  ASSERT(!half.is_reduced());
+  ASSERT(half == BigRational(1, 2));
+  ASSERT(half.is_reduced());
+  ASSERT(half.get_numerator() == 1);
+  ASSERT(half.get_denominator() == 2);
+  ASSERT((third - sixth).to_string() == "1/6");
+  ASSERT((sixth - third).to_string() == "-1/6");
+  ASSERT((third - third).to_string() == "0");
+
+  // signs and lowest terms
+  BigRational r(objs->nine, objs->negative_three);
+  ASSERT(r.is_negative());
+  ASSERT(r.to_string() == "-3");
+  ASSERT(BigRational(BigInt(4, true), BigInt(6, true)).to_string() == "2/3");
+  ASSERT((-BigRational(2, 3)).to_string() == "-2/3");
+  std::stringstream out;
+  out << BigRational(objs->two_pow_64, objs->negative_two_pow_64 * 3);
+  ASSERT(out.str() == "-1/3");
+
+  // cross-cancelled products of reduced operands stay reduced
+  BigRational a(objs->two_pow_64, 3), b(9, objs->two_pow_64 * 5);
+  a.reduce();
+  b.reduce();
+  BigRational p = a * b;
+  ASSERT(p.is_reduced());
+  ASSERT(p.to_string() == "3/5");
+  a = BigRational(2, 3);
+  b = BigRational(BigInt(4, true), 9);
+  a.reduce();
+  b.reduce();
+  BigRational q = a / b;
+  ASSERT(q.is_reduced());
+  ASSERT(q.to_string() == "-3/2");
+  ASSERT((BigRational(5, 7) * objs->zero).to_string() == "0");
+
+  // comparison
+  ASSERT(BigRational(1, 3) < BigRational(1, 2));
+  ASSERT(BigRational(objs->negative_one, 2) < BigRational(objs->negative_one, 3));
+  ASSERT(BigRational(objs->negative_one, 2) < BigRational(1, 1000));
+  ASSERT(BigRational(2, 4) >= BigRational(1, 2));
+  ASSERT(BigRational(objs->u64_max, 2) > objs->two_pow_64 / 2 - 1);
+
+  // a long sum is reduced now and then as its denominator grows, and
+  // agrees with the sum reduced at every step
+  BigRational lazy, eager;
+  int pending = 0, automatic = 0;
+  for (int k = 1; k <= 1000; ++k) {
+    lazy = lazy + BigRational(1, k);
+    if (lazy.is_reduced()) {
+      ++automatic;
+    } else {
+      ++pending;
+    }
+    eager = eager + BigRational(1, k);
+    eager.reduce();
+  }
+  ASSERT(pending > 900);
+  ASSERT(automatic > 1);
+  ASSERT(lazy == eager);
+  ASSERT(lazy.get_numerator() == eager.get_numerator());
+
+  try {
+    BigRational bad(objs->one, objs->zero);
+    FAIL("zero denominator should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    BigRational quot = half / BigRational();
+    FAIL("division by zero should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+}
+
+/* TEST - RIGHT SHIFT, BIT LENGTH AND INTEGER SQUARE ROOT */
+void test_isqrt(TestObjs *objs) {
+  ASSERT((objs->two_pow_64 >> 1) == BigInt(1UL << 63));
+  ASSERT((objs->two_pow_64 >> 64) == 1);
+  ASSERT((objs->two_pow_64 >> 65) == 0);
+  ASSERT((objs->u64_max >> 60) == 15);
+  ASSERT(objs->zero.bit_length() == 0U);
+  ASSERT(objs->nine.bit_length() == 4U);
+  ASSERT(objs->two_pow_64.bit_length() == 65U);
+  try {
+    BigInt result = objs->negative_nine >> 1;
+    FAIL("right shifting a negative value should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+
+  ASSERT(isqrt(objs->zero) == 0);
+  ASSERT(isqrt(objs->three) == 1);
+  ASSERT(isqrt(objs->nine) == 3);
+  ASSERT(isqrt(objs->u64_max) == 0xFFFFFFFFUL);
+  ASSERT(isqrt(objs->two_pow_64) == BigInt(1UL << 32));
+  BigInt big = pow(BigInt(10), 301) + 12345;
+  BigInt root = isqrt(big);
+  ASSERT(root * root <= big);
+  ASSERT((root + 1) * (root + 1) > big);
+  ASSERT(isqrt(pow(big, 2)) == big);
+  ASSERT(isqrt(pow(big, 2) - 1) == big - 1);
+  try {
+    BigInt result = isqrt(objs->negative_one);
+    FAIL("square root of a negative value should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+}
+
+/* TEST - BINARY FLOATING POINT */
+void test_float(TestObjs *objs) {
+  // exact values keep short mantissas
+  BigFloat three(objs->three, 200);
+  ASSERT(three.get_mantissa() == 3);
+  ASSERT(three.get_exponent() == 0);
+  BigFloat half(0.5, 200);
+  ASSERT(half.get_mantissa() == 1);
+  ASSERT(half.get_exponent() == -1);
+  ASSERT((three * half).to_dec(3) == "1.50e+0");
+  ASSERT((three + half).to_fixed(2) == "3.50");
+  ASSERT((half - three).to_fixed(1) == "-2.5");
+
+  // 1/3 at 8 bits is 0.010101010|1010... in binary, rounded by each mode
+  BigFloat one(objs->one, 8);
+  ASSERT(one.div(three, 8, Rounding::NEAREST) == BigFloat(BigRational(171, 512)));
+  ASSERT(one.div(three, 8, Rounding::TOWARD_ZERO) == BigFloat(BigRational(170, 512)));
+  ASSERT(one.div(three, 8, Rounding::UP) == BigFloat(BigRational(171, 512)));
+  ASSERT(one.div(three, 8, Rounding::DOWN) == BigFloat(BigRational(170, 512)));
+  ASSERT((-one).div(three, 8, Rounding::DOWN) == BigFloat(BigRational(BigInt(171, true), 512)));
+  ASSERT((-one).div(three, 8, Rounding::TOWARD_ZERO) == BigFloat(BigRational(BigInt(170, true), 512)));
+
+  // ties go to an even mantissa: 9 and 11 at 3 bits
+  ASSERT(BigFloat(objs->nine, 3) == BigFloat(BigInt(8)));
+  ASSERT(BigFloat(BigInt(11), 3) == BigFloat(BigInt(12)));
+  ASSERT(BigFloat(objs->nine, 3, Rounding::UP) == BigFloat(BigInt(10)));
+
+  // a tiny addend only decides the direction of rounding
+  BigFloat tiny = BigFloat(objs->one, 64).div(BigFloat(objs->two_pow_64, 64) * BigFloat(objs->two_pow_64, 64), 64);
+  ASSERT(one.add(tiny, 64) == one);
+  ASSERT(one.add(tiny, 64, Rounding::UP) > one);
+  ASSERT(one.sub(tiny, 64, Rounding::TOWARD_ZERO) < one);
+  ASSERT(one.add(tiny, 200).get_mantissa().bit_length() == 129U);
+
+  // square roots
+  BigFloat two(objs->two, 200);
+  BigFloat root2 = two.sqrt();
+  ASSERT(root2.to_dec(40) == "1.414213562373095048801688724209698078570e+0");
+  ASSERT(root2.get_mantissa().bit_length() <= 200U);
+  ASSERT(root2.sqrt(64, Rounding::DOWN) * root2.sqrt(64, Rounding::DOWN) < root2);
+  ASSERT(BigFloat(objs->nine, 10).sqrt() == BigFloat(objs->three));
+  ASSERT(BigFloat(0.0625).sqrt().to_dec(2) == "2.5e-1");
+
+  // decimal conversion
+  BigFloat price(BigRational(1999, 100), 64);
+  ASSERT(price.to_fixed(2) == "19.99");
+  ASSERT((price * BigFloat(objs->three)).to_fixed(2) == "59.97");
+  ASSERT(BigFloat(BigRational(1, 3), 64).to_dec(5) == "3.3333e-1");
+  ASSERT(BigFloat(BigRational(2, 3), 64).to_dec(5, Rounding::TOWARD_ZERO) == "6.6666e-1");
+  ASSERT(BigFloat(-1e-20).to_dec(3) == "-1.00e-20");
+  ASSERT(BigFloat(9.9999).to_dec(3) == "1.00e+1");
+  ASSERT(BigFloat(BigRational(BigInt(1, true), 1000), 64).to_fixed(2) == "0.00");
+  ASSERT(BigFloat().to_dec() == "0");
+  std::stringstream out;
+  out << BigFloat(objs->u64_max, 64);
+  ASSERT(out.str() == "1.84467440737095516150e+19");
+
+  try {
+    BigFloat quot = one / BigFloat();
+    FAIL("division by zero should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    BigFloat root = (-two).sqrt();
+    FAIL("square root of a negative value should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    BigFloat rounded = two.round(0);
+    FAIL("zero precision should throw");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+}
+
+/* TEST - PRIME TABLES OUTLIVE THE FIRST CALLER'S ARENA */
+void test_prime_tables_arena(TestObjs *objs) {
+  // run alone (./bigint_tests test_prime_tables_arena), the first use of
+  // the small prime tables happens inside the arena
+  {
+    LimbArena arena;
+    LimbResourceScope scope(&arena);
+    ASSERT(is_probable_prime(BigInt(1000003UL)));
+    ASSERT(next_prime(objs->two_pow_64) == objs->two_pow_64 + 13);
+    arena.reset();
+  }
+  ASSERT(is_probable_prime(BigInt(1000003UL)));
+  ASSERT(!is_probable_prime(BigInt(1000001UL)));
+  ASSERT(next_prime(objs->two_pow_64) == objs->two_pow_64 + 13);
+}
+
+/* TEST - shared values outlive the resource scope they were made in */
+void test_shared_arena(TestObjs *objs) {
+  BigInt big = objs->two_pow_64 * objs->two_pow_64 + objs->three;
+  SharedBigInt empty, value, changed, added, detached;
+  {
+    LimbArena arena;
+    LimbResourceScope scope(&arena);
+    SharedBigInt made(big);
+    value = made;
+    changed = value;
+    changed += objs->one;
+    added += big;
+    detached = value;
+    detached.mutate() = objs->nine;
+    SharedBigInt moved(std::move(made));
+    empty = std::move(moved);
+    empty = SharedBigInt();
+    arena.reset();
+  }
+  ASSERT(empty.get() == objs->zero);
+  ASSERT(empty.use_count() == 0U);
+  ASSERT(value.get() == big);
+  ASSERT(changed.get() == big + objs->one);
+  ASSERT(added.get() == big);
+  ASSERT(detached.get() == objs->nine);
+  ASSERT(value.get().get_bit_vector().get_allocator().get_resource() == limb_pool_resource());
+  ASSERT(changed.get().get_bit_vector().get_allocator().get_resource() == limb_pool_resource());
+  ASSERT(added.get().get_bit_vector().get_allocator().get_resource() == limb_pool_resource());
+  ASSERT(detached.get().get_bit_vector().get_allocator().get_resource() == limb_pool_resource());
+
+  // mutating a default handle gives it storage of its own
+  SharedBigInt grown;
+  grown.mutate() = objs->nine;
+  ASSERT(grown.get() == objs->nine);
+  ASSERT(grown.use_count() == 1U);
+}
+
+/* TEST - hashing resists crafted limbs; interned values live in the pool */
+void test_hash_mixing(TestObjs *objs) {
+  // a limb equal to a mixing constant once zeroed the state, so every
+  // value sharing the later limbs hashed alike
+  const uint64_t p1 = 0xe7037ed1a0b428dbULL;
+  std::unordered_set<uint64_t> hashes;
+  for (uint64_t x = 1; x <= 50; ++x) {
+    hashes.insert(BigInt({x, p1}).hash());
+    hashes.insert(BigInt({p1, x, 0UL, 0UL, 1UL}).hash());
+    hashes.insert(BigInt({x, 0UL, p1, 0UL, x, 1UL}).hash());
+  }
+  ASSERT(hashes.size() == 150U);
+  ASSERT(BigIntView(BigInt({p1, 7UL, 0UL, 0UL, 1UL})).hash() == BigInt({p1, 7UL, 0UL, 0UL, 1UL}).hash());
+
+  BigIntInternTable table;
+  BigInt big = pow(objs->three, 3000);
+  SharedBigInt a;
+  {
+    LimbArena arena;
+    LimbResourceScope scope(&arena);
+    a = table.intern(pow(objs->three, 3000));
+    arena.reset();
+  }
+  ASSERT(a.get() == big);
+  ASSERT(a.get().get_bit_vector().get_allocator().get_resource() == limb_pool_resource());
+  ASSERT(&table.intern(big).get() == &a.get());
+}
+
+/* TEST - clearing the decimal power cache while conversions run */
+void test_clear_decimal_cache(TestObjs *) {
+  BigInt ten(10);
+  ASSERT((pow(ten, 20000) - 1).to_dec() == std::string(20000, '9'));
+  clear_decimal_cache();
+  ASSERT(pow(ten, 3000).to_dec() == "1" + std::string(3000, '0'));
+  clear_decimal_cache();
+  clear_decimal_cache();
+
+  // conversions keep the powers they use while another thread clears
+  std::vector<std::thread> threads;
+  std::vector<int> ok(3, 0);
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([&ok, &ten, t] {
+      for (int i = 0; i < 5; ++i) {
+        size_t digits = (size_t)(t + 1) * 1500 * (i + 1);
+        if ((pow(ten, digits) - 1).to_dec() == std::string(digits, '9')) {
+          ++ok[t];
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 20; ++i) {
+    clear_decimal_cache();
+    std::this_thread::yield();
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  for (int t = 0; t < 3; ++t) {
+    ASSERT(ok[t] == 5);
+  }
+}
+
+/* TEST - exponents too large to shift by are refused, not truncated */
+void test_float_huge_exponent(TestObjs *) {
+  // 2^(2^33) and its inverse, by repeated squaring
+  BigFloat x(BigInt(2));
+  for (int i = 0; i < 33; ++i) {
+    x = x * x;
+  }
+  ASSERT(x.get_exponent() == (int64_t)1 << 33);
+  BigFloat inv = BigFloat(BigInt(1)) / x;
+  ASSERT(inv.get_exponent() == -((int64_t)1 << 33));
+  ASSERT(x > BigFloat(BigInt(1)));
+  ASSERT(inv < BigFloat(BigInt(1)));
+  ASSERT(x * inv == BigFloat(BigInt(1)));
+
+  // (unsigned) 2^33 is 0, which once converted 2^(2^33) as 1
+  bool threw = false;
+  try {
+    x.to_dec();
+  } catch (std::invalid_argument &) {
+    threw = true;
+  }
+  ASSERT(threw);
+  threw = false;
+  try {
+    inv.to_fixed(5);
+  } catch (std::invalid_argument &) {
+    threw = true;
+  }
+  ASSERT(threw);
+  threw = false;
+  try {
+    x.add(inv, 1UL << 34);
+  } catch (std::invalid_argument &) {
+    threw = true;
+  }
+  ASSERT(threw);
+}
+
+/* TEST - HALF-GCD FOR LARGE VALUES */
+void test_half_gcd(TestObjs *objs) {
+  size_t hgcdCutoff = get_hgcd_cutoff();
+  size_t mulCutoff = get_karatsuba_cutoff();
+  BigInt common = pow(objs->three, 700) + objs->two;
+  BigInt a = (pow(BigInt(7UL), 3000) + objs->one) * common;
+  BigInt b = (pow(BigInt(11UL), 2500) - objs->two) * common;
+  set_hgcd_cutoff(1U << 30);
+  BigInt expected = gcd(a, b);
+  ASSERT(expected % common == objs->zero);
+
+  // the half-GCD gives the same gcd, with valid cofactors, whatever the
+  // depth of its recursion
+  for (size_t cutoff : {4UL, 32UL}) {
+    set_karatsuba_cutoff(cutoff);
+    set_hgcd_cutoff(8);
+    ASSERT(gcd(a, b) == expected);
+    ASSERT(gcd(b, -a) == expected);
+    ASSERT(gcd(a * a, b) == gcd(a * a, b % (a * a)));
+    BigInt x, y;
+    ASSERT(xgcd(a, b, x, y) == expected);
+    ASSERT(a * x + b * y == expected);
+    ASSERT(xgcd(-b, a, x, y) == expected);
+    ASSERT(-b * x + a * y == expected);
+    ASSERT(xgcd(a, a + objs->one, x, y) == objs->one);
+    ASSERT(a * x + (a + objs->one) * y == objs->one);
+  }
+
+  set_hgcd_cutoff(hgcdCutoff);
+  set_karatsuba_cutoff(mulCutoff);
+  ASSERT(get_hgcd_cutoff() == hgcdCutoff);
+}
@@ -0,0 +1,243 @@
+// Autotuner for BigInt: measures where each faster algorithm starts to
+// beat the simpler one on this host, and writes the cutoffs to a header
+// that bigint.cpp and bigint_parallel.cpp use as their defaults.
+//
+// Usage: bigint_tune [FILE]   (default: bigint_tuning.h)
+//
+// Each cutoff is found as in GMP's tuneup: for a growing operand size
+// n, time one level of the faster algorithm (cutoff n) against none
+// (cutoff n + 1), and take the first n from which the faster algorithm
+// wins several sizes in a row. Build with optimization, as for
+// bigint_bench; `make tune` builds this program and writes the header.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "bigint.h"
+#include "bigint_parallel.h"
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  // Minimum duration of one sample, and samples per measurement
+  const double MIN_SAMPLE_NS = 2e6;
+  const unsigned SAMPLES = 5;
+
+  // The faster algorithm must win at this many sizes in a row
+  const unsigned WINS_NEEDED = 3;
+
+  std::mt19937_64 rng(12345);
+  volatile size_t sink;
+
+  /* RANDOM VALUE - HELPER */
+  BigInt random_value(size_t limbs)
+  {
+    std::vector<uint8_t> bytes(limbs * 8);
+    for (size_t i = 0; i < bytes.size(); i += 8)
+    {
+      uint64_t x = rng();
+      std::memcpy(&bytes[i], &x, 8);
+    }
+    bytes.back() |= 0x80;
+    return BigInt::from_bytes(bytes.data(), bytes.size(), BigInt::ByteOrder::LITTLE, false);
+  }
+
+  /* TIME - HELPER */
+  // Median nanoseconds per call
+  double time_ns(const std::function<size_t()> &work)
+  {
+    size_t calls = 1;
+    std::vector<double> samples;
+    while (samples.size() < SAMPLES)
+    {
+      Clock::time_point start = Clock::now();
+      for (size_t i = 0; i < calls; ++i)
+      {
+        sink = work();
+      }
+      std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+      if (elapsed.count() < MIN_SAMPLE_NS)
+      {
+        calls *= 2; // too short to time reliably: start over with more calls
+        samples.clear();
+        continue;
+      }
+      samples.push_back(elapsed.count() / calls);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[SAMPLES / 2];
+  }
+
+  /* FIND CROSSOVER - HELPER */
+  // First size from `sizes` from which `faster` beats `slower` at
+  // WINS_NEEDED sizes in a row; `fallback` if it never does
+  size_t crossover(const char *name, const std::vector<size_t> &sizes, size_t fallback,
+                   const std::function<double(size_t)> &slower, const std::function<double(size_t)> &faster)
+  {
+    std::fprintf(stderr, "%s\n", name);
+    unsigned wins = 0;
+    for (size_t k = 0; k < sizes.size(); ++k)
+    {
+      double a = slower(sizes[k]);
+      double b = faster(sizes[k]);
+      std::fprintf(stderr, "  %7zu blocks: %12.0f ns vs %12.0f ns (%.3f)\n", sizes[k], a, b, b / a);
+      wins = b < a ? wins + 1 : 0;
+      if (wins == WINS_NEEDED)
+      {
+        return sizes[k + 1 - WINS_NEEDED];
+      }
+    }
+    std::fprintf(stderr, "  no crossover found, using %zu\n", fallback);
+    return fallback;
+  }
+
+  /* SIZE RANGE - HELPER */
+  // Sizes from `low` to `high`, each about `step` percent above the last
+  std::vector<size_t> size_range(size_t low, size_t high, size_t step)
+  {
+    std::vector<size_t> sizes;
+    for (size_t n = low; n <= high; n += std::max((size_t)1, n * step / 100))
+    {
+      sizes.push_back(n);
+    }
+    return sizes;
+  }
+
+  /* MULTIPLICATION - HELPER */
+  double time_mul(size_t n, size_t cutoff)
+  {
+    BigInt a = random_value(n);
+    BigInt b = random_value(n);
+    set_karatsuba_cutoff(cutoff);
+    return time_ns([&]
+                   { return (a * b).get_bit_vector().size(); });
+  }
+
+  /* SQUARING - HELPER */
+  double time_sqr(size_t n, size_t cutoff)
+  {
+    BigInt a = random_value(n);
+    set_sqr_karatsuba_cutoff(cutoff);
+    return time_ns([&]
+                   { return pow(a, 2).get_bit_vector().size(); });
+  }
+
+  /* DECIMAL CONVERSION - HELPER */
+  double time_dec(size_t n, size_t cutoff)
+  {
+    BigInt a = random_value(n);
+    set_dec_basecase_cutoff(cutoff);
+    return time_ns([&]
+                   { return a.to_dec().size(); });
+  }
+
+  /* PARALLEL MULTIPLICATION - HELPER */
+  double time_parallel_mul(size_t n, size_t cutoff)
+  {
+    BigInt a = random_value(n);
+    BigInt b = random_value(n);
+    set_parallel_multiply_cutoff(cutoff);
+    return time_ns([&]
+                   { return (a * b).get_bit_vector().size(); });
+  }
+
+  /* PARALLEL CONVERSION - HELPER */
+  double time_parallel_dec(size_t n, size_t cutoff)
+  {
+    BigInt a = random_value(n);
+    set_parallel_convert_cutoff(cutoff);
+    return time_ns([&]
+                   { return a.to_dec().size(); });
+  }
+}
+
+/* MAIN */
+int main(int argc, char **argv)
+{
+  std::string filename = argc > 1 ? argv[1] : "bigint_tuning.h";
+
+  size_t mul = crossover("Karatsuba multiplication", size_range(8, 256, 10), get_karatsuba_cutoff(),
+                         [](size_t n)
+                         { return time_mul(n, n + 1); },
+                         [](size_t n)
+                         { return time_mul(n, n); });
+  set_karatsuba_cutoff(mul);
+
+  size_t sqr = crossover("Karatsuba squaring", size_range(8, 256, 10), get_sqr_karatsuba_cutoff(),
+                         [](size_t n)
+                         { return time_sqr(n, n + 1); },
+                         [](size_t n)
+                         { return time_sqr(n, n); });
+  set_sqr_karatsuba_cutoff(sqr);
+
+  // A value of n blocks is split once with cutoff n - 1
+  size_t dec = crossover("Decimal conversion", size_range(4, 256, 10), get_dec_basecase_cutoff(),
+                         [](size_t n)
+                         { return time_dec(n, n); },
+                         [](size_t n)
+                         { return time_dec(n, n - 1); });
+  set_dec_basecase_cutoff(dec);
+
+  // Parallel cutoffs only mean something with more than one core
+  size_t parallelMul = get_parallel_multiply_cutoff();
+  size_t parallelDec = get_parallel_convert_cutoff();
+  unsigned threads = std::thread::hardware_concurrency();
+  if (threads > 1)
+  {
+    set_parallel_threads(threads);
+    parallelMul = crossover("Parallel multiplication", size_range(64, 16384, 50), parallelMul,
+                            [](size_t n)
+                            { return time_parallel_mul(n, n + 1); },
+                            [](size_t n)
+                            { return time_parallel_mul(n, n); });
+    parallelDec = crossover("Parallel decimal conversion", size_range(32, 4096, 50), parallelDec,
+                            [](size_t n)
+                            { return time_parallel_dec(n, n + 1); },
+                            [](size_t n)
+                            { return time_parallel_dec(n, n); });
+    set_parallel_threads(1);
+  }
+  else
+  {
+    std::fprintf(stderr, "One hardware thread: keeping the parallel cutoffs\n");
+  }
+
+  char host[256] = "unknown host";
+  gethostname(host, sizeof host - 1);
+  std::time_t now = std::time(nullptr);
+  char date[32];
+  std::strftime(date, sizeof date, "%Y-%m-%d", std::localtime(&now));
+
+  FILE *out = std::fopen(filename.c_str(), "w");
+  if (!out)
+  {
+    std::perror(filename.c_str());
+    return 1;
+  }
+  std::fprintf(out,
+               "// Generated by bigint_tune on %s (%s, %u hardware threads).\n"
+               "// Regenerate with `make tune` instead of editing.\n"
+               "#ifndef BIGINT_TUNING_H\n"
+               "#define BIGINT_TUNING_H\n"
+               "\n"
+               "#define BIGINT_MUL_KARATSUBA_CUTOFF %zu\n"
+               "#define BIGINT_SQR_KARATSUBA_CUTOFF %zu\n"
+               "#define BIGINT_DEC_BASECASE_CUTOFF %zu\n"
+               "#define BIGINT_PARALLEL_MULTIPLY_CUTOFF %zu\n"
+               "#define BIGINT_PARALLEL_CONVERT_CUTOFF %zu\n"
+               "\n"
+               "#endif // BIGINT_TUNING_H\n",
+               host, date, threads, mul, sqr, dec, parallelMul, parallelDec);
+  std::fclose(out);
+  std::fprintf(stderr, "Wrote %s\n", filename.c_str());
+  return 0;
+}
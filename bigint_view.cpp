@@ -0,0 +1,161 @@
+#include "bigint_view.h"
+
+/* CONSTRUCTOR */
+BigIntView::BigIntView(const uint64_t *data, size_t size, bool negative)
+    : limbs(data), count(size)
+{
+  while (count > 0 && limbs[count - 1] == 0)
+  {
+    --count;
+  }
+  isNeg = negative && count > 0;
+}
+
+/* CONSTRUCTOR FROM BIGINT */
+BigIntView::BigIntView(const BigInt &value)
+    : BigIntView(value.magnitude.data(), value.magnitude.size(), value.isNeg)
+{
+  // No code needed
+}
+
+/* DATA */
+const uint64_t *BigIntView::data() const
+{
+  return limbs;
+}
+
+/* SIZE */
+size_t BigIntView::size() const
+{
+  return count;
+}
+
+/* NEGATIVE */
+bool BigIntView::is_negative() const
+{
+  return isNeg;
+}
+
+/* COMPARE */
+int BigIntView::compare(const BigIntView &rhs) const
+{
+  if (isNeg != rhs.isNeg)
+  {
+    return isNeg ? -1 : 1;
+  }
+
+  // Compare magnitudes, then flip for negative values
+  int result = 0;
+  if (count != rhs.count)
+  {
+    result = count < rhs.count ? -1 : 1;
+  }
+  else
+  {
+    for (size_t i = count; i-- > 0 && result == 0;)
+    {
+      if (limbs[i] != rhs.limbs[i])
+      {
+        result = limbs[i] < rhs.limbs[i] ? -1 : 1;
+      }
+    }
+  }
+  return isNeg ? -result : result;
+}
+
+/* HASH */
+uint64_t BigIntView::hash() const
+{
+  // Same hash as the equal BigInt
+  return BigInt::hash_limbs(limbs, count, isNeg);
+}
+
+/* CONVERT TO HEX */
+std::string BigIntView::to_hex() const
+{
+  if (count == 0)
+  {
+    return "0";
+  }
+
+  std::string result;
+  result.reserve(count * 16 + 1);
+  if (isNeg)
+  {
+    result.push_back('-');
+  }
+
+  // First block is not padded, the rest are
+  for (size_t i = count; i-- > 0;)
+  {
+    uint64_t block = limbs[i];
+    int digits = 16;
+    if (i == count - 1)
+    {
+      digits = (64 - __builtin_clzll(block) + 3) / 4;
+    }
+    for (int d = digits; d-- > 0;)
+    {
+      result.push_back("0123456789abcdef"[(block >> (4 * d)) & 0xf]);
+    }
+  }
+  return result;
+}
+
+/* CONVERT TO BIGINT */
+BigInt BigIntView::to_bigint() const
+{
+  BigInt result;
+  if (count > 0)
+  {
+    result.magnitude.assign(limbs, limbs + count);
+    result.isNeg = isNeg;
+  }
+  return result;
+}
+
+/* ADDITION AND SUBTRACTION - HELPER */
+BigInt BigIntView::add_views(const BigIntView &lhs, const BigIntView &rhs, bool subtract)
+{
+  BigInt result;
+  bool rhsNeg = rhs.isNeg != subtract;
+  if (lhs.isNeg == rhsNeg)
+  {
+    BigInt::add_limbs(lhs.limbs, lhs.count, rhs.limbs, rhs.count, result.magnitude);
+    result.isNeg = lhs.isNeg;
+  }
+  else
+  {
+    bool swapped = BigInt::sub_limbs(lhs.limbs, lhs.count, rhs.limbs, rhs.count, result.magnitude);
+    result.isNeg = swapped ? rhsNeg : lhs.isNeg;
+  }
+  result.isNeg = result.isNeg && !BigInt::is_zero_mag(result.magnitude);
+  return result;
+}
+
+/* MULTIPLICATION - HELPER */
+BigInt BigIntView::multiply_views(const BigIntView &lhs, const BigIntView &rhs)
+{
+  BigInt result;
+  BigInt::mul_limbs(lhs.limbs, lhs.count, rhs.limbs, rhs.count, result.magnitude);
+  result.isNeg = (lhs.isNeg != rhs.isNeg) && !BigInt::is_zero_mag(result.magnitude);
+  return result;
+}
+
+/* ADDITION */
+BigInt operator+(const BigIntView &lhs, const BigIntView &rhs)
+{
+  return BigIntView::add_views(lhs, rhs, false);
+}
+
+/* SUBTRACTION */
+BigInt operator-(const BigIntView &lhs, const BigIntView &rhs)
+{
+  return BigIntView::add_views(lhs, rhs, true);
+}
+
+/* MULTIPLICATION */
+BigInt operator*(const BigIntView &lhs, const BigIntView &rhs)
+{
+  return BigIntView::multiply_views(lhs, rhs);
+}
@@ -0,0 +1,110 @@
+#ifndef BIGINT_VIEW_H
+#define BIGINT_VIEW_H
+
+#include <string>
+#include <cstdint>
+#include "bigint.h"
+
+//! @file
+//! Read-only views of integers stored in external limb buffers.
+
+//! Read-only view of an integer whose limbs live elsewhere, e.g., in a
+//! memory-mapped file or in a BigInt. A view does not own or copy the
+//! limbs, so the buffer must outlive it. Limbs are 64-bit blocks in
+//! host byte order, from less-significant to more-significant.
+class BigIntView
+{
+private:
+  const uint64_t *limbs;
+  size_t count; // significant blocks
+  bool isNeg;
+
+public:
+  //! Constructor from a limb buffer.
+  //!
+  //! @param data pointer to the limbs
+  //! @param size number of limbs (leading zero limbs are allowed)
+  //! @param negative if true, the value is negative
+  BigIntView(const uint64_t *data, size_t size, bool negative = false);
+
+  //! Constructor viewing the limbs of a BigInt. The view is invalidated
+  //! when the BigInt is modified or destroyed.
+  //!
+  //! @param value the BigInt to view
+  BigIntView(const BigInt &value);
+
+  //! Get the limbs.
+  //!
+  //! @return pointer to the limbs
+  const uint64_t *data() const;
+
+  //! Get the number of significant limbs.
+  //!
+  //! @return number of limbs, excluding leading zero limbs (0 for zero)
+  size_t size() const;
+
+  //! Determine whether the value is negative (zero never is).
+  //!
+  //! @return true if the value is negative
+  bool is_negative() const;
+
+  //! Compare with another view (see BigInt::compare).
+  //!
+  //! @param rhs the right-hand side view
+  //! @return negative if less than `rhs`, 0 if equal, positive if greater
+  int compare(const BigIntView &rhs) const;
+
+  bool operator==(const BigIntView &rhs) const { return compare(rhs) == 0; }
+  bool operator!=(const BigIntView &rhs) const { return compare(rhs) != 0; }
+  bool operator<(const BigIntView &rhs) const { return compare(rhs) < 0; }
+  bool operator<=(const BigIntView &rhs) const { return compare(rhs) <= 0; }
+  bool operator>(const BigIntView &rhs) const { return compare(rhs) > 0; }
+  bool operator>=(const BigIntView &rhs) const { return compare(rhs) >= 0; }
+
+  //! Hash the value (as BigInt::hash() does). Equal values hash
+  //! equally, whatever buffer (or BigInt) holds them.
+  //!
+  //! @return the hash
+  uint64_t hash() const;
+
+  //! Return the value in lower-case hexadecimal (see BigInt::to_hex).
+  //!
+  //! @return the value in hexadecimal
+  std::string to_hex() const;
+
+  //! Copy the value into a BigInt.
+  //!
+  //! @return the value
+  BigInt to_bigint() const;
+
+  friend BigInt operator+(const BigIntView &lhs, const BigIntView &rhs);
+  friend BigInt operator-(const BigIntView &lhs, const BigIntView &rhs);
+  friend BigInt operator*(const BigIntView &lhs, const BigIntView &rhs);
+
+private:
+  static BigInt add_views(const BigIntView &lhs, const BigIntView &rhs, bool subtract);
+  static BigInt multiply_views(const BigIntView &lhs, const BigIntView &rhs);
+};
+
+//! Add two views.
+//!
+//! @param lhs the left operand
+//! @param rhs the right operand
+//! @return the sum
+BigInt operator+(const BigIntView &lhs, const BigIntView &rhs);
+
+//! Subtract two views.
+//!
+//! @param lhs the left operand
+//! @param rhs the right operand
+//! @return the difference
+BigInt operator-(const BigIntView &lhs, const BigIntView &rhs);
+
+//! Multiply two views.
+//!
+//! @param lhs the left operand
+//! @param rhs the right operand
+//! @return the product
+BigInt operator*(const BigIntView &lhs, const BigIntView &rhs);
+
+#endif // BIGINT_VIEW_H